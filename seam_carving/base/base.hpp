@@ -1,8 +1,12 @@
 #pragma once
 
 #include "base/base_arena.hpp"
+#include "base/base_arena_concurrent.hpp"
 #include "base/base_assert.h"
+#include "base/base_cpu.hpp"
+#include "base/base_jobs.hpp"
 #include "base/base_math.hpp"
+#include "base/base_profile.hpp"
 #include "base/base_strings.hpp"
 #include "base/base_thread_context.hpp"
 #include "base/base_types.hpp"
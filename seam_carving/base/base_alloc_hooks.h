@@ -0,0 +1,22 @@
+#pragma once
+
+#include <stddef.h>
+
+/* NOTE(Dedrick): malloc/realloc/free replacements for C libraries (stb). They allocate from the
+ * calling thread's alloc arena (see tc_set_alloc_arena), or from the heap when it has none.
+ * Arenas are not thread-safe, so an arena pointer is reallocated and freed on the thread that allocated
+ * it, while the same alloc arena is still set. Heap pointers can be freed on any thread. */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+void *dk_alloc_hook_malloc(size_t size);
+
+void *dk_alloc_hook_realloc(void *ptr, size_t new_size);
+
+void dk_alloc_hook_free(void *ptr);
+
+#ifdef __cplusplus
+}
+#endif
@@ -3,19 +3,165 @@
 #include "base/base_assert.h"
 #include "base/base_math.hpp"
 #include "base/base_strings.hpp"
+#include "base/base_thread_context.hpp"
 #include "os/os_core.hpp"
 #include "os/os_gfx.hpp"
 
+#include <atomic>
+#include <cstdio>
 #include <cstring>
 
+namespace {
+	using namespace dk;
+
+	std::atomic<Arena *> arena_registry[ARENA_REGISTRY_CAPACITY];
+	std::atomic<ArenaReportSource *> arena_source_registry[ARENA_REGISTRY_CAPACITY];
+
+	auto arena_register(Arena *arena) noexcept -> void {
+		arena->registry_slot = ARENA_REGISTRY_CAPACITY;
+		for (u32 i = 0; i < ARENA_REGISTRY_CAPACITY; ++i) {
+			Arena *expected = nullptr;
+			if (arena_registry[i].compare_exchange_strong(expected, arena)) {
+				arena->registry_slot = i;
+				return;
+			}
+		}
+	}
+
+	auto arena_unregister(Arena *arena) noexcept -> void {
+		if (arena->registry_slot < ARENA_REGISTRY_CAPACITY) {
+			Arena *expected = arena;
+			arena_registry[arena->registry_slot].compare_exchange_strong(expected, nullptr);
+		}
+	}
+
+	auto arena_prefault(void *memory, u64 size) noexcept -> void {
+		u64 const page_size = os_get_system_info()->page_size;
+		u8 volatile *const bytes = static_cast<u8 volatile *>(memory);
+		for (u64 i = 0; i < size; i += page_size) {
+			bytes[i] = 0;
+		}
+	}
+
+	/// Reserves a block and commits its header, nullptr on failure.
+	auto arena_block_alloc(u64 reserve_size, u64 commit_size, ArenaFlags flags) noexcept -> Arena * {
+		void *memory = nullptr;
+		u64 committed = 0;
+		u64 const large_page_size = os_get_system_info()->large_page_size;
+		if ((flags & ARENA_FLAG_LARGE_PAGES) != 0 && large_page_size > 0) {
+			u64 const large_reserve_size = align_forward_pow_2(reserve_size, large_page_size);
+			memory = os_reserve_large(large_reserve_size);
+			if (memory != nullptr) {
+				reserve_size = large_reserve_size;
+				committed = large_reserve_size;
+			}
+		}
+
+		if (memory == nullptr) {
+			flags &= ~ARENA_FLAG_LARGE_PAGES;
+			memory = os_reserve(reserve_size);
+			if (memory == nullptr) {
+				return nullptr;
+			}
+
+			u64 const page_size = os_get_system_info()->page_size;
+			committed = align_forward_pow_2(sizeof(Arena), page_size);
+			if (!os_commit(memory, committed)) {
+				os_release(memory, reserve_size);
+				return nullptr;
+			}
+		}
+
+		Arena *const block = static_cast<Arena *>(memory);
+		*block = {};
+		block->memory = memory;
+		block->commit_size = commit_size;
+		block->reserve_size = reserve_size;
+		block->base_offset = align_forward_pow_2(sizeof(Arena), 16);
+		block->offset = block->base_offset;
+		block->committed = committed;
+		block->reserved = reserve_size;
+		block->flags = flags;
+		block->current = block;
+		return block;
+	}
+
+	/// Chains a block with room for `size` bytes at `align` after the current one.
+	auto arena_chain_block(Arena *arena, usize size, usize align) noexcept -> Arena * {
+		Arena *const current = arena->current;
+		u64 const page_size = os_get_system_info()->page_size;
+		u64 const header_size = align_forward_pow_2(sizeof(Arena), 16);
+		u64 const needed = align_forward_pow_2(header_size + size + align, page_size);
+		u64 const reserve_size = glm::max(arena->reserve_size, needed);
+
+		Arena *const block = arena_block_alloc(reserve_size, arena->commit_size, arena->flags);
+		if (block == nullptr) {
+			return nullptr;
+		}
+		block->prev = current;
+		block->base_pos = current->base_pos + current->reserved;
+		arena->current = block;
+		arena->total_committed += block->committed;
+		arena->total_reserved += block->reserved;
+#if DK_ARENA_STATS
+		arena->stats.chain_count += 1;
+#endif
+		return block;
+	}
+
+	/// Decommits the pages of the current block past `position`, never touching the block header.
+	auto arena_decommit_from(Arena *arena, u64 position) noexcept -> u64 {
+		Arena *const block = arena->current;
+		if ((block->flags & ARENA_FLAG_LARGE_PAGES) != 0) {
+			return 0;
+		}
+		u64 const page_size = os_get_system_info()->page_size;
+		u64 const local = position > block->base_pos ? position - block->base_pos : 0;
+		u64 const target = align_forward_pow_2(glm::max(local, static_cast<u64>(sizeof(Arena))), page_size);
+		if (target >= block->committed) {
+			return 0;
+		}
+		u64 const size = block->committed - target;
+		os_decommit(static_cast<u8 *>(block->memory) + target, size);
+		block->committed = target;
+		arena->total_committed -= size;
+#if DK_ARENA_STATS
+		arena->stats.decommit_count += 1;
+		arena->stats.decommit_bytes += size;
+#endif
+		return size;
+	}
+
+	/// Pops to `position` and applies the retention policy of the arena.
+	auto arena_reset_to(Arena *arena, u64 position) noexcept -> void {
+		if (arena->keep_size == 0) {
+			arena_pop_to(arena, position);
+			return;
+		}
+
+		arena->trim_window_peak = glm::max(arena->trim_window_peak, arena->offset);
+		arena->trim_window_count += 1;
+		arena_pop_to(arena, position);
+		if (arena->trim_window_count < ARENA_TRIM_WINDOW) {
+			return;
+		}
+
+		// NOTE(Dedrick): A window without a large reset lets the arena shrink, down to keep_size at most.
+		u64 const keep = glm::max(arena->trim_window_peak, arena->base_offset + arena->keep_size);
+		arena_decommit_from(arena, glm::max(keep, arena->offset));
+		arena->trim_window_peak = 0;
+		arena->trim_window_count = 0;
+	}
+}
+
 auto dk::arena_alloc(ArenaParams const *params) noexcept -> Arena * {
 	DK_ASSERT(params != nullptr);
 
 	u64 const reserve_size = params->reserve_size > 0 ? params->reserve_size : ARENA_DEFAULT_RESERVE_SIZE;
 	u64 const commit_size = params->commit_size > 0 ? params->commit_size : ARENA_DEFAULT_COMMIT_SIZE;
 
-	void *const memory = os_reserve(reserve_size);
-	if (memory == nullptr) {
+	Arena *const arena = arena_block_alloc(reserve_size, commit_size, params->flags);
+	if (arena == nullptr) {
 		os_show_dialog(
 			os_handle_invalid(),
 			OS_DialogIcon::ICON_ERROR,
@@ -25,28 +171,12 @@ auto dk::arena_alloc(ArenaParams const *params) noexcept -> Arena * {
 		os_abort(1);
 	}
 
-	u64 const page_size = os_get_system_info()->page_size;
-	u64 const initial_commit = align_forward_pow_2(sizeof(Arena), page_size);
-
-	if (!os_commit(memory, initial_commit)) {
-		os_release(memory, reserve_size);
-		os_show_dialog(
-			os_handle_invalid(),
-			OS_DialogIcon::ICON_ERROR,
-			str8_literal("Fatal Allocation Failure"),
-			str8_literal("Unexpected memory allocation failure.")
-		);
-		os_abort(1);
-	}
-
-	Arena *const arena = static_cast<Arena*>(memory);
-	arena->memory = memory;
-	arena->commit_size = commit_size;
-	arena->reserve_size = reserve_size;
-	arena->base_offset = align_forward_pow_2(sizeof(Arena), 16);
-	arena->offset = arena->base_offset;
-	arena->committed = initial_commit;
-	arena->reserved = reserve_size;
+	arena->total_committed = arena->committed;
+	arena->total_reserved = arena->reserved;
+	arena->name = params->name != nullptr ? params->name : "unnamed";
+	arena->keep_size = params->keep_size;
+	arena->stats = { .peak_offset = arena->base_offset };
+	arena_register(arena);
 
 	return arena;
 }
@@ -54,28 +184,55 @@ auto dk::arena_alloc(ArenaParams const *params) noexcept -> Arena * {
 auto dk::arena_release(Arena *arena) noexcept -> void {
 	DK_ASSERT(arena != nullptr);
 
-	os_release(arena->memory, arena->reserved);
+	arena_unregister(arena);
+	for (Arena *block = arena->current; block != nullptr; ) {
+		Arena *const prev = block->prev;
+		os_release(block->memory, block->reserved);
+		block = prev;
+	}
 }
 
 auto dk::arena_push_no_zero(Arena *arena, usize size, usize align) noexcept -> void * {
 	DK_ASSERT(arena != nullptr);
 
-	u64 const aligned_offset = align_forward_pow_2(arena->offset, align);
-	u64 const new_offset = aligned_offset + size;
+	Arena *block = arena->current;
+	u64 aligned_offset = align_forward_pow_2(arena->offset - block->base_pos, align);
+	u64 new_offset = aligned_offset + size;
 
-	if (new_offset > arena->reserved) {
-		return nullptr;
+	if (new_offset > block->reserved) {
+		block = (arena->flags & ARENA_FLAG_NO_CHAIN) == 0 ? arena_chain_block(arena, size, align) : nullptr;
+		if (block == nullptr) {
+#if DK_ARENA_STATS
+			arena->stats.failed_push_count += 1;
+#endif
+			return nullptr;
+		}
+		aligned_offset = align_forward_pow_2(block->base_offset, align);
+		new_offset = aligned_offset + size;
 	}
 
-	if (new_offset > arena->committed) {
-		u64 const needed = new_offset - arena->committed;
-		u64 const size_to_commit = align_forward_pow_2(needed, arena->commit_size);
-		os_commit(static_cast<u8 *>(arena->memory) + arena->committed, size_to_commit);
-		arena->committed += size_to_commit;
+	if (new_offset > block->committed) {
+		u64 const needed = new_offset - block->committed;
+		u64 const size_to_commit = glm::min(align_forward_pow_2(needed, block->commit_size), block->reserved - block->committed);
+		u8 *const commit_begin = static_cast<u8 *>(block->memory) + block->committed;
+		os_commit(commit_begin, size_to_commit);
+		if ((block->flags & ARENA_FLAG_PREFAULT) != 0) {
+			arena_prefault(commit_begin, size_to_commit);
+		}
+		block->committed += size_to_commit;
+		arena->total_committed += size_to_commit;
+#if DK_ARENA_STATS
+		arena->stats.commit_count += 1;
+		arena->stats.commit_bytes += size_to_commit;
+#endif
 	}
 
-	void *result = static_cast<u8*>(arena->memory) + aligned_offset;
-	arena->offset = new_offset;
+	void *result = static_cast<u8*>(block->memory) + aligned_offset;
+	arena->offset = block->base_pos + new_offset;
+#if DK_ARENA_STATS
+	arena->stats.push_count += 1;
+	arena->stats.peak_offset = glm::max(arena->stats.peak_offset, arena->offset);
+#endif
 	return result;
 }
 
@@ -92,7 +249,7 @@ auto dk::arena_push_array(Arena *arena, u64 count, usize size, usize align) noex
 }
 
 auto dk::arena_clear(Arena *arena) noexcept -> void {
-	arena->offset = arena->base_offset;
+	arena_reset_to(arena, arena->base_offset);
 }
 
 auto dk::arena_pop(Arena *arena, usize amount) noexcept -> void {
@@ -107,7 +264,20 @@ auto dk::arena_pop(Arena *arena, usize amount) noexcept -> void {
 auto dk::arena_pop_to(Arena *arena, u64 position) noexcept -> void {
 	position = glm::max(position, arena->base_offset);
 	position = glm::min(position, arena->offset);
-	arena->offset = position;
+
+	// NOTE(Dedrick): Blocks that only hold memory past `position` go back to the OS whole.
+	while (arena->current != arena && position < arena->current->base_pos + arena->current->base_offset) {
+		Arena *const block = arena->current;
+		arena->current = block->prev;
+		arena->total_committed -= block->committed;
+		arena->total_reserved -= block->reserved;
+		os_release(block->memory, block->reserved);
+	}
+	arena->offset = glm::min(position, arena->current->base_pos + arena->current->reserved);
+}
+
+auto dk::arena_pos(Arena *arena) noexcept -> u64 {
+	return arena->offset;
 }
 
 auto dk::arena_scratch_begin(Arena *arena) noexcept -> ScratchArena {
@@ -117,5 +287,104 @@ auto dk::arena_scratch_begin(Arena *arena) noexcept -> ScratchArena {
 auto dk::arena_scratch_end(ScratchArena scratch) noexcept -> void {
 	DK_ASSERT(scratch.arena != nullptr);
 
-	scratch.arena->offset = scratch.position;
+	arena_reset_to(scratch.arena, scratch.position);
+}
+
+auto dk::arena_trim(Arena *arena) noexcept -> u64 {
+	DK_ASSERT(arena != nullptr);
+
+	arena->trim_window_peak = 0;
+	arena->trim_window_count = 0;
+	return arena_decommit_from(arena, glm::max(arena->offset, arena->base_offset + arena->keep_size));
+}
+
+auto dk::arena_set_name(Arena *arena, char const *name) noexcept -> void {
+	DK_ASSERT(arena != nullptr && name != nullptr);
+
+	arena->name = name;
+}
+
+auto dk::arena_report_source_add(ArenaReportSource *source) noexcept -> void {
+	DK_ASSERT(source != nullptr && source->report != nullptr);
+
+	source->registry_slot = ARENA_REGISTRY_CAPACITY;
+	for (u32 i = 0; i < ARENA_REGISTRY_CAPACITY; ++i) {
+		ArenaReportSource *expected = nullptr;
+		if (arena_source_registry[i].compare_exchange_strong(expected, source)) {
+			source->registry_slot = i;
+			return;
+		}
+	}
+}
+
+auto dk::arena_report_source_remove(ArenaReportSource *source) noexcept -> void {
+	DK_ASSERT(source != nullptr);
+
+	if (source->registry_slot < ARENA_REGISTRY_CAPACITY) {
+		ArenaReportSource *expected = source;
+		arena_source_registry[source->registry_slot].compare_exchange_strong(expected, nullptr);
+	}
+}
+
+auto dk::arena_report_collect(Arena *arena, u64 *out_count) noexcept -> ArenaReport * {
+	DK_ASSERT(arena != nullptr && out_count != nullptr);
+
+	// NOTE(Dedrick): Pushed before reading, so the report also covers `arena` after this push.
+	ArenaReport *reports = arena_push_type_array<ArenaReport>(arena, ARENA_REGISTRY_CAPACITY * 2);
+	u64 count = 0;
+	for (std::atomic<Arena *> const &slot : arena_registry) {
+		Arena const *source = slot.load();
+		if (source == nullptr) {
+			continue;
+		}
+		reports[count] = {
+			.name = source->name,
+			.offset = source->offset,
+			.committed = source->total_committed,
+			.reserved = source->total_reserved,
+			.stats = source->stats,
+		};
+		count += 1;
+	}
+	for (std::atomic<ArenaReportSource *> const &slot : arena_source_registry) {
+		ArenaReportSource const *source = slot.load();
+		if (source == nullptr) {
+			continue;
+		}
+		source->report(source->arena, &reports[count]);
+		count += 1;
+	}
+	*out_count = count;
+	return reports;
+}
+
+auto dk::arena_report_print() noexcept -> void {
+	ScratchArena const scratch = arena_scratch_begin(tc_get_scratch(nullptr, 0));
+	u64 count = 0;
+	ArenaReport const *reports = arena_report_collect(scratch.arena, &count);
+
+	(void)std::fprintf(
+		stderr,
+		"%-24s %12s %12s %12s %12s %8s %12s %10s %6s %10s %7s\n",
+		"arena", "offset", "peak", "committed", "reserved", "commits", "commit_bytes", "pushes", "failed", "decommits", "chained"
+	);
+	for (u64 i = 0; i < count; ++i) {
+		ArenaReport const *report = &reports[i];
+		(void)std::fprintf(
+			stderr,
+			"%-24s %12llu %12llu %12llu %12llu %8llu %12llu %10llu %6llu %10llu %7llu\n",
+			report->name,
+			static_cast<unsigned long long>(report->offset),
+			static_cast<unsigned long long>(report->stats.peak_offset),
+			static_cast<unsigned long long>(report->committed),
+			static_cast<unsigned long long>(report->reserved),
+			static_cast<unsigned long long>(report->stats.commit_count),
+			static_cast<unsigned long long>(report->stats.commit_bytes),
+			static_cast<unsigned long long>(report->stats.push_count),
+			static_cast<unsigned long long>(report->stats.failed_push_count),
+			static_cast<unsigned long long>(report->stats.decommit_count),
+			static_cast<unsigned long long>(report->stats.chain_count)
+		);
+	}
+	arena_scratch_end(scratch);
 }
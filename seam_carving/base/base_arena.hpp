@@ -3,20 +3,88 @@
 #include "base/base_types.hpp"
 #include "base/base_utils.hpp"
 
+#ifndef DK_ARENA_STATS
+#	define DK_ARENA_STATS 1 ///< 0 stops arenas from updating ArenaStats.
+#endif
+
 namespace dk {
+	constexpr u32 ARENA_REGISTRY_CAPACITY = 512; ///< Arenas past this still work, but are missing from reports.
+	constexpr u32 ARENA_TRIM_WINDOW = 64; ///< Clears/scratch ends whose peak usage decides what an arena keeps committed.
+
+	using ArenaFlags = u32;
+	enum : ArenaFlags {
+		ARENA_FLAG_NONE = 0,
+		ARENA_FLAG_NO_CHAIN = 1u << 0, ///< Pushes past the reserve return nullptr instead of chaining a new block.
+		ARENA_FLAG_LARGE_PAGES = 1u << 1, ///< Large pages when the OS grants them, committed in full up front.
+		ARENA_FLAG_PREFAULT = 1u << 2, ///< Touch pages as they are committed, so first use does not fault.
+	};
+
 	struct ArenaParams {
 		u64 reserve_size;
 		u64 commit_size;
+		char const *name; ///< Shown in arena reports, must outlive the arena. May be nullptr.
+		u64 keep_size; ///< Commit kept on clear/scratch end, 0 never decommits.
+		ArenaFlags flags;
+	};
+
+	struct ArenaStats {
+		u64 peak_offset;
+		u64 commit_count; ///< Calls to os_commit after creation.
+		u64 commit_bytes; ///< Bytes passed to those calls.
+		u64 push_count;
+		u64 failed_push_count; ///< Pushes that returned nullptr.
+		u64 decommit_count;
+		u64 decommit_bytes;
+		u64 chain_count; ///< Blocks chained after the first one.
 	};
 
+	// NOTE(Dedrick): An arena is a chain of reserved blocks, each starting with an Arena header.
+	// The first block is the arena handed out by `arena_alloc`. Positions count across all blocks,
+	// so `arena_pop_to` and scratch arenas release whole blocks when they pop past them.
 	struct Arena {
-		void *memory; ///< Memory owned by the arena.
+		void *memory; ///< Memory owned by this block.
 		u64 commit_size;
-		u64 reserve_size;
-		u64 base_offset;
+		u64 reserve_size; ///< Reserve of a new block, unless a single push needs more.
+		u64 base_offset; ///< Size of the block header.
+		u64 offset; ///< First block only, position across the whole chain.
+		u64 committed; ///< Of this block.
+		u64 reserved; ///< Of this block.
+		ArenaFlags flags; ///< ARENA_FLAG_LARGE_PAGES is cleared on blocks that did not get large pages.
+
+		Arena *current; ///< First block only, the block pushes go to.
+		Arena *prev; ///< nullptr for the first block.
+		u64 base_pos; ///< Position of this block's first byte.
+		u64 total_committed; ///< First block only, summed over the chain.
+		u64 total_reserved;
+
+		char const *name;
+		u32 registry_slot;
+		ArenaStats stats;
+
+		// NOTE(Dedrick): Decommitting only what the last ARENA_TRIM_WINDOW resets left unused
+		// keeps loops that refill the arena every frame from thrashing os_commit.
+		u64 keep_size;
+		u64 trim_window_peak; ///< Highest offset seen at a reset in the current window.
+		u32 trim_window_count;
+	};
+
+	/// Snapshot of one live arena.
+	struct ArenaReport {
+		char const *name;
 		u64 offset;
 		u64 committed;
 		u64 reserved;
+		ArenaStats stats;
+	};
+
+	using ArenaReportFunction = void (*)(void const *arena, ArenaReport *out_report);
+
+	/// Lets arena types other than Arena show up in reports, e.g. ConcurrentArena.
+	/// Must not move between `arena_report_source_add` and `arena_report_source_remove`.
+	struct ArenaReportSource {
+		void const *arena;
+		ArenaReportFunction report;
+		u32 registry_slot;
 	};
 
 	struct ScratchArena {
@@ -26,6 +94,7 @@ namespace dk {
 
 	constexpr u64 ARENA_DEFAULT_RESERVE_SIZE = mega_bytes(64);
 	constexpr u64 ARENA_DEFAULT_COMMIT_SIZE = kilo_bytes(64);
+	constexpr u64 ARENA_DEFAULT_KEEP_SIZE = mega_bytes(1);
 
 	auto arena_alloc(ArenaParams const *params) noexcept -> Arena *;
 
@@ -43,10 +112,30 @@ namespace dk {
 
 	auto arena_pop_to(Arena *arena, u64 position) noexcept -> void;
 
+	/// Position of the next push, valid for `arena_pop_to`.
+	auto arena_pos(Arena *arena) noexcept -> u64;
+
 	auto arena_scratch_begin(Arena *arena) noexcept -> ScratchArena;
 
 	auto arena_scratch_end(ScratchArena scratch) noexcept -> void;
 
+	/// Decommits everything in the current block past max(offset, keep_size) right away
+	/// and returns the bytes decommitted.
+	auto arena_trim(Arena *arena) noexcept -> u64;
+
+	auto arena_set_name(Arena *arena, char const *name) noexcept -> void;
+
+	auto arena_report_source_add(ArenaReportSource *source) noexcept -> void;
+
+	auto arena_report_source_remove(ArenaReportSource *source) noexcept -> void;
+
+	/// Copies the state of every live arena into `arena`.
+	/// NOTE(Dedrick): Arenas owned by other threads are read without locking, their numbers may be a push behind.
+	auto arena_report_collect(Arena *arena, u64 *out_count) noexcept -> ArenaReport *;
+
+	/// Prints every live arena to stderr.
+	auto arena_report_print() noexcept -> void;
+
 	template <typename T>
 	auto arena_push_type(Arena *arena) noexcept -> T *{
 		return static_cast<T *>(arena_push(arena, sizeof(T), alignof(T)));
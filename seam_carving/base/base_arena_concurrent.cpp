@@ -0,0 +1,174 @@
+#include "base_arena_concurrent.hpp"
+
+#include "base/base_assert.h"
+#include "base/base_math.hpp"
+#include "base/base_strings.hpp"
+#include "os/os_gfx.hpp"
+
+#include <cstring>
+#include <new>
+
+namespace {
+	using namespace dk;
+
+	/// Commits up to `end` unless another push already did, only takes the lock when it has to.
+	auto concurrent_arena_commit_to(ConcurrentArena *arena, u64 end) noexcept -> b8 {
+		if (end <= arena->committed.load(std::memory_order_acquire)) {
+			return true;
+		}
+
+		b8 succeeded = true;
+		os_mutex_lock(arena->commit_mutex);
+		u64 const committed = arena->committed.load(std::memory_order_relaxed);
+		if (end > committed) {
+			u64 const size_to_commit = glm::min(align_forward_pow_2(end - committed, arena->commit_size), arena->reserved - committed);
+			succeeded = os_commit(static_cast<u8 *>(arena->memory) + committed, size_to_commit);
+			if (succeeded) {
+				arena->commit_count += 1;
+				arena->commit_bytes += size_to_commit;
+				arena->committed.store(committed + size_to_commit, std::memory_order_release);
+			}
+		}
+		os_mutex_unlock(arena->commit_mutex);
+		return succeeded;
+	}
+
+	// NOTE(Dedrick): Pushes are not counted, the ones into blocks take no atomics.
+	auto concurrent_arena_report(void const *source, ArenaReport *out_report) noexcept -> void {
+		ConcurrentArena const *arena = static_cast<ConcurrentArena const *>(source);
+		u64 const offset = glm::min(arena->offset.load(std::memory_order_relaxed), arena->reserved);
+		*out_report = {
+			.name = arena->name,
+			.offset = offset,
+			.committed = arena->committed.load(std::memory_order_relaxed),
+			.reserved = arena->reserved,
+			.stats = {
+				.peak_offset = glm::max(arena->peak_offset, offset),
+				.commit_count = arena->commit_count,
+				.commit_bytes = arena->commit_bytes,
+				.failed_push_count = arena->failed_push_count.load(std::memory_order_relaxed),
+			},
+		};
+	}
+}
+
+auto dk::concurrent_arena_alloc(ConcurrentArenaParams const *params) noexcept -> ConcurrentArena * {
+	DK_ASSERT(params != nullptr);
+
+	u64 const page_size = os_get_system_info()->page_size;
+	u64 const reserve_size = params->reserve_size > 0 ? params->reserve_size : ARENA_DEFAULT_RESERVE_SIZE;
+	u64 const header_size = align_forward_pow_2(sizeof(ConcurrentArena), page_size);
+
+	void *const memory = os_reserve(reserve_size);
+	OS_Handle const commit_mutex = os_mutex_alloc();
+	if (memory == nullptr || commit_mutex == os_handle_invalid() || !os_commit(memory, header_size)) {
+		os_show_dialog(
+			os_handle_invalid(),
+			OS_DialogIcon::ICON_ERROR,
+			str8_literal("Fatal Allocation Failure"),
+			str8_literal("Unexpected memory allocation failure.")
+		);
+		os_abort(1);
+	}
+
+	ConcurrentArena *const arena = new (memory) ConcurrentArena();
+	arena->memory = memory;
+	arena->reserved = reserve_size;
+	arena->commit_size = params->commit_size > 0 ? params->commit_size : ARENA_DEFAULT_COMMIT_SIZE;
+	arena->block_size = params->block_size > 0 ? params->block_size : CONCURRENT_ARENA_DEFAULT_BLOCK_SIZE;
+	arena->base_offset = align_forward_pow_2(sizeof(ConcurrentArena), 64);
+	arena->name = params->name != nullptr ? params->name : "unnamed";
+	arena->commit_mutex = commit_mutex;
+	arena->offset.store(arena->base_offset, std::memory_order_relaxed);
+	arena->committed.store(header_size, std::memory_order_relaxed);
+	arena->report_source = { .arena = arena, .report = concurrent_arena_report };
+	arena_report_source_add(&arena->report_source);
+	return arena;
+}
+
+auto dk::concurrent_arena_release(ConcurrentArena *arena) noexcept -> void {
+	DK_ASSERT(arena != nullptr);
+
+	arena_report_source_remove(&arena->report_source);
+	os_mutex_release(arena->commit_mutex);
+	u64 const reserved = arena->reserved;
+	arena->~ConcurrentArena();
+	os_release(arena, reserved);
+}
+
+auto dk::concurrent_arena_push_no_zero(ConcurrentArena *arena, usize size, usize align) noexcept -> void * {
+	DK_ASSERT(arena != nullptr && is_pow_2(align));
+
+	// NOTE(Dedrick): Sizes are rounded to the granule, so the offset never loses that alignment and
+	// only larger alignments pay for padding. The fetch_add claims the worst case, the aligned
+	// start lands somewhere inside it.
+	u64 const rounded = align_forward_pow_2(glm::max(size, static_cast<usize>(1)), CONCURRENT_ARENA_GRANULE);
+	u64 const padding = align > CONCURRENT_ARENA_GRANULE ? align - CONCURRENT_ARENA_GRANULE : 0;
+	u64 const begin = arena->offset.fetch_add(rounded + padding, std::memory_order_relaxed);
+	u64 const aligned_offset = align_forward_pow_2(begin, align);
+	u64 const new_offset = aligned_offset + size;
+
+	if (new_offset > arena->reserved || !concurrent_arena_commit_to(arena, new_offset)) {
+		arena->failed_push_count.fetch_add(1, std::memory_order_relaxed);
+		return nullptr;
+	}
+	return static_cast<u8 *>(arena->memory) + aligned_offset;
+}
+
+auto dk::concurrent_arena_push(ConcurrentArena *arena, usize size, usize align) noexcept -> void * {
+	void *result = concurrent_arena_push_no_zero(arena, size, align);
+	if (result != nullptr) {
+		std::memset(result, 0, size);
+	}
+	return result;
+}
+
+auto dk::concurrent_arena_push_array(ConcurrentArena *arena, u64 count, usize size, usize align) noexcept -> void * {
+	return concurrent_arena_push(arena, count * size, align);
+}
+
+auto dk::concurrent_arena_clear(ConcurrentArena *arena) noexcept -> void {
+	DK_ASSERT(arena != nullptr);
+
+	u64 const offset = glm::min(arena->offset.load(std::memory_order_relaxed), arena->reserved);
+	arena->peak_offset = glm::max(arena->peak_offset, offset);
+	arena->offset.store(arena->base_offset, std::memory_order_relaxed);
+	arena->generation += 1;
+}
+
+auto dk::concurrent_arena_block_push_no_zero(ConcurrentArena *arena, ConcurrentArenaBlock *block, usize size, usize align) noexcept -> void * {
+	DK_ASSERT(arena != nullptr && block != nullptr && is_pow_2(align));
+
+	if (block->cursor != nullptr && block->generation == arena->generation) {
+		u8 *const aligned = reinterpret_cast<u8 *>(align_forward_pow_2(reinterpret_cast<std::uintptr_t>(block->cursor), align));
+		if (aligned + size <= block->end) {
+			block->cursor = aligned + size;
+			return aligned;
+		}
+	}
+
+	// NOTE(Dedrick): Big requests would waste most of a fresh sub-block, and dropping the current
+	// one for them would waste its tail too.
+	if (size + align > arena->block_size / 4) {
+		return concurrent_arena_push_no_zero(arena, size, align);
+	}
+
+	// NOTE(Dedrick): Sub-blocks start on a cache line, so two threads never write the same line.
+	u8 *const memory = static_cast<u8 *>(concurrent_arena_push_no_zero(arena, arena->block_size, 64));
+	if (memory == nullptr) {
+		return nullptr;
+	}
+	u8 *const aligned = reinterpret_cast<u8 *>(align_forward_pow_2(reinterpret_cast<std::uintptr_t>(memory), align));
+	block->cursor = aligned + size;
+	block->end = memory + arena->block_size;
+	block->generation = arena->generation;
+	return aligned;
+}
+
+auto dk::concurrent_arena_block_push(ConcurrentArena *arena, ConcurrentArenaBlock *block, usize size, usize align) noexcept -> void * {
+	void *result = concurrent_arena_block_push_no_zero(arena, block, size, align);
+	if (result != nullptr) {
+		std::memset(result, 0, size);
+	}
+	return result;
+}
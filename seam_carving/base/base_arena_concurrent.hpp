@@ -0,0 +1,86 @@
+#pragma once
+
+#include "base/base_arena.hpp"
+#include "base/base_types.hpp"
+#include "base/base_utils.hpp"
+#include "os/os_core.hpp"
+
+#include <atomic>
+
+namespace dk {
+	constexpr u64 CONCURRENT_ARENA_GRANULE = 16; ///< Every push is rounded up to this, so offsets stay aligned to it.
+	constexpr u64 CONCURRENT_ARENA_DEFAULT_BLOCK_SIZE = kilo_bytes(64);
+
+	struct ConcurrentArenaParams {
+		u64 reserve_size;
+		u64 commit_size;
+		u64 block_size; ///< Size of the sub-blocks handed to `ConcurrentArenaBlock`s.
+		char const *name; ///< Must outlive the arena. May be nullptr.
+	};
+
+	// NOTE(Dedrick): Pushes from any number of threads bump `offset` with one fetch_add.
+	// Only the thread whose push crosses `committed` takes the lock, so with a sensible
+	// commit_size the lock is taken a handful of times per clear. There is no chaining,
+	// pushes past the reserve return nullptr.
+	struct ConcurrentArena {
+		void *memory;
+		u64 reserved;
+		u64 commit_size;
+		u64 block_size;
+		u64 base_offset; ///< Size of the header.
+		char const *name;
+		OS_Handle commit_mutex;
+		u64 commit_count; ///< Calls to os_commit after creation, guarded by commit_mutex.
+		u64 commit_bytes; ///< Bytes passed to those calls, guarded by commit_mutex.
+		u64 generation; ///< Bumped by every clear, blocks filled before it are empty.
+		u64 peak_offset; ///< Highest offset seen by a clear.
+		std::atomic<u64> failed_push_count;
+		ArenaReportSource report_source;
+
+		alignas(64) std::atomic<u64> offset; ///< Can run past `reserved` after failed pushes, until the next clear.
+		alignas(64) std::atomic<u64> committed;
+	};
+
+	/// Per-thread sub-block of a ConcurrentArena, pushes into it take no atomics at all.
+	/// Zero-initialize one per thread, it is refilled from the arena when it runs out.
+	struct ConcurrentArenaBlock {
+		u8 *cursor;
+		u8 *end;
+		u64 generation; ///< Of the arena when the sub-block was taken.
+	};
+
+	auto concurrent_arena_alloc(ConcurrentArenaParams const *params) noexcept -> ConcurrentArena *;
+
+	auto concurrent_arena_release(ConcurrentArena *arena) noexcept -> void;
+
+	/// Same alignment and zeroing as `arena_push`, safe to call from any thread.
+	auto concurrent_arena_push(ConcurrentArena *arena, usize size, usize align) noexcept -> void *;
+
+	auto concurrent_arena_push_no_zero(ConcurrentArena *arena, usize size, usize align) noexcept -> void *;
+
+	auto concurrent_arena_push_array(ConcurrentArena *arena, u64 count, usize size, usize align) noexcept -> void *;
+
+	/// NOTE(Dedrick): Not thread safe, call once every thread is done with the arena and its blocks.
+	/// Keeps everything committed, the next round of pushes reuses it. Blocks refill on their next push.
+	auto concurrent_arena_clear(ConcurrentArena *arena) noexcept -> void;
+
+	/// Same alignment and zeroing as `arena_push`. Requests larger than a sub-block go to the arena directly.
+	auto concurrent_arena_block_push(ConcurrentArena *arena, ConcurrentArenaBlock *block, usize size, usize align) noexcept -> void *;
+
+	auto concurrent_arena_block_push_no_zero(ConcurrentArena *arena, ConcurrentArenaBlock *block, usize size, usize align) noexcept -> void *;
+
+	template <typename T>
+	auto concurrent_arena_push_type(ConcurrentArena *arena) noexcept -> T * {
+		return static_cast<T *>(concurrent_arena_push(arena, sizeof(T), alignof(T)));
+	}
+
+	template <typename T>
+	auto concurrent_arena_push_type_array(ConcurrentArena *arena, u64 count) noexcept -> T * {
+		return static_cast<T *>(concurrent_arena_push_array(arena, count, sizeof(T), alignof(T)));
+	}
+
+	template <typename T>
+	auto concurrent_arena_block_push_type_array(ConcurrentArena *arena, ConcurrentArenaBlock *block, u64 count) noexcept -> T * {
+		return static_cast<T *>(concurrent_arena_block_push(arena, block, count * sizeof(T), alignof(T)));
+	}
+}
@@ -0,0 +1,42 @@
+#include "base_cpu.hpp"
+
+#if defined(_MSC_VER) && !defined(__clang__)
+#	include <intrin.h>
+#endif
+
+namespace {
+	using namespace dk;
+
+	auto cpu_features_query() noexcept -> CpuFeatureFlags {
+		CpuFeatureFlags features = CPU_FEATURE_FLAG_NONE;
+#if defined(_MSC_VER) && !defined(__clang__)
+		int info[4] = {};
+		__cpuid(info, 0);
+		int const max_leaf = info[0];
+
+		// NOTE(Dedrick): AVX2 also needs OSXSAVE and the OS enabling the xmm and ymm state in XCR0.
+		__cpuid(info, 1);
+		b8 const has_osxsave = (info[2] & (1 << 27)) != 0;
+		b8 const has_avx = (info[2] & (1 << 28)) != 0;
+		b8 const ymm_saved = has_osxsave && (_xgetbv(0) & 0x6) == 0x6;
+		if (max_leaf >= 7 && has_avx && ymm_saved) {
+			__cpuidex(info, 7, 0);
+			if ((info[1] & (1 << 5)) != 0) {
+				features |= CPU_FEATURE_FLAG_AVX2;
+			}
+		}
+#else
+		// NOTE(Dedrick): libgcc checks the OS state in XCR0 as well.
+		__builtin_cpu_init();
+		if (__builtin_cpu_supports("avx2")) {
+			features |= CPU_FEATURE_FLAG_AVX2;
+		}
+#endif
+		return features;
+	}
+}
+
+auto dk::cpu_features() noexcept -> CpuFeatureFlags {
+	static CpuFeatureFlags const features = cpu_features_query();
+	return features;
+}
@@ -0,0 +1,23 @@
+#pragma once
+
+#include "base/base_types.hpp"
+
+// NOTE(Dedrick): Builds target the x64 baseline, SSE2. Kernels for newer instruction sets are compiled per
+// function with DK_TARGET_* and only called once cpu_features reports the set. MSVC emits any intrinsic
+// without /arch, gcc and clang need the target attribute.
+#if defined(_MSC_VER) && !defined(__clang__)
+#	define DK_TARGET_AVX2
+#else
+#	define DK_TARGET_AVX2 __attribute__((target("avx2")))
+#endif
+
+namespace dk {
+	using CpuFeatureFlags = u32;
+	enum : CpuFeatureFlags {
+		CPU_FEATURE_FLAG_NONE = 0,
+		CPU_FEATURE_FLAG_AVX2 = 1u << 0, ///< Only set when the OS also saves the ymm registers.
+	};
+
+	/// Instruction sets above the baseline this CPU runs, queried on first use.
+	auto cpu_features() noexcept -> CpuFeatureFlags;
+}
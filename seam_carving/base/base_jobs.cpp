@@ -0,0 +1,212 @@
+#include "base_jobs.hpp"
+
+#include "base/base_assert.h"
+#include "base/base_profile.hpp"
+
+namespace {
+	using namespace dk;
+
+	struct JobPrefaultParams {
+		u8 volatile *memory;
+		u64 size;
+		u64 page_size;
+	};
+
+	auto job_prefault_worker(void *params, u32 worker_index, u32 worker_count) noexcept -> void {
+		JobPrefaultParams const *prefault = static_cast<JobPrefaultParams const *>(params);
+		u64 const page_count = (prefault->size + prefault->page_size - 1) / prefault->page_size;
+		JobRange const range = job_range(page_count, worker_index, worker_count);
+		for (u64 i = range.begin; i < range.end; ++i) {
+			prefault->memory[i * prefault->page_size] = 0;
+		}
+	}
+
+	auto job_worker_main(void *params) noexcept -> void {
+		JobWorker const *worker = static_cast<JobWorker const *>(params);
+		JobPool *pool = worker->pool;
+		profile_set_thread_name(worker->name);
+
+		// NOTE(Dedrick): The barrier only exists once every thread was launched.
+		os_mutex_lock(pool->start_mutex);
+		os_mutex_unlock(pool->start_mutex);
+		for (;;) {
+			os_barrier_wait(pool->barrier);
+			if (pool->quit) {
+				break;
+			}
+			pool->function(pool->params, worker->index, pool->worker_count);
+			os_barrier_wait(pool->barrier);
+		}
+	}
+}
+
+auto dk::job_pool_alloc(u32 worker_count) noexcept -> JobPool * {
+	DK_ASSERT(worker_count > 0);
+
+	constexpr ArenaParams params = {
+		.reserve_size = ARENA_DEFAULT_RESERVE_SIZE,
+		.commit_size = ARENA_DEFAULT_COMMIT_SIZE,
+		.name = "job_pool"
+	};
+	Arena *arena = arena_alloc(&params);
+
+	JobPool *pool = arena_push_type<JobPool>(arena);
+	pool->arena = arena;
+	pool->threads = arena_push_type_array<OS_Handle>(arena, worker_count);
+	pool->workers = arena_push_type_array<JobWorker>(arena, worker_count);
+	pool->start_mutex = os_mutex_alloc();
+
+	// NOTE(Dedrick): Worker 0 is the calling thread, it never gets a thread of its own. Launching stops at
+	// the first failure so worker indices stay contiguous, the barrier is sized for the threads that started.
+	u32 started_count = 1;
+	os_mutex_lock(pool->start_mutex);
+	for (u32 i = 1; i < worker_count; ++i) {
+		pool->workers[i].pool = pool;
+		pool->workers[i].index = i;
+		pool->workers[i].name = reinterpret_cast<char const *>(str8f(arena, "Worker %u", i).data);
+		pool->threads[i] = os_thread_launch(job_worker_main, &pool->workers[i]);
+		if (pool->threads[i] == os_handle_invalid()) {
+			break;
+		}
+		started_count += 1;
+	}
+	pool->worker_count = started_count;
+	pool->barrier = os_barrier_alloc(started_count);
+	os_mutex_unlock(pool->start_mutex);
+	return pool;
+}
+
+auto dk::job_pool_release(JobPool *pool) noexcept -> void {
+	DK_ASSERT(pool != nullptr);
+
+	pool->quit = true;
+	os_barrier_wait(pool->barrier);
+	for (u32 i = 1; i < pool->worker_count; ++i) {
+		os_thread_join(pool->threads[i]);
+	}
+	os_barrier_release(pool->barrier);
+	os_mutex_release(pool->start_mutex);
+	arena_release(pool->arena);
+}
+
+auto dk::job_pool_run(JobPool *pool, JobFunction function, void *params) noexcept -> void {
+	DK_ASSERT(pool != nullptr && function != nullptr);
+
+	// NOTE(Dedrick): The barriers order these writes before the workers read them.
+	pool->function = function;
+	pool->params = params;
+	os_barrier_wait(pool->barrier);
+	function(params, 0, pool->worker_count);
+	os_barrier_wait(pool->barrier);
+}
+
+auto dk::job_pool_barrier(JobPool *pool) noexcept -> void {
+	os_barrier_wait(pool->barrier);
+}
+
+auto dk::job_range(u64 count, u32 worker_index, u32 worker_count) noexcept -> JobRange {
+	DK_ASSERT(worker_index < worker_count);
+
+	u64 const share = count / worker_count;
+	u64 const remainder = count % worker_count;
+	u64 const begin = worker_index * share + (worker_index < remainder ? worker_index : remainder);
+	u64 const size = share + (worker_index < remainder ? 1 : 0);
+	return { .begin = begin, .end = begin + size };
+}
+
+auto dk::job_queue_alloc(Arena *arena, u32 capacity) noexcept -> JobQueue * {
+	DK_ASSERT(arena != nullptr && capacity > 0);
+
+	JobQueue *queue = arena_push_type<JobQueue>(arena);
+	queue->items = arena_push_type_array<void *>(arena, capacity);
+	queue->capacity = capacity;
+	queue->mutex = os_mutex_alloc();
+	queue->not_empty = os_cond_var_alloc();
+	queue->not_full = os_cond_var_alloc();
+	return queue;
+}
+
+auto dk::job_queue_release(JobQueue *queue) noexcept -> void {
+	DK_ASSERT(queue != nullptr);
+
+	os_cond_var_release(queue->not_full);
+	os_cond_var_release(queue->not_empty);
+	os_mutex_release(queue->mutex);
+}
+
+auto dk::job_queue_push(JobQueue *queue, void *item) noexcept -> b8 {
+	DK_ASSERT(queue != nullptr && item != nullptr);
+
+	os_mutex_lock(queue->mutex);
+	while (queue->count == queue->capacity && !queue->closed) {
+		os_cond_var_wait(queue->not_full, queue->mutex);
+	}
+	b8 const pushed = !queue->closed;
+	if (pushed) {
+		queue->items[(queue->head + queue->count) % queue->capacity] = item;
+		queue->count += 1;
+	}
+	os_mutex_unlock(queue->mutex);
+	if (pushed) {
+		os_cond_var_signal(queue->not_empty);
+	}
+	return pushed;
+}
+
+auto dk::job_queue_pop(JobQueue *queue) noexcept -> void * {
+	DK_ASSERT(queue != nullptr);
+
+	os_mutex_lock(queue->mutex);
+	while (queue->count == 0 && !queue->closed) {
+		os_cond_var_wait(queue->not_empty, queue->mutex);
+	}
+	void *item = nullptr;
+	if (queue->count > 0) {
+		item = queue->items[queue->head];
+		queue->head = (queue->head + 1) % queue->capacity;
+		queue->count -= 1;
+	}
+	os_mutex_unlock(queue->mutex);
+	if (item != nullptr) {
+		os_cond_var_signal(queue->not_full);
+	}
+	return item;
+}
+
+auto dk::job_queue_try_pop(JobQueue *queue) noexcept -> void * {
+	DK_ASSERT(queue != nullptr);
+
+	os_mutex_lock(queue->mutex);
+	void *item = nullptr;
+	if (queue->count > 0) {
+		item = queue->items[queue->head];
+		queue->head = (queue->head + 1) % queue->capacity;
+		queue->count -= 1;
+	}
+	os_mutex_unlock(queue->mutex);
+	if (item != nullptr) {
+		os_cond_var_signal(queue->not_full);
+	}
+	return item;
+}
+
+auto dk::job_queue_close(JobQueue *queue) noexcept -> void {
+	DK_ASSERT(queue != nullptr);
+
+	os_mutex_lock(queue->mutex);
+	queue->closed = true;
+	os_mutex_unlock(queue->mutex);
+	os_cond_var_broadcast(queue->not_empty);
+	os_cond_var_broadcast(queue->not_full);
+}
+
+auto dk::job_prefault(JobPool *pool, void *memory, u64 size) noexcept -> void {
+	DK_ASSERT(pool != nullptr);
+
+	JobPrefaultParams params = {
+		.memory = static_cast<u8 volatile *>(memory),
+		.size = size,
+		.page_size = os_get_system_info()->page_size
+	};
+	job_pool_run(pool, job_prefault_worker, &params);
+}
@@ -0,0 +1,81 @@
+#pragma once
+
+#include "base/base_arena.hpp"
+#include "base/base_types.hpp"
+#include "os/os_core.hpp"
+
+namespace dk {
+	/// Runs once per worker. Worker 0 is the thread that called `job_pool_run`.
+	using JobFunction = void (*)(void *params, u32 worker_index, u32 worker_count);
+
+	struct JobRange {
+		u64 begin;
+		u64 end;
+	};
+
+	struct JobWorker {
+		struct JobPool *pool;
+		char const *name; ///< Thread name in profiler traces.
+		u32 index;
+	};
+
+	/// Fixed set of threads that all run the same function, fork-join style.
+	struct JobPool {
+		Arena *arena;
+		OS_Handle *threads; ///< worker_count - 1 threads, the caller is worker 0.
+		JobWorker *workers;
+		u32 worker_count;
+		OS_Handle barrier; ///< Shared by job start/end and `job_pool_barrier`.
+		OS_Handle start_mutex; ///< Held while the threads are launched, until `barrier` is sized.
+		JobFunction function;
+		void *params;
+		b8 quit;
+	};
+
+	/// Bounded FIFO of pointers between threads, e.g. the stages of a pipeline.
+	struct JobQueue {
+		void **items; ///< Ring of `capacity` slots.
+		u32 capacity;
+		u32 head;
+		u32 count;
+		b8 closed;
+		OS_Handle mutex;
+		OS_Handle not_empty;
+		OS_Handle not_full;
+	};
+
+	/// Workers whose thread could not be launched are dropped, `worker_count` of the pool is the number that run.
+	auto job_pool_alloc(u32 worker_count) noexcept -> JobPool *;
+
+	auto job_pool_release(JobPool *pool) noexcept -> void;
+
+	/// Runs `function` on every worker and returns once all of them have finished.
+	auto job_pool_run(JobPool *pool, JobFunction function, void *params) noexcept -> void;
+
+	/// Blocks until every worker of the running job has reached it.
+	auto job_pool_barrier(JobPool *pool) noexcept -> void;
+
+	/// Contiguous share of [0, count) for `worker_index`, sizes differ by at most one.
+	auto job_range(u64 count, u32 worker_index, u32 worker_count) noexcept -> JobRange;
+
+	/// The ring is pushed on `arena`, which must outlive the queue.
+	auto job_queue_alloc(Arena *arena, u32 capacity) noexcept -> JobQueue *;
+
+	auto job_queue_release(JobQueue *queue) noexcept -> void;
+
+	/// Blocks while the queue is full. Returns false, without queueing the item, once the queue is closed.
+	auto job_queue_push(JobQueue *queue, void *item) noexcept -> b8;
+
+	/// Blocks while the queue is empty. Returns nullptr once the queue is closed and drained.
+	auto job_queue_pop(JobQueue *queue) noexcept -> void *;
+
+	/// Returns nullptr right away when the queue is empty.
+	auto job_queue_try_pop(JobQueue *queue) noexcept -> void *;
+
+	/// Wakes every blocked thread. Items already queued can still be popped.
+	auto job_queue_close(JobQueue *queue) noexcept -> void;
+
+	/// Touches every page of committed memory from all workers, so the first real use does not fault.
+	/// NOTE(Dedrick): Writes the first byte of every page, only use it before the contents matter.
+	auto job_prefault(JobPool *pool, void *memory, u64 size) noexcept -> void;
+}
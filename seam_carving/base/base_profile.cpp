@@ -0,0 +1,155 @@
+#include "base_profile.hpp"
+
+#include "base/base_assert.h"
+#include "base/base_thread_context.hpp"
+
+#include <atomic>
+
+namespace {
+	using namespace dk;
+
+	// NOTE(Dedrick): Slots are claimed and cleared with a CAS, a thread that exits before
+	// the trace is written takes its events with it.
+	std::atomic<ProfileRing *> profile_rings[PROFILE_MAX_THREADS];
+
+	constexpr u32 PROFILE_TRACE_PID = 1;
+	constexpr u32 PROFILE_GPU_TID = PROFILE_MAX_THREADS; ///< Never used by a registered ring.
+
+	struct ProfileTraceWriter {
+		OS_Handle file;
+		u64 offset;
+		b8 failed;
+	};
+
+	auto profile_trace_write(ProfileTraceWriter *writer, Arena *arena, String8List list) noexcept -> void {
+		if (writer->failed || list.node_count == 0) {
+			return;
+		}
+		String8 const output = str8_list_join(arena, list, nullptr);
+		u64 const written = os_file_write(writer->file, writer->offset, writer->offset + output.size, output.data);
+		writer->failed = written != output.size;
+		writer->offset += written;
+	}
+}
+
+b8 dk::profile_enabled = false;
+
+auto dk::profile_ring_alloc(Arena *arena) noexcept -> ProfileRing * {
+	ProfileRing *ring = arena_push_type<ProfileRing>(arena);
+	ring->thread_name = "Thread";
+	for (u32 i = 0; i < PROFILE_MAX_THREADS; ++i) {
+		ProfileRing *expected = nullptr;
+		if (profile_rings[i].compare_exchange_strong(expected, ring)) {
+			ring->slot = i;
+			return ring;
+		}
+	}
+	// NOTE(Dedrick): Out of slots, the thread still records but never shows up in a trace.
+	ring->slot = PROFILE_MAX_THREADS;
+	return ring;
+}
+
+auto dk::profile_ring_release(ProfileRing *ring) noexcept -> void {
+	DK_ASSERT(ring != nullptr);
+
+	if (ring->slot < PROFILE_MAX_THREADS) {
+		ProfileRing *expected = ring;
+		profile_rings[ring->slot].compare_exchange_strong(expected, nullptr);
+	}
+}
+
+auto dk::profile_set_thread_name(char const *name) noexcept -> void {
+	ThreadContext *context = tc_get_selected();
+	if (context != nullptr) {
+		context->profile_ring->thread_name = name;
+	}
+}
+
+auto dk::profile_set_enabled(b8 enabled) noexcept -> void {
+	profile_enabled = enabled;
+}
+
+auto dk::profile_push_event(ProfileTrack track, char const *name, u64 begin_us, u64 end_us) noexcept -> void {
+	ThreadContext *context = tc_get_selected();
+	if (context == nullptr) {
+		return;
+	}
+	ProfileRing *ring = context->profile_ring;
+	ProfileEvent *event = &ring->events[ring->write_count % PROFILE_RING_CAPACITY];
+	event->name = name;
+	event->begin_us = begin_us;
+	event->end_us = end_us;
+	event->track = track;
+	ring->write_count += 1;
+}
+
+auto dk::profile_write_chrome_trace(String8 path) noexcept -> b8 {
+	ProfileTraceWriter writer = {
+		.file = os_file_open(path, OS_ACCESS_FLAG_WRITE),
+	};
+	if (writer.file == os_handle_invalid()) {
+		return false;
+	}
+
+	ScratchArena scratch = arena_scratch_begin(tc_get_scratch(nullptr, 0));
+
+	String8List header = {};
+	str8_list_pushf(
+		scratch.arena,
+		&header,
+		"{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n"
+		"{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":%u,\"args\":{\"name\":\"seam_carving\"}},\n"
+		"{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":%u,\"tid\":%u,\"args\":{\"name\":\"GPU\"}}",
+		PROFILE_TRACE_PID,
+		PROFILE_TRACE_PID,
+		PROFILE_GPU_TID
+	);
+	profile_trace_write(&writer, scratch.arena, header);
+
+	// NOTE(Dedrick): One ring at a time, so the scratch arena never holds more than one ring's worth of JSON.
+	for (u32 i = 0; i < PROFILE_MAX_THREADS; ++i) {
+		ProfileRing const *ring = profile_rings[i].load();
+		if (ring == nullptr) {
+			continue;
+		}
+		u64 const position = arena_pos(scratch.arena);
+
+		String8List events = {};
+		str8_list_pushf(
+			scratch.arena,
+			&events,
+			",\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":%u,\"tid\":%u,\"args\":{\"name\":\"%s\"}}",
+			PROFILE_TRACE_PID,
+			ring->slot,
+			ring->thread_name
+		);
+
+		u64 const end = ring->write_count;
+		u64 const begin = end > PROFILE_RING_CAPACITY ? end - PROFILE_RING_CAPACITY : 0;
+		for (u64 j = begin; j < end; ++j) {
+			ProfileEvent const *event = &ring->events[j % PROFILE_RING_CAPACITY];
+			u32 const tid = event->track == PROFILE_TRACK_GPU ? PROFILE_GPU_TID : ring->slot;
+			u64 const duration = event->end_us > event->begin_us ? event->end_us - event->begin_us : 0;
+			str8_list_pushf(
+				scratch.arena,
+				&events,
+				",\n{\"name\":\"%s\",\"ph\":\"X\",\"pid\":%u,\"tid\":%u,\"ts\":%llu,\"dur\":%llu}",
+				event->name,
+				PROFILE_TRACE_PID,
+				tid,
+				static_cast<unsigned long long>(event->begin_us),
+				static_cast<unsigned long long>(duration)
+			);
+		}
+		profile_trace_write(&writer, scratch.arena, events);
+		arena_pop_to(scratch.arena, position);
+	}
+
+	String8List footer = {};
+	str8_list_push(scratch.arena, &footer, str8_literal("\n]}\n"));
+	profile_trace_write(&writer, scratch.arena, footer);
+
+	arena_scratch_end(scratch);
+	os_file_close(writer.file);
+	return !writer.failed;
+}
@@ -0,0 +1,99 @@
+#pragma once
+
+#include "base/base_arena.hpp"
+#include "base/base_strings.hpp"
+#include "base/base_types.hpp"
+#include "os/os_core.hpp"
+
+#ifndef DK_PROFILE
+#	define DK_PROFILE 1 ///< 0 compiles every zone out.
+#endif
+
+namespace dk {
+	constexpr u64 PROFILE_RING_CAPACITY = 1u << 14; ///< Events kept per thread, oldest are overwritten.
+	constexpr u32 PROFILE_MAX_THREADS = 256;
+
+	enum ProfileTrack : u32 {
+		PROFILE_TRACK_CPU = 0, ///< The thread that recorded the event.
+		PROFILE_TRACK_GPU, ///< GPU timestamps already converted to the CPU clock.
+	};
+
+	struct ProfileEvent {
+		char const *name; ///< String literal, never copied.
+		u64 begin_us;
+		u64 end_us;
+		ProfileTrack track;
+	};
+
+	/// Lives in the thread's arena, below anything a scratch arena can pop.
+	struct ProfileRing {
+		ProfileEvent events[PROFILE_RING_CAPACITY];
+		u64 write_count;
+		char const *thread_name;
+		u32 slot; ///< Index in the registry, used as the trace thread id.
+	};
+
+	extern b8 profile_enabled;
+
+
+	/* --- Threads --- */
+
+	/// Allocates the ring from `arena` and registers it for `profile_write_chrome_trace`.
+	auto profile_ring_alloc(Arena *arena) noexcept -> ProfileRing *;
+
+	/// Unregisters the ring, its events are no longer part of a trace.
+	auto profile_ring_release(ProfileRing *ring) noexcept -> void;
+
+	/// `name` must outlive the thread, e.g. a literal or a string in a long lived arena.
+	auto profile_set_thread_name(char const *name) noexcept -> void;
+
+
+	/* --- Recording --- */
+
+	inline auto profile_is_enabled() noexcept -> b8 {
+		return profile_enabled;
+	}
+
+	auto profile_set_enabled(b8 enabled) noexcept -> void;
+
+	/// Appends to the calling thread's ring, dropped if the thread has none.
+	auto profile_push_event(ProfileTrack track, char const *name, u64 begin_us, u64 end_us) noexcept -> void;
+
+	/// Writes every registered ring as Chrome/Perfetto trace JSON.
+	/// NOTE(Dedrick): Call while the other threads are idle, the rings are read without locking.
+	auto profile_write_chrome_trace(String8 path) noexcept -> b8;
+
+	struct ProfileScope {
+		char const *name;
+		u64 begin_us;
+
+		// NOTE(Dedrick): Inline so a disabled zone costs the one branch on `profile_enabled`.
+		explicit ProfileScope(char const *zone_name) noexcept : name(nullptr), begin_us(0) {
+			if (profile_enabled) {
+				name = zone_name;
+				begin_us = os_now_microseconds();
+			}
+		}
+
+		~ProfileScope() noexcept {
+			if (name != nullptr) {
+				profile_push_event(PROFILE_TRACK_CPU, name, begin_us, os_now_microseconds());
+			}
+		}
+
+		ProfileScope(ProfileScope const &) = delete;
+		auto operator=(ProfileScope const &) -> ProfileScope & = delete;
+	};
+}
+
+#define DK_PROFILE_CONCAT_INNER(a, b) a##b
+#define DK_PROFILE_CONCAT(a, b) DK_PROFILE_CONCAT_INNER(a, b)
+
+#if DK_PROFILE
+/// Times the rest of the enclosing scope. `name` must be a string literal.
+#	define DK_PROFILE_SCOPE(name) ::dk::ProfileScope const DK_PROFILE_CONCAT(dk_profile_scope_, __LINE__){ "" name }
+#	define DK_PROFILE_FUNCTION() ::dk::ProfileScope const DK_PROFILE_CONCAT(dk_profile_scope_, __LINE__){ __func__ }
+#else
+#	define DK_PROFILE_SCOPE(name) ((void)0)
+#	define DK_PROFILE_FUNCTION() ((void)0)
+#endif
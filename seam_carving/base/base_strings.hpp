@@ -80,6 +80,10 @@ namespace dk {
 		return { .data = str, .size = size };
 	}
 
+	inline auto str8_cstring(char const *cstr) noexcept -> String8 {
+		return { .data = reinterpret_cast<u8 const *>(cstr), .size = cstring_length(cstr) };
+	}
+
 	template <usize N>
 	auto str8_literal(char const (&cstr)[N]) noexcept -> String8 {
 		return { .data = reinterpret_cast<u8 const *>(cstr), .size = N - 1 };
@@ -1,26 +1,67 @@
 #include "base_thread_context.hpp"
 
+#include "base/base_alloc_hooks.h"
 #include "base/base_assert.h"
+#include "base/base_math.hpp"
+#include "base/base_profile.hpp"
+
+#include <cstdlib>
+#include <cstring>
 
 namespace {
-	thread_local dk::ThreadContext *tc_thread_local = nullptr;
+	using namespace dk;
+
+	thread_local ThreadContext *tc_thread_local = nullptr;
+
+	/// In front of every hook allocation, keeps the payload 16 byte aligned.
+	struct AllocHookHeader {
+		Arena *arena; ///< nullptr for the heap.
+		u64 size;
+	};
+	static_assert(sizeof(AllocHookHeader) == 16);
+
+	auto alloc_hook_header(void *ptr) noexcept -> AllocHookHeader * {
+		return static_cast<AllocHookHeader *>(ptr) - 1;
+	}
+
+	auto alloc_hook_arena() noexcept -> Arena * {
+		ThreadContext const *context = tc_get_selected();
+		return context != nullptr ? context->alloc_arena : nullptr;
+	}
+
+	/// Arena pointers are only touched by their own thread while its alloc arena is set, see base_alloc_hooks.h.
+	auto alloc_hook_check_owner(AllocHookHeader const *header) noexcept -> void {
+		DK_ASSERT(header->arena == alloc_hook_arena());
+	}
+
+	/// True if `header` is the last thing pushed on its arena.
+	auto alloc_hook_is_top(AllocHookHeader const *header) noexcept -> b8 {
+		Arena const *block = header->arena->current;
+		u8 const *top = static_cast<u8 const *>(block->memory) + (header->arena->offset - block->base_pos);
+		return reinterpret_cast<u8 const *>(header + 1) + header->size == top;
+	}
 }
 
 auto dk::tc_alloc() noexcept -> ThreadContext * {
 	constexpr ArenaParams params = {
 		.reserve_size = ARENA_DEFAULT_RESERVE_SIZE,
-		.commit_size = ARENA_DEFAULT_COMMIT_SIZE
+		.commit_size = ARENA_DEFAULT_COMMIT_SIZE,
+		.keep_size = ARENA_DEFAULT_KEEP_SIZE
 	};
 	Arena *arena = arena_alloc(&params);
+	arena_set_name(arena, "scratch_0");
 	ThreadContext *thread_context = arena_push_type<ThreadContext>(arena);
 	thread_context->scratch_arenas[0] = arena;
 	thread_context->scratch_arenas[1] = arena_alloc(&params);
+	arena_set_name(thread_context->scratch_arenas[1], "scratch_1");
+	thread_context->profile_ring = profile_ring_alloc(arena);
 	return thread_context;
 }
 
 auto dk::tc_release(ThreadContext *context) noexcept -> void {
 	DK_ASSERT(context != nullptr);
 
+	profile_ring_release(context->profile_ring);
 	arena_release(context->scratch_arenas[1]);
 	arena_release(context->scratch_arenas[0]);
 }
@@ -51,3 +92,88 @@ auto dk::tc_get_scratch(Arena **conflicts, u32 count) noexcept -> Arena * {
 	}
 	return nullptr;
 }
+
+auto dk::tc_set_alloc_arena(Arena *arena) noexcept -> Arena * {
+	ThreadContext *context = tc_get_selected();
+	DK_ASSERT(context != nullptr);
+
+	Arena *const previous = context->alloc_arena;
+	context->alloc_arena = arena;
+	return previous;
+}
+
+extern "C" auto dk_alloc_hook_malloc(size_t size) -> void * {
+	Arena *const arena = alloc_hook_arena();
+	AllocHookHeader *header = nullptr;
+	if (arena != nullptr) {
+		header = static_cast<AllocHookHeader *>(arena_push_no_zero(arena, sizeof(AllocHookHeader) + size, 16));
+	} else {
+		header = static_cast<AllocHookHeader *>(std::malloc(sizeof(AllocHookHeader) + size));
+	}
+	if (header == nullptr) {
+		return nullptr;
+	}
+	header->arena = arena;
+	header->size = size;
+	return header + 1;
+}
+
+extern "C" auto dk_alloc_hook_realloc(void *ptr, size_t new_size) -> void * {
+	if (ptr == nullptr) {
+		return dk_alloc_hook_malloc(new_size);
+	}
+
+	AllocHookHeader *const header = alloc_hook_header(ptr);
+	if (header->arena == nullptr) {
+		auto *const grown = static_cast<AllocHookHeader *>(std::realloc(header, sizeof(AllocHookHeader) + new_size));
+		if (grown == nullptr) {
+			return nullptr;
+		}
+		grown->size = new_size;
+		return grown + 1;
+	}
+	alloc_hook_check_owner(header);
+	if (new_size <= header->size) {
+		return ptr;
+	}
+
+	// NOTE(Dedrick): stb grows its buffers by doubling, while nothing else is pushed in between.
+	// Extending the top allocation in place avoids leaving every smaller copy behind. Only tried
+	// when the current block has room, a push that chains a new block is popped again.
+	if (alloc_hook_is_top(header)) {
+		Arena *const arena = header->arena;
+		u64 const extension = new_size - header->size;
+		u64 const block_remaining = arena->current->reserved - (arena->offset - arena->current->base_pos);
+		if (extension <= block_remaining) {
+			u64 const position = arena_pos(arena);
+			void const *const expected = static_cast<u8 *>(ptr) + header->size;
+			if (arena_push_no_zero(arena, extension, 1) == expected) {
+				header->size = new_size;
+				return ptr;
+			}
+			arena_pop_to(arena, position);
+		}
+	}
+
+	void *const result = dk_alloc_hook_malloc(new_size);
+	if (result != nullptr) {
+		std::memcpy(result, ptr, header->size);
+	}
+	return result;
+}
+
+extern "C" auto dk_alloc_hook_free(void *ptr) -> void {
+	if (ptr == nullptr) {
+		return;
+	}
+
+	AllocHookHeader *const header = alloc_hook_header(ptr);
+	if (header->arena == nullptr) {
+		std::free(header);
+		return;
+	}
+	alloc_hook_check_owner(header);
+	if (alloc_hook_is_top(header)) {
+		arena_pop(header->arena, sizeof(AllocHookHeader) + header->size);
+	}
+}
@@ -6,6 +6,8 @@
 namespace dk {
 	struct ThreadContext {
 		Arena *scratch_arenas[2];
+		struct ProfileRing *profile_ring; ///< Below everything pushed on scratch_arenas[0].
+		Arena *alloc_arena; ///< Serves the allocation hooks in base_alloc_hooks.h, nullptr uses the heap.
 	};
 
 	auto tc_alloc() noexcept -> ThreadContext *;
@@ -17,4 +19,8 @@ namespace dk {
 	auto tc_get_selected() noexcept -> ThreadContext *;
 
 	auto tc_get_scratch(Arena **conflicts, u32 count) noexcept -> Arena *;
+
+	/// Routes the allocation hooks on this thread to `arena` and returns the previous one to restore.
+	/// NOTE(Dedrick): Frees are no-ops in an arena, except for the most recent push which is popped.
+	auto tc_set_alloc_arena(Arena *arena) noexcept -> Arena *;
 }
@@ -0,0 +1,973 @@
+/*
+ * Copyright (C) 2025 Koh Swee Teck Dedrick.
+ * Licensed under the Apache License, Version 2.0 (http://www.apache.org/licenses/LICENSE-2.0)
+ */
+
+#include "base/base.hpp"
+#include "os/os.hpp"
+#include "sc/sc_carve.hpp"
+#include "sc/sc_cpu.hpp"
+#include "sc/sc_image.hpp"
+#include "sc/sc_opengl.hpp"
+#include "thirdparty/argh.h"
+
+#include <algorithm>
+
+using namespace dk;
+
+namespace {
+	constexpr s32 SC_BENCH_MAX_SIZES = 8;
+	constexpr s32 SC_BENCH_MAX_SEAM_COUNTS = 8;
+	constexpr s32 SC_BENCH_MAX_IMAGES = 16;
+	constexpr s32 SC_BENCH_MAX_WORKER_COUNTS = 16;
+
+	enum SC_BenchPattern : u8 {
+		SC_BENCH_PATTERN_NOISE = 0,
+		SC_BENCH_PATTERN_GRADIENT,
+		SC_BENCH_PATTERN_TEXT,
+		SC_BENCH_PATTERN_FRACTAL,
+
+		SC_BENCH_PATTERN_MAX_COUNT
+	};
+
+	constexpr char const *sc_bench_pattern_names[SC_BENCH_PATTERN_MAX_COUNT] = {
+		"noise", "gradient", "text", "fractal"
+	};
+
+	enum SC_BenchStage : u8 {
+		SC_BENCH_STAGE_ENERGY = 0,
+		SC_BENCH_STAGE_COST,
+		SC_BENCH_STAGE_FIND_MIN,
+		SC_BENCH_STAGE_BACKTRACE,
+		SC_BENCH_STAGE_REMOVE,
+
+		SC_BENCH_STAGE_MAX_COUNT
+	};
+
+	constexpr char const *sc_bench_stage_names[SC_BENCH_STAGE_MAX_COUNT] = {
+		"energy", "cost", "find_min", "backtrace", "remove"
+	};
+
+	constexpr char const *sc_bench_axis_names[SC_AXIS_MAX_COUNT] = { "vertical", "horizontal" };
+
+	struct SC_BenchConfig {
+		s32 sizes[SC_BENCH_MAX_SIZES];
+		s32 size_count;
+		s32 seam_counts[SC_BENCH_MAX_SEAM_COUNTS];
+		s32 seam_count_count;
+		String8 image_paths[SC_BENCH_MAX_IMAGES];
+		s32 image_count;
+		String8 output_path;
+
+		// NOTE(Dedrick): Thread scaling mode sweeps the CPU engine over worker counts instead.
+		b8 scaling;
+		s32 worker_counts[SC_BENCH_MAX_WORKER_COUNTS];
+		s32 worker_count_count;
+		String8 csv_path;
+		ArenaFlags cpu_arena_flags; ///< Large pages and pre-faulting for the CPU engine buffers.
+
+		s32 repeat; ///< Full carves per seam count.
+		s32 stage_samples; ///< Seams timed stage by stage per axis.
+		s32 seams_per_pass;
+		s32 proxy_scale; ///< 0 or 1 disables proxy carving.
+		b8 pyramid_search;
+		b8 lazy_removal;
+	};
+
+	/// min/median/p99 of a set of samples in milliseconds.
+	struct SC_BenchStats {
+		f64 min_ms;
+		f64 median_ms;
+		f64 p99_ms;
+	};
+
+	/// Deterministic RGBA8 (sRGB) test image, or one of the sample images.
+	struct SC_BenchImage {
+		String8 name;
+		u8 *pixels;
+		s32 width;
+		s32 height;
+	};
+
+	struct SC_BenchContext {
+		Arena *arena; ///< Configuration, JSON output.
+		Arena *image_arena; ///< Pixels of the image being benchmarked, cleared per image.
+		OS_Handle window;
+		SC_ShaderCache shader_cache; ///< No directory, every run compiles from source.
+		SC_Carver carver;
+		GLuint stage_queries[SC_BENCH_STAGE_MAX_COUNT];
+		GLuint carve_query;
+		String8List json;
+		u32 result_count;
+	};
+
+
+	/* --- Synthetic images --- */
+
+	/// splitmix64, the same sequence on every platform.
+	auto sc_bench_random(u64 *state) noexcept -> u32 {
+		*state += 0x9E3779B97F4A7C15ull;
+		u64 z = *state;
+		z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+		z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+		return static_cast<u32>((z ^ (z >> 31)) >> 32);
+	}
+
+	/// Lattice value in [0, 1] for value noise.
+	auto sc_bench_lattice(s32 x, s32 y, u32 seed) noexcept -> f32 {
+		u32 h = static_cast<u32>(x) * 0x8DA6B343u ^ static_cast<u32>(y) * 0xD8163841u ^ seed * 0xCB1AB31Fu;
+		h ^= h >> 16;
+		h *= 0x7FEB352Du;
+		h ^= h >> 15;
+		h *= 0x846CA68Bu;
+		h ^= h >> 16;
+		return static_cast<f32>(h & 0xFFFFFFu) / static_cast<f32>(0xFFFFFFu);
+	}
+
+	auto sc_bench_value_noise(f32 x, f32 y, u32 seed) noexcept -> f32 {
+		s32 const x0 = static_cast<s32>(glm::floor(x));
+		s32 const y0 = static_cast<s32>(glm::floor(y));
+		f32 const tx = glm::smoothstep(0.0f, 1.0f, x - static_cast<f32>(x0));
+		f32 const ty = glm::smoothstep(0.0f, 1.0f, y - static_cast<f32>(y0));
+		f32 const top = glm::mix(sc_bench_lattice(x0, y0, seed), sc_bench_lattice(x0 + 1, y0, seed), tx);
+		f32 const bottom = glm::mix(sc_bench_lattice(x0, y0 + 1, seed), sc_bench_lattice(x0 + 1, y0 + 1, seed), tx);
+		return glm::mix(top, bottom, ty);
+	}
+
+	auto sc_bench_set_pixel(u8 *pixels, s32 width, s32 x, s32 y, vec3 color) noexcept -> void {
+		u8 *p = pixels + (static_cast<usize>(y) * width + x) * 4;
+		p[0] = static_cast<u8>(glm::clamp(color.x, 0.0f, 1.0f) * 255.0f);
+		p[1] = static_cast<u8>(glm::clamp(color.y, 0.0f, 1.0f) * 255.0f);
+		p[2] = static_cast<u8>(glm::clamp(color.z, 0.0f, 1.0f) * 255.0f);
+		p[3] = 255;
+	}
+
+	auto sc_bench_fill_rect(u8 *pixels, s32 width, s32 height, ivec2 min, ivec2 max, u8 value) noexcept -> void {
+		min = glm::clamp(min, ivec2(0), ivec2(width, height));
+		max = glm::clamp(max, ivec2(0), ivec2(width, height));
+		for (s32 y = min.y; y < max.y; ++y) {
+			u8 *row = pixels + static_cast<usize>(y) * width * 4;
+			for (s32 x = min.x; x < max.x; ++x) {
+				row[x * 4 + 0] = value;
+				row[x * 4 + 1] = value;
+				row[x * 4 + 2] = value;
+				row[x * 4 + 3] = 255;
+			}
+		}
+	}
+
+	/// Worst case for the energy pass, every pixel is an edge.
+	auto sc_bench_generate_noise(u8 *pixels, s32 width, s32 height, u64 seed) noexcept -> void {
+		u64 state = seed;
+		u32 *texels = reinterpret_cast<u32 *>(pixels);
+		for (usize i = 0; i < static_cast<usize>(width) * height; ++i) {
+			texels[i] = sc_bench_random(&state) | 0xFF000000u;
+		}
+	}
+
+	/// Near zero energy everywhere, every seam costs about the same.
+	auto sc_bench_generate_gradient(u8 *pixels, s32 width, s32 height) noexcept -> void {
+		for (s32 y = 0; y < height; ++y) {
+			for (s32 x = 0; x < width; ++x) {
+				f32 const u = static_cast<f32>(x) / static_cast<f32>(glm::max(width - 1, 1));
+				f32 const v = static_cast<f32>(y) / static_cast<f32>(glm::max(height - 1, 1));
+				sc_bench_set_pixel(pixels, width, x, y, { u, v, 1.0f - 0.5f * (u + v) });
+			}
+		}
+	}
+
+	/// Lines of seven segment "glyphs" on a light page: dense, thin, axis aligned edges.
+	auto sc_bench_generate_text(u8 *pixels, s32 width, s32 height, u64 seed) noexcept -> void {
+		constexpr s32 glyph_width = 10;
+		constexpr s32 glyph_height = 14;
+		constexpr s32 glyph_advance = glyph_width + 3;
+		constexpr s32 line_advance = glyph_height + 8;
+		constexpr s32 margin = 16;
+		constexpr s32 stroke = 2;
+		constexpr u8 paper = 235;
+		constexpr u8 ink = 30;
+
+		// NOTE(Dedrick): Segments as (min, max) in glyph space: top, middle, bottom,
+		// upper left, upper right, lower left, lower right.
+		constexpr s32 half = glyph_height / 2;
+		ivec4 const segments[7] = {
+			{ 0, 0, glyph_width, stroke },
+			{ 0, half - stroke / 2, glyph_width, half + stroke / 2 },
+			{ 0, glyph_height - stroke, glyph_width, glyph_height },
+			{ 0, 0, stroke, half },
+			{ glyph_width - stroke, 0, glyph_width, half },
+			{ 0, half, stroke, glyph_height },
+			{ glyph_width - stroke, half, glyph_width, glyph_height },
+		};
+
+		sc_bench_fill_rect(pixels, width, height, { 0, 0 }, { width, height }, paper);
+
+		u64 state = seed;
+		for (s32 line_y = margin; line_y + glyph_height <= height - margin; line_y += line_advance) {
+			for (s32 glyph_x = margin; glyph_x + glyph_width <= width - margin; glyph_x += glyph_advance) {
+				u32 const r = sc_bench_random(&state);
+				if (r % 6 == 0) {
+					continue; // Word break.
+				}
+				u32 const segment_mask = (r >> 8) & 0x7Fu;
+				for (s32 i = 0; i < 7; ++i) {
+					if ((segment_mask & (1u << i)) == 0) {
+						continue;
+					}
+					ivec2 const origin = { glyph_x, line_y };
+					sc_bench_fill_rect(
+						pixels, width, height,
+						origin + ivec2(segments[i].x, segments[i].y),
+						origin + ivec2(segments[i].z, segments[i].w),
+						ink
+					);
+				}
+			}
+		}
+	}
+
+	/// Fractal (fBm) landscape, a stand-in for photographs: smooth regions broken up by detail at every scale.
+	auto sc_bench_generate_fractal(u8 *pixels, s32 width, s32 height, u32 seed) noexcept -> void {
+		constexpr s32 octave_count = 6;
+		vec3 const palette[] = {
+			{ 0.10f, 0.20f, 0.45f }, // Deep water
+			{ 0.20f, 0.45f, 0.70f }, // Shallow water
+			{ 0.80f, 0.75f, 0.55f }, // Sand
+			{ 0.25f, 0.55f, 0.20f }, // Grass
+			{ 0.35f, 0.30f, 0.25f }, // Rock
+			{ 0.95f, 0.95f, 0.97f }, // Snow
+		};
+		constexpr s32 palette_count = static_cast<s32>(array_size(palette));
+
+		// NOTE(Dedrick): Frequencies scale with the image so every size shows the same landscape.
+		f32 const base_frequency = 4.0f / static_cast<f32>(glm::max(width, height));
+		for (s32 y = 0; y < height; ++y) {
+			for (s32 x = 0; x < width; ++x) {
+				f32 value = 0.0f;
+				f32 amplitude = 0.5f;
+				f32 frequency = base_frequency;
+				for (s32 octave = 0; octave < octave_count; ++octave) {
+					value += amplitude * sc_bench_value_noise(
+						static_cast<f32>(x) * frequency,
+						static_cast<f32>(y) * frequency,
+						seed + static_cast<u32>(octave)
+					);
+					amplitude *= 0.5f;
+					frequency *= 2.0f;
+				}
+
+				f32 const t = glm::clamp(value, 0.0f, 0.999f) * static_cast<f32>(palette_count - 1);
+				s32 const i = static_cast<s32>(t);
+				vec3 const color = glm::mix(palette[i], palette[i + 1], t - static_cast<f32>(i));
+				sc_bench_set_pixel(pixels, width, x, y, color);
+			}
+		}
+	}
+
+	auto sc_bench_generate(Arena *arena, SC_BenchPattern pattern, s32 size) noexcept -> SC_BenchImage {
+		SC_BenchImage image = {};
+		image.name = str8f(arena, "%s_%d", sc_bench_pattern_names[pattern], size);
+		image.width = size;
+		image.height = size;
+		image.pixels = static_cast<u8 *>(arena_push_no_zero(arena, static_cast<usize>(size) * size * 4, 64));
+
+		u64 const seed = (static_cast<u64>(pattern) << 32) | static_cast<u32>(size);
+		switch (pattern) {
+			case SC_BENCH_PATTERN_NOISE: sc_bench_generate_noise(image.pixels, size, size, seed); break;
+			case SC_BENCH_PATTERN_GRADIENT: sc_bench_generate_gradient(image.pixels, size, size); break;
+			case SC_BENCH_PATTERN_TEXT: sc_bench_generate_text(image.pixels, size, size, seed); break;
+			case SC_BENCH_PATTERN_FRACTAL: sc_bench_generate_fractal(image.pixels, size, size, 1234u); break;
+			default: DK_ASSERT(false); break;
+		}
+		return image;
+	}
+
+
+	/* --- Measurement --- */
+
+	auto sc_bench_stats(f64 *samples_ms, s32 count) noexcept -> SC_BenchStats {
+		SC_BenchStats stats = {};
+		if (count <= 0) {
+			return stats;
+		}
+		std::sort(samples_ms, samples_ms + count);
+		s32 const p99_index = glm::clamp(static_cast<s32>(glm::ceil(0.99 * count)) - 1, 0, count - 1);
+		stats.min_ms = samples_ms[0];
+		stats.median_ms = samples_ms[count / 2];
+		stats.p99_ms = samples_ms[p99_index];
+		return stats;
+	}
+
+	auto sc_bench_query_ms(GLuint query) noexcept -> f64 {
+		GLuint64 time_ns = 0;
+		glGetQueryObjectui64v(query, GL_QUERY_RESULT, &time_ns);
+		return static_cast<f64>(time_ns) / 1000000.0;
+	}
+
+	/// Escapes a string for a JSON string literal. Paths on Windows contain backslashes.
+	auto sc_bench_json_string(Arena *arena, String8 str) noexcept -> String8 {
+		String8List parts = {};
+		u64 run_begin = 0;
+		for (u64 i = 0; i < str.size; ++i) {
+			u8 const c = str.data[i];
+			if (c == '"' || c == '\\' || c < 0x20) {
+				str8_list_push(arena, &parts, { .data = str.data + run_begin, .size = i - run_begin });
+				if (c < 0x20) {
+					str8_list_pushf(arena, &parts, "\\u%04x", c);
+				} else {
+					str8_list_pushf(arena, &parts, "\\%c", c);
+				}
+				run_begin = i + 1;
+			}
+		}
+		str8_list_push(arena, &parts, { .data = str.data + run_begin, .size = str.size - run_begin });
+		StringJoinParams const join = { .prefix = str8_literal("\""), .postfix = str8_literal("\"") };
+		return str8_list_join(arena, parts, &join);
+	}
+
+	auto sc_bench_json_stats(Arena *arena, SC_BenchStats stats) noexcept -> String8 {
+		return str8f(
+			arena,
+			"{ \"min\": %.4f, \"median\": %.4f, \"p99\": %.4f }",
+			stats.min_ms, stats.median_ms, stats.p99_ms
+		);
+	}
+
+	/// Times every stage of the exact single seam path, one sample per removed seam.
+	auto sc_bench_stages(SC_BenchContext *bench, SC_BenchConfig const *cfg, SC_Axis axis, String8List *out_json) noexcept -> void {
+		SC_Carver *carver = &bench->carver;
+		ScratchArena const scratch = arena_scratch_begin(tc_get_scratch(&bench->arena, 1));
+		f64 *samples_ms[SC_BENCH_STAGE_MAX_COUNT];
+		for (f64 *&samples : samples_ms) {
+			samples = arena_push_type_array<f64>(scratch.arena, static_cast<u64>(cfg->stage_samples));
+		}
+
+		sc_carver_reset(carver);
+		ivec2 const texture_size = { carver->max_texture_size, carver->max_texture_size };
+		s32 sample_count = 0;
+		for (; sample_count < cfg->stage_samples; ++sample_count) {
+			s32 const major_dim = axis == SC_AXIS_VERTICAL ? carver->current_width : carver->current_height;
+			if (major_dim <= 2) {
+				break;
+			}
+			ivec2 const size = { carver->current_width, carver->current_height };
+
+			glBeginQuery(GL_TIME_ELAPSED, bench->stage_queries[SC_BENCH_STAGE_ENERGY]);
+			sc_compute_current_energy(carver);
+			glEndQuery(GL_TIME_ELAPSED);
+
+			glBeginQuery(GL_TIME_ELAPSED, bench->stage_queries[SC_BENCH_STAGE_COST]);
+			sc_fill_cost_map(carver, axis, carver->gpu.tex_energy, size, texture_size);
+			glEndQuery(GL_TIME_ELAPSED);
+
+			glBeginQuery(GL_TIME_ELAPSED, bench->stage_queries[SC_BENCH_STAGE_FIND_MIN]);
+			sc_find_min_seam_end(carver, axis, size, texture_size);
+			glEndQuery(GL_TIME_ELAPSED);
+
+			glBeginQuery(GL_TIME_ELAPSED, bench->stage_queries[SC_BENCH_STAGE_BACKTRACE]);
+			sc_backtrace_seam(carver, axis, size, texture_size);
+			glEndQuery(GL_TIME_ELAPSED);
+
+			glBeginQuery(GL_TIME_ELAPSED, bench->stage_queries[SC_BENCH_STAGE_REMOVE]);
+			sc_remove_seam(carver, axis);
+			glEndQuery(GL_TIME_ELAPSED);
+
+			for (s32 stage = 0; stage < SC_BENCH_STAGE_MAX_COUNT; ++stage) {
+				samples_ms[stage][sample_count] = sc_bench_query_ms(bench->stage_queries[stage]);
+			}
+		}
+
+		for (s32 stage = 0; stage < SC_BENCH_STAGE_MAX_COUNT; ++stage) {
+			SC_BenchStats const stats = sc_bench_stats(samples_ms[stage], sample_count);
+			str8_list_pushf(
+				bench->arena,
+				out_json,
+				"{ \"axis\": \"%s\", \"stage\": \"%s\", \"samples\": %d, \"gpu_ms\": %s }",
+				sc_bench_axis_names[axis],
+				sc_bench_stage_names[stage],
+				sample_count,
+				reinterpret_cast<char const *>(sc_bench_json_stats(bench->arena, stats).data)
+			);
+		}
+		arena_scratch_end(scratch);
+	}
+
+	/// Times `repeat` full carves removing `seam_count` seams along `axis` with the configured engine.
+	auto sc_bench_carve(
+		SC_BenchContext *bench,
+		SC_BenchConfig const *cfg,
+		SC_Axis axis,
+		s32 seam_count,
+		String8List *out_json
+	) noexcept -> void {
+		SC_Carver *carver = &bench->carver;
+		ScratchArena const scratch = arena_scratch_begin(tc_get_scratch(&bench->arena, 1));
+		f64 *gpu_ms = arena_push_type_array<f64>(scratch.arena, static_cast<u64>(cfg->repeat));
+		f64 *wall_ms = arena_push_type_array<f64>(scratch.arena, static_cast<u64>(cfg->repeat));
+
+		for (s32 i = 0; i < cfg->repeat; ++i) {
+			sc_carver_reset(carver);
+			glFinish();
+
+			u64 const start_time_us = os_now_microseconds();
+			glBeginQuery(GL_TIME_ELAPSED, bench->carve_query);
+			sc_carver_begin(carver);
+			for (s32 removed = 0; removed < seam_count; ) {
+				removed += sc_carve_seams(carver, axis, seam_count - removed);
+			}
+			sc_carver_materialize(carver);
+			glEndQuery(GL_TIME_ELAPSED);
+			glFinish();
+
+			wall_ms[i] = static_cast<f64>(os_now_microseconds() - start_time_us) / 1000.0;
+			gpu_ms[i] = sc_bench_query_ms(bench->carve_query);
+		}
+
+		SC_BenchStats const gpu_stats = sc_bench_stats(gpu_ms, cfg->repeat);
+		SC_BenchStats const wall_stats = sc_bench_stats(wall_ms, cfg->repeat);
+
+		// NOTE(Dedrick): Throughput from the median wall time. Pixels count the
+		// whole original image once per removed seam, like an energy + DP sweep does.
+		f64 const seconds = wall_stats.median_ms / 1000.0;
+		f64 const pixel_count = static_cast<f64>(carver->original_width) * static_cast<f64>(carver->original_height);
+		f64 const seams_per_second = seconds > 0.0 ? static_cast<f64>(seam_count) / seconds : 0.0;
+		f64 const pixels_per_second = seams_per_second * pixel_count;
+
+		str8_list_pushf(
+			bench->arena,
+			out_json,
+			"{ \"axis\": \"%s\", \"seams\": %d, \"repeat\": %d, \"gpu_ms\": %s, \"wall_ms\": %s, "
+			"\"seams_per_sec\": %.2f, \"pixels_per_sec\": %.0f }",
+			sc_bench_axis_names[axis],
+			seam_count,
+			cfg->repeat,
+			reinterpret_cast<char const *>(sc_bench_json_stats(bench->arena, gpu_stats).data),
+			reinterpret_cast<char const *>(sc_bench_json_stats(bench->arena, wall_stats).data),
+			seams_per_second,
+			pixels_per_second
+		);
+		arena_scratch_end(scratch);
+	}
+
+	auto sc_bench_image(SC_BenchContext *bench, SC_BenchConfig const *cfg, SC_BenchImage const *image) noexcept -> void {
+		std::printf("%.*s (%dx%d)\n", static_cast<int>(image->name.size), image->name.data, image->width, image->height);
+
+		sc_carver_load_image(&bench->carver, image->pixels, image->width, image->height);
+
+		String8List stages = {};
+		for (u32 axis = 0; axis < SC_AXIS_MAX_COUNT; ++axis) {
+			sc_bench_stages(bench, cfg, static_cast<SC_Axis>(axis), &stages);
+		}
+
+		String8List carves = {};
+		for (u32 axis = 0; axis < SC_AXIS_MAX_COUNT; ++axis) {
+			s32 const major_dim = axis == SC_AXIS_VERTICAL ? image->width : image->height;
+			for (s32 i = 0; i < cfg->seam_count_count; ++i) {
+				s32 const seam_count = glm::min(cfg->seam_counts[i], major_dim - 1);
+				if (seam_count > 0) {
+					sc_bench_carve(bench, cfg, static_cast<SC_Axis>(axis), seam_count, &carves);
+				}
+			}
+		}
+
+		StringJoinParams const list_join = {
+			.prefix = str8_literal("[\n\t\t\t\t"),
+			.postfix = str8_literal("\n\t\t\t]"),
+			.separator = str8_literal(",\n\t\t\t\t")
+		};
+		String8 const stages_json = str8_list_join(bench->arena, stages, &list_join);
+		String8 const carves_json = str8_list_join(bench->arena, carves, &list_join);
+		String8 const name_json = sc_bench_json_string(bench->arena, image->name);
+		str8_list_pushf(
+			bench->arena,
+			&bench->json,
+			"%s\t\t{\n"
+			"\t\t\t\"image\": %s,\n"
+			"\t\t\t\"width\": %d,\n"
+			"\t\t\t\"height\": %d,\n"
+			"\t\t\t\"peak_memory_bytes\": %llu,\n"
+			"\t\t\t\"stages\": %s,\n"
+			"\t\t\t\"carves\": %s\n"
+			"\t\t}",
+			bench->result_count > 0 ? ",\n" : "",
+			reinterpret_cast<char const *>(name_json.data),
+			image->width,
+			image->height,
+			static_cast<unsigned long long>(os_get_peak_memory_usage()),
+			reinterpret_cast<char const *>(stages_json.data),
+			reinterpret_cast<char const *>(carves_json.data)
+		);
+		bench->result_count += 1;
+	}
+
+	auto sc_bench_write_results(SC_BenchContext *bench, SC_BenchConfig const *cfg) noexcept -> b8 {
+		Arena *arena = bench->arena;
+		String8 const vendor = sc_bench_json_string(arena, str8_cstring(reinterpret_cast<char const *>(glGetString(GL_VENDOR))));
+		String8 const renderer = sc_bench_json_string(arena, str8_cstring(reinterpret_cast<char const *>(glGetString(GL_RENDERER))));
+		String8 const version = sc_bench_json_string(arena, str8_cstring(reinterpret_cast<char const *>(glGetString(GL_VERSION))));
+
+		String8List document = {};
+		str8_list_pushf(
+			arena,
+			&document,
+			"{\n"
+			"\t\"device\": { \"vendor\": %s, \"renderer\": %s, \"version\": %s },\n"
+			"\t\"config\": { \"seams_per_pass\": %d, \"proxy_scale\": %d, \"seam_search\": \"%s\", "
+			"\"lazy_removal\": %s, \"repeat\": %d, \"stage_samples\": %d, \"max_texture_size\": %d },\n"
+			"\t\"peak_memory_bytes\": %llu,\n"
+			"\t\"gpu_memory_bytes\": %llu,\n"
+			"\t\"results\": [\n",
+			reinterpret_cast<char const *>(vendor.data),
+			reinterpret_cast<char const *>(renderer.data),
+			reinterpret_cast<char const *>(version.data),
+			bench->carver.seams_per_pass,
+			cfg->proxy_scale > 1 ? bench->carver.proxy_scale : 0,
+			cfg->pyramid_search ? "pyramid" : "exact",
+			cfg->lazy_removal ? "true" : "false",
+			cfg->repeat,
+			cfg->stage_samples,
+			bench->carver.max_texture_size,
+			static_cast<unsigned long long>(os_get_peak_memory_usage()),
+			static_cast<unsigned long long>(sc_carver_gpu_bytes(bench->carver.max_texture_size))
+		);
+		for (String8Node const *node = bench->json.first; node != nullptr; node = node->next) {
+			str8_list_push(arena, &document, node->string);
+		}
+		str8_list_push(arena, &document, str8_literal("\n\t]\n}\n"));
+		String8 const output = str8_list_join(arena, document, nullptr);
+
+		OS_Handle const file = os_file_open(cfg->output_path, OS_ACCESS_FLAG_WRITE);
+		if (file == os_handle_invalid()) {
+			return false;
+		}
+		u64 const written = os_file_write(file, 0, output.size, output.data);
+		os_file_close(file);
+		return written == output.size;
+	}
+
+	auto sc_bench_run_gpu(
+		Arena *arena,
+		Arena *image_arena,
+		SC_BenchConfig const *cfg,
+		SC_BenchImage const *images,
+		s32 max_texture_size
+	) noexcept -> int {
+		os_gfx_init();
+		SC_BenchContext bench = {};
+		bench.arena = arena;
+		bench.image_arena = image_arena;
+		bench.window = os_window_open(str8_literal("sc_bench"), 0, 0, 64, 64, OS_WINDOW_FLAG_HIDDEN);
+		if (bench.window == os_handle_invalid()) {
+			os_gfx_shutdown();
+			return 1;
+		}
+		gladLoaderLoadGL();
+		os_window_swap_interval(0);
+
+		sc_shader_cache_init(&bench.shader_cache, arena, str8_literal(""));
+		sc_carver_init(&bench.carver, max_texture_size, &bench.shader_cache);
+		// NOTE(Dedrick): Seam programs are otherwise created by the first carve, inside its timing.
+		for (u32 axis = 0; axis < SC_AXIS_MAX_COUNT; ++axis) {
+			sc_carver_prepare_axis(&bench.carver, static_cast<SC_Axis>(axis));
+		}
+		sc_shader_cache_poll(&bench.shader_cache, true);
+		bench.carver.seams_per_pass = glm::clamp(cfg->seams_per_pass, 1, SC_MAX_SEAMS_PER_PASS);
+		bench.carver.seam_search = cfg->pyramid_search ? SC_SeamSearch::PYRAMID : SC_SeamSearch::EXACT;
+		if (cfg->proxy_scale > 1) {
+			bench.carver.proxy_scale = glm::min(cfg->proxy_scale, SC_PROXY_MAX_SCALE);
+			bench.carver.flags |= SC_CARVE_FLAG_PROXY;
+		}
+		if (cfg->lazy_removal) {
+			bench.carver.flags |= SC_CARVE_FLAG_LAZY_REMOVAL;
+		}
+		glCreateQueries(GL_TIME_ELAPSED, SC_BENCH_STAGE_MAX_COUNT, bench.stage_queries);
+		glCreateQueries(GL_TIME_ELAPSED, 1, &bench.carve_query);
+
+		for (s32 i = 0; i < cfg->size_count; ++i) {
+			for (u32 pattern = 0; pattern < SC_BENCH_PATTERN_MAX_COUNT; ++pattern) {
+				arena_clear(bench.image_arena);
+				SC_BenchImage const image = sc_bench_generate(bench.image_arena, static_cast<SC_BenchPattern>(pattern), cfg->sizes[i]);
+				sc_bench_image(&bench, cfg, &image);
+			}
+		}
+		// NOTE(Dedrick): Hand the largest corpus image back to the OS before the sample images run.
+		arena_clear(bench.image_arena);
+		arena_trim(bench.image_arena);
+		for (s32 i = 0; i < cfg->image_count; ++i) {
+			if (images[i].pixels != nullptr) {
+				sc_bench_image(&bench, cfg, &images[i]);
+			}
+		}
+
+		b8 const written = sc_bench_write_results(&bench, cfg);
+		if (written) {
+			std::printf("Results written to %s\n", reinterpret_cast<char const *>(cfg->output_path.data));
+		} else {
+			(void)std::fprintf(stderr, "Error: failed to write %s\n", reinterpret_cast<char const *>(cfg->output_path.data));
+		}
+
+		glDeleteQueries(1, &bench.carve_query);
+		glDeleteQueries(SC_BENCH_STAGE_MAX_COUNT, bench.stage_queries);
+		sc_carver_release(&bench.carver);
+		sc_shader_cache_release(&bench.shader_cache);
+		os_window_close(bench.window);
+		os_gfx_shutdown();
+		return written ? 0 : 1;
+	}
+
+	/* --- Thread scaling (CPU engine) --- */
+
+	constexpr char const *sc_bench_cpu_stage_names[SC_CPU_STAGE_MAX_COUNT] = {
+		"energy", "cost", "find_min", "backtrace", "remove", "transpose"
+	};
+
+	/// One worker count of the sweep, taken from the run with the median end-to-end time.
+	struct SC_BenchScalingPoint {
+		u32 worker_count;
+		u64 total_us;
+		SC_CpuStageTimes times;
+
+		// NOTE(Dedrick): Carver setup, image load and the first seam, where fresh pages are first touched.
+		u64 cold_us;
+		u64 cold_page_faults;
+		u64 page_faults; ///< During the median run.
+		b8 large_pages; ///< The buffers got the large pages that were asked for.
+	};
+
+	auto sc_bench_scaling_point(
+		SC_BenchConfig const *cfg,
+		SC_BenchImage const *image,
+		u32 worker_count,
+		s32 seam_count
+	) noexcept -> SC_BenchScalingPoint {
+		// NOTE(Dedrick): A single worker runs without a pool, so the baseline is the plain sequential code.
+		JobPool *pool = worker_count > 1 ? job_pool_alloc(worker_count) : nullptr;
+		u64 const cold_fault_start = os_get_page_fault_count();
+		u64 const cold_start_us = os_now_microseconds();
+		SC_CpuCarver carver = {};
+		sc_cpu_carver_init(
+			&carver, pool, static_cast<u64>(image->width) * image->height,
+			glm::max(image->width, image->height), cfg->cpu_arena_flags
+		);
+		sc_cpu_carver_load_image(&carver, image->pixels, image->width, image->height);
+
+		// NOTE(Dedrick): The warm-up is kept out of the runs, so the first touch of the freshly
+		// committed buffers only shows up in the cold numbers.
+		sc_cpu_carve_seams(&carver, SC_AXIS_VERTICAL, 1);
+		u64 const cold_us = os_now_microseconds() - cold_start_us;
+		u64 const cold_page_faults = os_get_page_fault_count() - cold_fault_start;
+		b8 const large_pages = (carver.arena->flags & ARENA_FLAG_LARGE_PAGES) != 0;
+
+		ScratchArena const scratch = arena_scratch_begin(tc_get_scratch(nullptr, 0));
+		SC_BenchScalingPoint *runs = arena_push_type_array<SC_BenchScalingPoint>(scratch.arena, static_cast<u64>(cfg->repeat));
+		for (s32 i = 0; i < cfg->repeat; ++i) {
+			sc_cpu_carver_reset(&carver);
+			u64 const fault_start = os_get_page_fault_count();
+			u64 const start_time_us = os_now_microseconds();
+			sc_cpu_carve_seams(&carver, SC_AXIS_VERTICAL, seam_count);
+			runs[i].worker_count = carver.worker_count;
+			runs[i].total_us = os_now_microseconds() - start_time_us;
+			runs[i].times = carver.times;
+			runs[i].cold_us = cold_us;
+			runs[i].cold_page_faults = cold_page_faults;
+			runs[i].page_faults = os_get_page_fault_count() - fault_start;
+			runs[i].large_pages = large_pages;
+		}
+		std::sort(runs, runs + cfg->repeat, [](SC_BenchScalingPoint const &a, SC_BenchScalingPoint const &b) {
+			return a.total_us < b.total_us;
+		});
+		SC_BenchScalingPoint const point = runs[cfg->repeat / 2];
+		arena_scratch_end(scratch);
+
+		sc_cpu_carver_release(&carver);
+		if (pool != nullptr) {
+			job_pool_release(pool);
+		}
+		return point;
+	}
+
+	/// Sweeps the worker counts on one image and appends a table row and a CSV line per stage.
+	/// Speedup and efficiency are relative to the first worker count of the sweep.
+	auto sc_bench_scaling_image(Arena *arena, SC_BenchConfig const *cfg, SC_BenchImage const *image, String8List *csv) noexcept -> void {
+		s32 const seam_count = glm::min(cfg->seam_counts[0], image->width - 1);
+		if (seam_count <= 0) {
+			return;
+		}
+
+		SC_BenchScalingPoint points[SC_BENCH_MAX_WORKER_COUNTS] = {};
+		for (s32 i = 0; i < cfg->worker_count_count; ++i) {
+			points[i] = sc_bench_scaling_point(cfg, image, static_cast<u32>(cfg->worker_counts[i]), seam_count);
+		}
+
+		std::printf(
+			"\n%.*s (%dx%d), %d vertical seams\n"
+			"%8s  %-10s %12s %9s %11s %10s %7s\n",
+			static_cast<int>(image->name.size), image->name.data, image->width, image->height, seam_count,
+			"workers", "stage", "time_ms", "speedup", "efficiency", "wait_ms", "wait"
+		);
+
+		SC_BenchScalingPoint const *base = &points[0];
+		for (s32 i = 0; i < cfg->worker_count_count; ++i) {
+			SC_BenchScalingPoint const *point = &points[i];
+			f64 const relative_workers = static_cast<f64>(point->worker_count) / static_cast<f64>(base->worker_count);
+
+			// NOTE(Dedrick): The last row is end-to-end, its wait is the sum over all stages.
+			for (s32 stage = 0; stage <= SC_CPU_STAGE_MAX_COUNT; ++stage) {
+				b8 const is_total = stage == SC_CPU_STAGE_MAX_COUNT;
+				u64 const base_us = is_total ? base->total_us : base->times.time_us[stage];
+				u64 const time_us = is_total ? point->total_us : point->times.time_us[stage];
+				u64 wait_us = 0;
+				if (is_total) {
+					for (u64 const stage_wait_us : point->times.wait_us) {
+						wait_us += stage_wait_us;
+					}
+				} else {
+					wait_us = point->times.wait_us[stage];
+				}
+				if (time_us == 0) {
+					continue;
+				}
+
+				f64 const speedup = static_cast<f64>(base_us) / static_cast<f64>(time_us);
+				f64 const efficiency = speedup / relative_workers;
+				f64 const wait_ms = static_cast<f64>(wait_us) / static_cast<f64>(point->worker_count) / 1000.0;
+				f64 const wait_fraction = static_cast<f64>(wait_us) / (static_cast<f64>(time_us) * point->worker_count);
+				char const *stage_name = is_total ? "total" : sc_bench_cpu_stage_names[stage];
+
+				std::printf(
+					"%8u  %-10s %12.3f %8.2fx %10.1f%% %10.3f %6.1f%%\n",
+					point->worker_count, stage_name, static_cast<f64>(time_us) / 1000.0,
+					speedup, efficiency * 100.0, wait_ms, wait_fraction * 100.0
+				);
+				str8_list_pushf(
+					arena, csv,
+					"%.*s,%d,%d,%d,%u,%s,%.4f,%.4f,%.4f,%.4f,%.4f,%.4f,%llu,%llu,%d\n",
+					static_cast<int>(image->name.size), image->name.data, image->width, image->height, seam_count,
+					point->worker_count, stage_name, static_cast<f64>(time_us) / 1000.0,
+					speedup, efficiency, wait_ms, wait_fraction,
+					static_cast<f64>(point->cold_us) / 1000.0,
+					static_cast<unsigned long long>(point->cold_page_faults),
+					static_cast<unsigned long long>(point->page_faults),
+					point->large_pages ? 1 : 0
+				);
+			}
+			std::printf(
+				"%8u  %-10s %12.3f   (%llu page faults, %llu in the timed run, %s pages)\n",
+				point->worker_count, "cold", static_cast<f64>(point->cold_us) / 1000.0,
+				static_cast<unsigned long long>(point->cold_page_faults),
+				static_cast<unsigned long long>(point->page_faults),
+				point->large_pages ? "large" : "normal"
+			);
+		}
+	}
+
+	auto sc_bench_run_scaling(
+		Arena *arena,
+		Arena *image_arena,
+		SC_BenchConfig const *cfg,
+		SC_BenchImage const *images
+	) noexcept -> int {
+		std::printf("CPU kernels: %s\n", (cpu_features() & CPU_FEATURE_FLAG_AVX2) != 0 ? "AVX2" : "SSE2");
+		// NOTE(Dedrick): Reading the DTLB miss counters needs an elevated ETW session with PMC sources,
+		// the bench does not run one. Large pages only show up in the time and page fault columns.
+		std::printf("TLB misses: not measured, record them with WPR/xperf PMC sampling to compare --large-pages.\n");
+
+		String8List csv = {};
+		str8_list_push(arena, &csv, str8_literal("image,width,height,seams,workers,stage,time_ms,speedup,efficiency,wait_ms,wait_fraction,cold_ms,cold_page_faults,page_faults,large_pages\n"));
+
+		for (s32 i = 0; i < cfg->size_count; ++i) {
+			for (u32 pattern = 0; pattern < SC_BENCH_PATTERN_MAX_COUNT; ++pattern) {
+				arena_clear(image_arena);
+				SC_BenchImage const image = sc_bench_generate(image_arena, static_cast<SC_BenchPattern>(pattern), cfg->sizes[i]);
+				sc_bench_scaling_image(arena, cfg, &image, &csv);
+			}
+		}
+		arena_clear(image_arena);
+		arena_trim(image_arena);
+		for (s32 i = 0; i < cfg->image_count; ++i) {
+			if (images[i].pixels != nullptr) {
+				sc_bench_scaling_image(arena, cfg, &images[i], &csv);
+			}
+		}
+
+		String8 const output = str8_list_join(arena, csv, nullptr);
+		OS_Handle const file = os_file_open(cfg->csv_path, OS_ACCESS_FLAG_WRITE);
+		u64 const written = os_file_write(file, 0, output.size, output.data);
+		os_file_close(file);
+		if (written != output.size) {
+			(void)std::fprintf(stderr, "Error: failed to write %s\n", reinterpret_cast<char const *>(cfg->csv_path.data));
+			return 1;
+		}
+		std::printf("\nResults written to %s\n", reinterpret_cast<char const *>(cfg->csv_path.data));
+		return 0;
+	}
+
+	/// Parses a comma separated list of positive integers, e.g. "512,1024".
+	auto sc_bench_parse_list(std::string const &text, s32 *out_values, s32 max_count) noexcept -> s32 {
+		s32 count = 0;
+		s32 value = 0;
+		b8 has_digit = false;
+		for (usize i = 0; i <= text.size(); ++i) {
+			char const c = i < text.size() ? text[i] : ',';
+			if (c >= '0' && c <= '9') {
+				value = value * 10 + (c - '0');
+				has_digit = true;
+			} else if (c == ',') {
+				if (has_digit && value > 0 && count < max_count) {
+					out_values[count++] = value;
+				}
+				value = 0;
+				has_digit = false;
+			}
+		}
+		return count;
+	}
+}
+
+extern auto entry_point(int argc, char **argv) noexcept -> int {
+	argh::parser opts{};
+	opts.add_params({
+		"-s", "--sizes",
+		"-n", "--seams",
+		"-r", "--repeat",
+		"-o", "--output",
+		"--images",
+		"--stage-samples",
+		"--seams-per-pass",
+		"--proxy-scale",
+		"--workers",
+		"--csv",
+	});
+	opts.parse(argc, argv);
+
+	if (opts[{ "-h", "--help" }]) {
+		std::printf(
+			"\nUsage: %s [options]\n"
+			"Options:\n"
+			"  -h, --help                  Show this help message.\n"
+			"  -s, --sizes <list>          Synthetic image sizes (default: 512,1024,2048,4096,8192).\n"
+			"  -n, --seams <list>          Seams removed per full carve (default: 16,128).\n"
+			"  -r, --repeat <int>          Full carves per seam count (default: 5).\n"
+			"  -o, --output <path>         JSON results (default: sc_bench.json).\n"
+			"  --images <list>             Images carved after the synthetic corpus\n"
+			"                              (default: images/broadway_tower.jpg,images/pietro.jpg).\n"
+			"  --stage-samples <int>       Seams timed stage by stage per axis (default: 16).\n"
+			"  --seams-per-pass <int>      Seams removed per cost map (default: 1, max: %d).\n"
+			"  --proxy-scale <int>         Find seams on a 1/N downscaled proxy (default: off, max: %d).\n"
+			"  --pyramid                   Use the coarse-to-fine seam search.\n"
+			"  --lazy                      Use lazy seam removal.\n"
+			"  --arena-report              Print the memory arenas to stderr at exit.\n"
+			"\n"
+			"Thread scaling (CPU engine, vertical seams, first --seams count):\n"
+			"  --scaling                   Sweep worker counts instead of running the GPU benchmark.\n"
+			"  --workers <list>            Worker counts (default: 1,2,4,... up to the logical processor count).\n"
+			"  --csv <path>                CSV results (default: sc_bench_scaling.csv).\n"
+			"  --large-pages               Back the CPU engine buffers with large pages (needs SeLockMemoryPrivilege).\n"
+			"  --prefault                  Pre-fault the CPU engine buffers on all workers when they are created.\n",
+			argv[0],
+			SC_MAX_SEAMS_PER_PASS,
+			SC_PROXY_MAX_SCALE
+		);
+		return 0;
+	}
+
+	constexpr ArenaParams params = {
+		.reserve_size = ARENA_DEFAULT_RESERVE_SIZE,
+		.commit_size = ARENA_DEFAULT_COMMIT_SIZE,
+		.name = "bench"
+	};
+	Arena *arena = arena_alloc(&params);
+
+	SC_BenchConfig cfg{};
+	cfg.size_count = sc_bench_parse_list(opts({ "-s", "--sizes" }, "512,1024,2048,4096,8192").str(), cfg.sizes, SC_BENCH_MAX_SIZES);
+	cfg.seam_count_count = sc_bench_parse_list(opts({ "-n", "--seams" }, "16,128").str(), cfg.seam_counts, SC_BENCH_MAX_SEAM_COUNTS);
+	opts({ "-r", "--repeat" }, 5) >> cfg.repeat;
+	opts({ "--stage-samples" }, 16) >> cfg.stage_samples;
+	opts({ "--seams-per-pass" }, 1) >> cfg.seams_per_pass;
+	opts({ "--proxy-scale" }, 0) >> cfg.proxy_scale;
+	cfg.pyramid_search = opts["--pyramid"];
+	cfg.lazy_removal = opts["--lazy"];
+	cfg.scaling = opts["--scaling"];
+	if (opts["--large-pages"]) {
+		cfg.cpu_arena_flags |= ARENA_FLAG_LARGE_PAGES;
+	}
+	if (opts["--prefault"]) {
+		cfg.cpu_arena_flags |= ARENA_FLAG_PREFAULT;
+	}
+	cfg.repeat = glm::max(cfg.repeat, 1);
+	cfg.stage_samples = glm::max(cfg.stage_samples, 1);
+
+	cfg.output_path = str8_copy(arena, str8_cstring(opts({ "-o", "--output" }, "sc_bench.json").str().c_str()));
+	cfg.csv_path = str8_copy(arena, str8_cstring(opts({ "--csv" }, "sc_bench_scaling.csv").str().c_str()));
+	if (cfg.seam_count_count == 0) {
+		cfg.seam_counts[cfg.seam_count_count++] = 16;
+	}
+
+	cfg.worker_count_count = sc_bench_parse_list(opts({ "--workers" }).str(), cfg.worker_counts, SC_BENCH_MAX_WORKER_COUNTS);
+	if (cfg.worker_count_count == 0) {
+		s32 const logical_processor_count = static_cast<s32>(os_get_system_info()->logical_processor_count);
+		for (s32 n = 1; n < logical_processor_count && cfg.worker_count_count < SC_BENCH_MAX_WORKER_COUNTS - 1; n *= 2) {
+			cfg.worker_counts[cfg.worker_count_count++] = n;
+		}
+		cfg.worker_counts[cfg.worker_count_count++] = glm::max(logical_processor_count, 1);
+	}
+	std::string const image_list = opts({ "--images" }, "images/broadway_tower.jpg,images/pietro.jpg").str();
+	String8 const separators[] = { str8_literal(",") };
+	String8List const image_paths = str8_list_split(
+		arena,
+		str8_copy(arena, str8_cstring(image_list.c_str())),
+		separators,
+		array_size(separators)
+	);
+	for (String8Node const *node = image_paths.first; node != nullptr && cfg.image_count < SC_BENCH_MAX_IMAGES; node = node->next) {
+		cfg.image_paths[cfg.image_count++] = str8_copy(arena, node->string);
+	}
+
+	// NOTE(Dedrick): Every texture is allocated at the largest size benchmarked,
+	// so the sample images only widen it if they are bigger than the corpus.
+	s32 max_size = 0;
+	for (s32 i = 0; i < cfg.size_count; ++i) {
+		max_size = glm::max(max_size, cfg.sizes[i]);
+	}
+	SC_BenchImage images[SC_BENCH_MAX_IMAGES] = {};
+	// NOTE(Dedrick): The decoded images live in the bench arena until exit, stb's temporaries with them.
+	for (s32 i = 0; i < cfg.image_count; ++i) {
+		SC_Image const image = sc_image_load(arena, cfg.image_paths[i]);
+		images[i].pixels = image.pixels;
+		images[i].width = image.width;
+		images[i].height = image.height;
+		images[i].name = cfg.image_paths[i];
+		if (images[i].pixels == nullptr) {
+			(void)std::fprintf(stderr, "Warning: failed to load %s, skipping.\n", reinterpret_cast<char const *>(cfg.image_paths[i].data));
+			continue;
+		}
+		max_size = glm::max(max_size, glm::max(images[i].width, images[i].height));
+	}
+	if (max_size <= 0) {
+		(void)std::fprintf(stderr, "Error: nothing to benchmark.\n");
+		arena_release(arena);
+		return 1;
+	}
+
+	// NOTE(Dedrick): The corpus images are generated one at a time into this arena,
+	// reserve enough for the largest one.
+	ArenaParams const image_params = {
+		.reserve_size = static_cast<u64>(max_size) * max_size * 4 + mega_bytes(1),
+		.commit_size = mega_bytes(1),
+		.name = "bench_image",
+		.keep_size = ARENA_DEFAULT_KEEP_SIZE
+	};
+	Arena *image_arena = arena_alloc(&image_params);
+
+	int const result = cfg.scaling
+		? sc_bench_run_scaling(arena, image_arena, &cfg, images)
+		: sc_bench_run_gpu(arena, image_arena, &cfg, images, max_size);
+
+	if (opts["--arena-report"]) {
+		arena_report_print();
+	}
+
+	arena_release(image_arena);
+	arena_release(arena);
+	return result;
+}
@@ -6,6 +6,7 @@
 extern auto entry_point(int argc, char **argv) noexcept -> int;
 
 #ifdef _WIN32
+#include "base/base_profile.hpp"
 #include "base/base_strings.hpp"
 #include "base/base_thread_context.hpp"
 #include "os/os_core_win32.hpp"
@@ -44,6 +45,7 @@ int WINAPI WinMain(HINSTANCE h_instance, HINSTANCE h_prev_instance, LPSTR p_cmd_
 		dk::OS_SystemInfo *info = &dk::os_win32_context.system_info;
 		info->logical_processor_count = static_cast<dk::u32>(sys_info.dwNumberOfProcessors);
 		info->page_size = sys_info.dwPageSize;
+		info->large_page_size = dk::os_win32_enable_large_pages() ? GetLargePageMinimum() : 0;
 	}
 	{
 		dk::os_win32_context.perf_frequency = 1;
@@ -55,6 +57,7 @@ int WINAPI WinMain(HINSTANCE h_instance, HINSTANCE h_prev_instance, LPSTR p_cmd_
 
 	dk::ThreadContext *thread_context = dk::tc_alloc();
 	dk::tc_select(thread_context);
+	dk::profile_set_thread_name("Main");
 
 	int argc = 0;
 	LPWSTR *argvw = CommandLineToArgvW(GetCommandLineW(), &argc);
@@ -64,7 +67,8 @@ int WINAPI WinMain(HINSTANCE h_instance, HINSTANCE h_prev_instance, LPSTR p_cmd_
 
 	constexpr dk::ArenaParams args_arena_params = {
 		.reserve_size = dk::mega_bytes(1),
-		.commit_size = dk::kilo_bytes(32)
+		.commit_size = dk::kilo_bytes(32),
+		.name = "args"
 	};
 	dk::Arena *args_arena = dk::arena_alloc(&args_arena_params);
 
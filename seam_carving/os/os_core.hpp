@@ -15,6 +15,7 @@ namespace dk {
 	
 	struct OS_SystemInfo {
 		u64 page_size;
+		u64 large_page_size; ///< 0 when this process may not use large pages.
 		u32 logical_processor_count;
 	};
 
@@ -29,6 +30,12 @@ namespace dk {
 		u64 size;
 	};
 
+	/// Read-only view of a whole file.
+	struct OS_FileMap {
+		u8 const *data; ///< nullptr when mapping failed or the file is empty.
+		u64 size;
+	};
+
 	using OS_ThreadFunction = void (*)(void *params);
 
 
@@ -47,10 +54,23 @@ namespace dk {
 	[[noreturn]] auto os_abort(s32 exit_code) noexcept -> void;
 
 
+	/* --- Process Info (implemented per-os) --- */
+
+	/// Peak resident memory of this process in bytes.
+	auto os_get_peak_memory_usage() noexcept -> u64;
+
+	/// Page faults taken by this process so far, soft and hard.
+	auto os_get_page_fault_count() noexcept -> u64;
+
+
 	/* --- Memory Allocation (implemented per-os) --- */
 
 	auto os_reserve(u64 size) noexcept -> void *;
 
+	/// Reserves and commits `size` bytes backed by large pages, a multiple of large_page_size.
+	/// Large pages are resident until released and can not be decommitted. nullptr when unavailable.
+	auto os_reserve_large(u64 size) noexcept -> void *;
+
 	auto os_commit(void *ptr, u64 size) noexcept -> b8;
 
 	auto os_decommit(void *ptr, u64 size) noexcept -> void;
@@ -70,6 +90,59 @@ namespace dk {
 
 	auto os_file_write(OS_Handle file, u64 begin, u64 end, void const *data) noexcept -> u64;
 
+	/// Maps `file` (opened with OS_ACCESS_FLAG_READ) read-only and asks the OS to start reading
+	/// it in, the file handle may be closed while the map is in use.
+	auto os_file_map(OS_Handle file) noexcept -> OS_FileMap;
+
+	auto os_file_unmap(OS_FileMap map) noexcept -> void;
+
+	auto os_path_is_directory(String8 path) noexcept -> b8;
+
+	/// Creates the directory unless it exists, its parent must exist. False when `path` is a file.
+	auto os_directory_create(String8 path) noexcept -> b8;
+
+	/// Names of the files directly inside `directory`, without subdirectories, in the order the OS lists them.
+	auto os_directory_list_files(Arena *arena, String8 directory) noexcept -> String8List;
+
+
+	/* --- Threads (implemented per-os) --- */
+
+	/// Launches `func` on a new thread with its own ThreadContext selected.
+	auto os_thread_launch(OS_ThreadFunction func, void *params) noexcept -> OS_Handle;
+
+	/// Waits for the thread to return and releases the handle.
+	auto os_thread_join(OS_Handle thread) noexcept -> void;
+
+
+	/* --- Synchronization (implemented per-os) --- */
+
+	/// Barrier that releases once `count` threads are waiting on it, reusable.
+	auto os_barrier_alloc(u32 count) noexcept -> OS_Handle;
+
+	auto os_barrier_release(OS_Handle barrier) noexcept -> void;
+
+	auto os_barrier_wait(OS_Handle barrier) noexcept -> void;
+
+	/// Non-recursive lock.
+	auto os_mutex_alloc() noexcept -> OS_Handle;
+
+	auto os_mutex_release(OS_Handle mutex) noexcept -> void;
+
+	auto os_mutex_lock(OS_Handle mutex) noexcept -> void;
+
+	auto os_mutex_unlock(OS_Handle mutex) noexcept -> void;
+
+	auto os_cond_var_alloc() noexcept -> OS_Handle;
+
+	auto os_cond_var_release(OS_Handle cond_var) noexcept -> void;
+
+	/// Unlocks `mutex` while waiting and locks it again before returning, may wake spuriously.
+	auto os_cond_var_wait(OS_Handle cond_var, OS_Handle mutex) noexcept -> void;
+
+	auto os_cond_var_signal(OS_Handle cond_var) noexcept -> void;
+
+	auto os_cond_var_broadcast(OS_Handle cond_var) noexcept -> void;
+
 
 	/* --- Time (implemented per-os) --- */
 
@@ -6,11 +6,33 @@
 
 #define NOMINMAX
 #include <Windows.h>
+#include <Psapi.h>
 
 namespace dk {
 	OS_Win32_Context os_win32_context;
 }
 
+namespace {
+	using namespace dk;
+
+	struct OS_Win32_ThreadStart {
+		OS_ThreadFunction func;
+		void *params;
+	};
+
+	auto WINAPI os_win32_thread_entry(LPVOID param) -> DWORD {
+		OS_Win32_ThreadStart const start = *static_cast<OS_Win32_ThreadStart *>(param);
+		HeapFree(GetProcessHeap(), 0, param);
+
+		ThreadContext *thread_context = tc_alloc();
+		tc_select(thread_context);
+		start.func(start.params);
+		tc_select(nullptr);
+		tc_release(thread_context);
+		return 0;
+	}
+}
+
 auto dk::os_get_system_info() noexcept -> OS_SystemInfo * {
 	return &os_win32_context.system_info;
 }
@@ -19,10 +41,36 @@ auto dk::os_abort(s32 exit_code) noexcept -> void {
 	ExitProcess(exit_code);
 }
 
+auto dk::os_get_peak_memory_usage() noexcept -> u64 {
+	PROCESS_MEMORY_COUNTERS counters = {};
+	counters.cb = sizeof(counters);
+	if (!GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters))) {
+		return 0;
+	}
+	return counters.PeakWorkingSetSize;
+}
+
+auto dk::os_get_page_fault_count() noexcept -> u64 {
+	PROCESS_MEMORY_COUNTERS counters = {};
+	counters.cb = sizeof(counters);
+	if (!GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters))) {
+		return 0;
+	}
+	return counters.PageFaultCount;
+}
+
 auto dk::os_reserve(u64 size) noexcept -> void * {
 	return VirtualAlloc(nullptr, size, MEM_RESERVE, PAGE_READWRITE);
 }
 
+auto dk::os_reserve_large(u64 size) noexcept -> void * {
+	if (os_win32_context.system_info.large_page_size == 0) {
+		return nullptr;
+	}
+	// NOTE(Dedrick): Large pages have to be reserved and committed in one call.
+	return VirtualAlloc(nullptr, size, MEM_RESERVE | MEM_COMMIT | MEM_LARGE_PAGES, PAGE_READWRITE);
+}
+
 auto dk::os_commit(void *ptr, u64 size) noexcept -> b8 {
 	return VirtualAlloc(ptr, size, MEM_COMMIT, PAGE_READWRITE) != nullptr;
 }
@@ -181,6 +229,204 @@ auto dk::os_file_write(OS_Handle file, u64 begin, u64 end, void const *data) noe
 	return total_written_size;
 }
 
+auto dk::os_file_map(OS_Handle file) noexcept -> OS_FileMap {
+	if (file == os_handle_invalid()) {
+		return {};
+	}
+	HANDLE const handle = reinterpret_cast<HANDLE>(file.v);
+	LARGE_INTEGER file_size = {};
+	if (!GetFileSizeEx(handle, &file_size) || file_size.QuadPart == 0) {
+		return {};
+	}
+
+	HANDLE const mapping = CreateFileMappingW(handle, nullptr, PAGE_READONLY, 0, 0, nullptr);
+	if (mapping == nullptr) {
+		return {};
+	}
+	// NOTE(Dedrick): The view keeps the mapping object alive, no need to hold on to it.
+	void *const view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+	CloseHandle(mapping);
+	if (view == nullptr) {
+		return {};
+	}
+
+	OS_FileMap const map = { .data = static_cast<u8 const *>(view), .size = static_cast<u64>(file_size.QuadPart) };
+
+	// NOTE(Dedrick): Closest thing to madvise(WILLNEED), the pages are read in asynchronously
+	// while the caller already works on the front of the file.
+	WIN32_MEMORY_RANGE_ENTRY range = { .VirtualAddress = view, .NumberOfBytes = static_cast<SIZE_T>(map.size) };
+	PrefetchVirtualMemory(GetCurrentProcess(), 1, &range, 0);
+	return map;
+}
+
+auto dk::os_file_unmap(OS_FileMap map) noexcept -> void {
+	if (map.data != nullptr) {
+		UnmapViewOfFile(map.data);
+	}
+}
+
+auto dk::os_path_is_directory(String8 path) noexcept -> b8 {
+	ScratchArena const scratch = arena_scratch_begin(tc_get_scratch(nullptr, 0));
+	String16 const path16 = str16_from_8(scratch.arena, path);
+	DWORD const attributes = GetFileAttributesW(reinterpret_cast<WCHAR const *>(path16.data));
+	arena_scratch_end(scratch);
+	return attributes != INVALID_FILE_ATTRIBUTES && (attributes & FILE_ATTRIBUTE_DIRECTORY) != 0;
+}
+
+auto dk::os_directory_create(String8 path) noexcept -> b8 {
+	ScratchArena const scratch = arena_scratch_begin(tc_get_scratch(nullptr, 0));
+	String16 const path16 = str16_from_8(scratch.arena, path);
+	b8 const created = CreateDirectoryW(reinterpret_cast<WCHAR const *>(path16.data), nullptr) != 0;
+	// NOTE(Dedrick): Read before arena_scratch_end, which may decommit and overwrite the last error.
+	DWORD const error = created ? ERROR_SUCCESS : GetLastError();
+	arena_scratch_end(scratch);
+	if (created) {
+		return true;
+	}
+	// NOTE(Dedrick): ERROR_ALREADY_EXISTS is also reported for a regular file at `path`.
+	return error == ERROR_ALREADY_EXISTS && os_path_is_directory(path);
+}
+
+auto dk::os_directory_list_files(Arena *arena, String8 directory) noexcept -> String8List {
+	Arena *conflicts[] = { arena };
+	ScratchArena const scratch = arena_scratch_begin(tc_get_scratch(conflicts, 1));
+	String8 const pattern = str8f(scratch.arena, "%.*s\\*", static_cast<int>(directory.size), directory.data);
+	String16 const pattern16 = str16_from_8(scratch.arena, pattern);
+
+	String8List files = {};
+	WIN32_FIND_DATAW find_data = {};
+	HANDLE const find = FindFirstFileExW(
+		reinterpret_cast<WCHAR const *>(pattern16.data),
+		FindExInfoBasic,
+		&find_data,
+		FindExSearchNameMatch,
+		nullptr,
+		FIND_FIRST_EX_LARGE_FETCH
+	);
+	if (find != INVALID_HANDLE_VALUE) {
+		do {
+			if ((find_data.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY) == 0) {
+				String16 const name16 = {
+					.data = reinterpret_cast<u16 const *>(find_data.cFileName),
+					.size = wcslen(find_data.cFileName)
+				};
+				str8_list_push(arena, &files, str8_from_16(arena, name16));
+			}
+		} while (FindNextFileW(find, &find_data));
+		FindClose(find);
+	}
+	arena_scratch_end(scratch);
+	return files;
+}
+
+auto dk::os_thread_launch(OS_ThreadFunction func, void *params) noexcept -> OS_Handle {
+	// NOTE(Dedrick): Freed by the new thread once it has copied it.
+	auto *start = static_cast<OS_Win32_ThreadStart *>(HeapAlloc(GetProcessHeap(), 0, sizeof(OS_Win32_ThreadStart)));
+	if (start == nullptr) {
+		return os_handle_invalid();
+	}
+	start->func = func;
+	start->params = params;
+
+	HANDLE const thread = CreateThread(nullptr, 0, os_win32_thread_entry, start, 0, nullptr);
+	if (thread == nullptr) {
+		HeapFree(GetProcessHeap(), 0, start);
+		return os_handle_invalid();
+	}
+	return { reinterpret_cast<u64>(thread) };
+}
+
+auto dk::os_thread_join(OS_Handle thread) noexcept -> void {
+	if (thread == os_handle_invalid()) {
+		return;
+	}
+	HANDLE const handle = reinterpret_cast<HANDLE>(thread.v);
+	WaitForSingleObject(handle, INFINITE);
+	CloseHandle(handle);
+}
+
+auto dk::os_barrier_alloc(u32 count) noexcept -> OS_Handle {
+	auto *barrier = static_cast<SYNCHRONIZATION_BARRIER *>(HeapAlloc(GetProcessHeap(), 0, sizeof(SYNCHRONIZATION_BARRIER)));
+	if (barrier == nullptr) {
+		return os_handle_invalid();
+	}
+	if (!InitializeSynchronizationBarrier(barrier, static_cast<LONG>(count), -1)) {
+		HeapFree(GetProcessHeap(), 0, barrier);
+		return os_handle_invalid();
+	}
+	return { reinterpret_cast<u64>(barrier) };
+}
+
+auto dk::os_barrier_release(OS_Handle barrier) noexcept -> void {
+	if (barrier == os_handle_invalid()) {
+		return;
+	}
+	auto *handle = reinterpret_cast<SYNCHRONIZATION_BARRIER *>(barrier.v);
+	DeleteSynchronizationBarrier(handle);
+	HeapFree(GetProcessHeap(), 0, handle);
+}
+
+auto dk::os_barrier_wait(OS_Handle barrier) noexcept -> void {
+	EnterSynchronizationBarrier(reinterpret_cast<SYNCHRONIZATION_BARRIER *>(barrier.v), 0);
+}
+
+auto dk::os_mutex_alloc() noexcept -> OS_Handle {
+	auto *lock = static_cast<SRWLOCK *>(HeapAlloc(GetProcessHeap(), 0, sizeof(SRWLOCK)));
+	if (lock == nullptr) {
+		return os_handle_invalid();
+	}
+	InitializeSRWLock(lock);
+	return { reinterpret_cast<u64>(lock) };
+}
+
+auto dk::os_mutex_release(OS_Handle mutex) noexcept -> void {
+	if (mutex == os_handle_invalid()) {
+		return;
+	}
+	HeapFree(GetProcessHeap(), 0, reinterpret_cast<SRWLOCK *>(mutex.v));
+}
+
+auto dk::os_mutex_lock(OS_Handle mutex) noexcept -> void {
+	AcquireSRWLockExclusive(reinterpret_cast<SRWLOCK *>(mutex.v));
+}
+
+auto dk::os_mutex_unlock(OS_Handle mutex) noexcept -> void {
+	ReleaseSRWLockExclusive(reinterpret_cast<SRWLOCK *>(mutex.v));
+}
+
+auto dk::os_cond_var_alloc() noexcept -> OS_Handle {
+	auto *cond_var = static_cast<CONDITION_VARIABLE *>(HeapAlloc(GetProcessHeap(), 0, sizeof(CONDITION_VARIABLE)));
+	if (cond_var == nullptr) {
+		return os_handle_invalid();
+	}
+	InitializeConditionVariable(cond_var);
+	return { reinterpret_cast<u64>(cond_var) };
+}
+
+auto dk::os_cond_var_release(OS_Handle cond_var) noexcept -> void {
+	if (cond_var == os_handle_invalid()) {
+		return;
+	}
+	HeapFree(GetProcessHeap(), 0, reinterpret_cast<CONDITION_VARIABLE *>(cond_var.v));
+}
+
+auto dk::os_cond_var_wait(OS_Handle cond_var, OS_Handle mutex) noexcept -> void {
+	SleepConditionVariableSRW(
+		reinterpret_cast<CONDITION_VARIABLE *>(cond_var.v),
+		reinterpret_cast<SRWLOCK *>(mutex.v),
+		INFINITE,
+		0
+	);
+}
+
+auto dk::os_cond_var_signal(OS_Handle cond_var) noexcept -> void {
+	WakeConditionVariable(reinterpret_cast<CONDITION_VARIABLE *>(cond_var.v));
+}
+
+auto dk::os_cond_var_broadcast(OS_Handle cond_var) noexcept -> void {
+	WakeAllConditionVariable(reinterpret_cast<CONDITION_VARIABLE *>(cond_var.v));
+}
+
 auto dk::os_now_seconds() noexcept -> f64 {
 	LARGE_INTEGER current_time = {};
 	QueryPerformanceCounter(&current_time);
@@ -194,3 +440,23 @@ auto dk::os_now_microseconds() noexcept -> u64 {
 	u64 const time_us = (current_time.QuadPart * 1000000) / os_win32_context.perf_frequency;
 	return time_us;
 }
+
+auto dk::os_win32_enable_large_pages() noexcept -> b8 {
+	HANDLE token = nullptr;
+	if (!OpenProcessToken(GetCurrentProcess(), TOKEN_ADJUST_PRIVILEGES | TOKEN_QUERY, &token)) {
+		return false;
+	}
+
+	TOKEN_PRIVILEGES privileges = {};
+	privileges.PrivilegeCount = 1;
+	privileges.Privileges[0].Attributes = SE_PRIVILEGE_ENABLED;
+	b8 enabled = false;
+	if (LookupPrivilegeValueW(nullptr, SE_LOCK_MEMORY_NAME, &privileges.Privileges[0].Luid)) {
+		// NOTE(Dedrick): Succeeds without granting anything when the account lacks the privilege,
+		// only GetLastError tells the two apart.
+		AdjustTokenPrivileges(token, FALSE, &privileges, 0, nullptr, nullptr);
+		enabled = GetLastError() == ERROR_SUCCESS;
+	}
+	CloseHandle(token);
+	return enabled;
+}
@@ -8,4 +8,7 @@ namespace dk {
 		u64 perf_frequency;
 	};
 	extern OS_Win32_Context os_win32_context;
+
+	/// Enables SeLockMemoryPrivilege, which the account must have been granted for large pages.
+	auto os_win32_enable_large_pages() noexcept -> b8;
 }
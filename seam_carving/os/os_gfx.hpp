@@ -91,7 +91,8 @@ namespace dk {
 	enum : u8 {
 		OS_WINDWOW_FLAG_NONE = 0,
 		OS_WINDOW_FLAG_NO_RESIZE = 1u << 0,
-		OS_WINDOW_FLAG_CENTER = 1u << 1
+		OS_WINDOW_FLAG_CENTER = 1u << 1,
+		OS_WINDOW_FLAG_HIDDEN = 1u << 2 ///< Context only, e.g. for command line processing.
 	};
 
 	enum class OS_DialogIcon : u8 {
@@ -127,6 +128,9 @@ namespace dk {
 	
 	auto os_window_present(OS_Handle window) noexcept -> void;
 
+	/// Address of a GL function of the current context, nullptr when the driver does not have it.
+	auto os_gl_proc_address(char const *name) noexcept -> void *;
+
 
 	auto os_show_dialog(OS_Handle parent, OS_DialogIcon icon, String8 title, String8 message) noexcept -> void;
 
@@ -193,10 +193,12 @@ auto dk::os_gfx_init() noexcept -> void {
 		.commit_size = ARENA_DEFAULT_COMMIT_SIZE
 	};
 	Arena *const arena = arena_alloc(&params);
+	arena_set_name(arena, "gfx");
 	
 	os_win32_gfx_context = arena_push_type<OS_Win32_GfxContext>(arena);
 	os_win32_gfx_context->arena = arena;
 	os_win32_gfx_context->pending_events_arena = arena_alloc(&params);
+	arena_set_name(os_win32_gfx_context->pending_events_arena, "gfx_pending_events");
 	os_win32_gfx_context->pending_events_list = {};
 	
 	os_win32_gfx_context->active_events_arena = os_win32_gfx_context->pending_events_arena;
@@ -402,7 +404,9 @@ auto dk::os_window_open(String8 title, s32 x, s32 y, s32 w, s32 h, OS_WindowFlag
 	}
 	
 	glfwSetWindowPos(window, x, y);
-	glfwShowWindow(window);
+	if ((flags & OS_WINDOW_FLAG_HIDDEN) == 0) {
+		glfwShowWindow(window);
+	}
 	glfwMakeContextCurrent(window);
 
 	OS_Win32_Window *win32_window = arena_push_type<OS_Win32_Window>(os_win32_gfx_context->arena);
@@ -471,6 +475,10 @@ auto dk::os_window_present(OS_Handle window) noexcept -> void {
 	glfwSwapBuffers(win32_window->glfw_window);
 }
 
+auto dk::os_gl_proc_address(char const *name) noexcept -> void * {
+	return reinterpret_cast<void *>(glfwGetProcAddress(name));
+}
+
 auto dk::os_show_dialog(OS_Handle parent, OS_DialogIcon icon, String8 title, String8 message) noexcept -> void {
 	UINT style = MB_OK;
 	if (icon == OS_DialogIcon::ICON_INFO) { style |= MB_ICONINFORMATION; }
@@ -23,8 +23,47 @@ void main() {
 	Out.texcoord_0 = (pos[gl_VertexID] + vec2(1.0f)) * 0.5f;
 }
 )");
+}
+
+namespace {
+	using namespace dk;
 
-	String8 const fs_display = str8_literal(R"(
+	String8 const glsl_index_map = str8_literal(R"(
+layout (std140, binding = 2) uniform IndexMapParams {
+	int u_removed_count;
+	int u_removed_is_horizontal;
+};
+
+layout (std430, binding = 4) readonly buffer IndexMapData {
+	int u_removed[]; // u_removed_count sorted source indices for each row/col
+};
+
+// Kept entries in front of removed entry i is (u_removed[i] - i), see the compaction pass.
+int source_index(int line, int index) {
+	const int base = line * u_removed_count;
+	int lo = 0;
+	int hi = u_removed_count;
+	while (lo < hi) {
+		const int mid = (lo + hi) / 2;
+		if (u_removed[base + mid] - mid <= index) {
+			lo = mid + 1;
+		} else {
+			hi = mid;
+		}
+	}
+	return index + lo;
+}
+
+ivec2 source_coord(ivec2 coord) {
+	if (bool(u_removed_is_horizontal)) {
+		return ivec2(coord.x, source_index(coord.x, coord.y));
+	}
+	return ivec2(source_index(coord.y, coord.x), coord.y);
+}
+)");
+
+	// NOTE(Dedrick): The display shader reads through the index map as well, glsl_index_map goes in between.
+	String8 const fs_display_head = str8_literal(R"(
 #version 460 core
 layout (location = 0) out vec4 out_color;
 
@@ -42,12 +81,15 @@ layout (std140, binding = 0) uniform DisplayParams {
 	int u_debug_view_mode;
 	int u_show_seam;
 	int u_is_horizontal;
+	int u_seam_count;
 };
 
 layout (std430, binding = 0) buffer SeamData {
 	int u_seam_coords[];
 };
+)");
 
+	String8 const fs_display_body = str8_literal(R"(
 float linear2srgb(float c) {
 	return (c <= 0.0031308f) ? (c * 12.92f) : (1.055f * pow(c, 1.0f/2.4f) - 0.055f);
 }
@@ -85,6 +127,11 @@ void main() {
 	if (u_debug_view_mode == 1 /* Energy */) {
 		const float energy = texture(u_energy_map, final_uv).r;
 		display_color = vec3(clamp(energy * 0.2f, 0.0f, 1.0f));
+	} else if (u_removed_count > 0) {
+		// Pixels have not been moved yet, fetch through the index map.
+		const ivec2 coord = min(texel_coord, u_image_size - 1);
+		const vec3 linear_color = texelFetch(u_image, source_coord(coord), 0).rgb;
+		display_color = linear2srgb(linear_color);
 	} else /* None*/ {
 		const vec3 linear_color = texture(u_image, final_uv).rgb;
 		display_color = linear2srgb(linear_color);
@@ -94,16 +141,20 @@ void main() {
 		bool is_seam = false;
 		if (bool(u_is_horizontal)) {
 			if (texel_coord.x < u_image_size.x) {
-				const int seam_y = u_seam_coords[texel_coord.x];
-				if (texel_coord.y == seam_y) {
-					is_seam = true;
+				for (int i = 0; i < u_seam_count; ++i) {
+					const int seam_y = u_seam_coords[texel_coord.x * u_seam_count + i];
+					if (texel_coord.y == seam_y) {
+						is_seam = true;
+					}
 				}
 			}
 		} else {
 			if (texel_coord.y < u_image_size.y) {
-				const int seam_x = u_seam_coords[texel_coord.y];
-				if (texel_coord.x == seam_x) {
-					is_seam = true;
+				for (int i = 0; i < u_seam_count; ++i) {
+					const int seam_x = u_seam_coords[texel_coord.y * u_seam_count + i];
+					if (texel_coord.x == seam_x) {
+						is_seam = true;
+					}
 				}
 			}
 		}
@@ -115,11 +166,78 @@ void main() {
 
 	out_color = vec4(display_color, 1.0f);
 }
+)");
+
+	// NOTE(Dedrick): Compute stages have no #version line, sc_shader_variant_source puts it in front of
+	// the #defines of the variant. Seam stages get glsl_axis and index map stages glsl_index_map as well.
+	// Energy stages get glsl_energy after their own declarations, so energy_sobel has one definition for all.
+
+	String8 const glsl_axis = str8_literal(R"(
+// Seams have one position per line. Lines are rows for vertical seams (AXIS 0)
+// and cols for horizontal seams (AXIS 1), positions run across a line.
+#if AXIS == 0
+#define SEAM_LINE(v) ((v).y)
+#define SEAM_POS(v) ((v).x)
+#define SEAM_COORD(pos, line) ivec2((pos), (line))
+#else
+#define SEAM_LINE(v) ((v).x)
+#define SEAM_POS(v) ((v).y)
+#define SEAM_COORD(pos, line) ivec2((line), (pos))
+#endif
+)");
+
+	String8 const glsl_energy_decl = str8_literal(R"(
+float energy_sobel(ivec2 coord);
+)");
+
+	String8 const glsl_energy = str8_literal(R"(
+float luminance(vec3 c) {
+	return dot(c, vec3(0.2126f, 0.7152f, 0.0722f));
+}
+
+// Luminance of the pixel at coord + offset. Index map stages take neighbours in the
+// carved image and skip removed pixels, the others sample u_image at u_texture_size.
+float energy_luminance(ivec2 coord, ivec2 offset) {
+#if INDEX_MAP
+	const ivec2 neighbour = clamp(coord + offset, ivec2(0), u_current_size - 1);
+	return luminance(texelFetch(u_image, source_coord(neighbour), 0).rgb);
+#else
+	const vec2 uv = (vec2(coord) + 0.5f) / vec2(u_texture_size);
+	const vec2 texel_size = 1.0f / vec2(u_texture_size);
+	return luminance(texture(u_image, uv + texel_size * vec2(offset)).rgb);
+#endif
+}
+
+float energy_sobel(ivec2 coord) {
+	const float kernel_x[9] = float[9](
+		-1.0f, 0.0f, 1.0f,
+		-2.0f, 0.0f, 2.0f,
+		-1.0f, 0.0f, 1.0f
+	);
+	const float kernel_y[9] = float[9](
+		-1.0f, -2.0f, -1.0f,
+		 0.0f,  0.0f,  0.0f,
+		 1.0f,  2.0f,  1.0f
+	);
+
+	float gx = 0.0f;
+	float gy = 0.0f;
+
+	for (int y_offset = -1; y_offset <= 1; ++y_offset) {
+		for (int x_offset = -1; x_offset <= 1; ++x_offset) {
+			const int i = (y_offset + 1) * 3 + (x_offset + 1);
+			const float lum = energy_luminance(coord, ivec2(x_offset, y_offset));
+			gx += kernel_x[i] * lum;
+			gy += kernel_y[i] * lum;
+		}
+	}
+
+	return abs(gx) + abs(gy);
+}
 )");
 
 	String8 const cs_srgb_to_linear = str8_literal(R"(
-#version 460 core
-layout (local_size_x = 8, local_size_y = 8, local_size_z = 1) in;
+layout (local_size_x = TILE_WIDTH, local_size_y = TILE_HEIGHT, local_size_z = 1) in;
 
 layout (binding = 0) uniform sampler2D u_image_srgb;
 layout (rgba8, binding = 0) uniform image2D u_image_linear;
@@ -139,11 +257,47 @@ void main() {
 	const vec4 linear_color = texelFetch(u_image_srgb, coord, 0); 
 	imageStore(u_image_linear, coord, linear_color);
 }
+)");
+
+	String8 const cs_linear_to_srgb = str8_literal(R"(
+layout (local_size_x = TILE_WIDTH, local_size_y = TILE_HEIGHT, local_size_z = 1) in;
+
+layout (rgba8, binding = 0) readonly uniform image2D u_image_linear;
+
+layout (std430, binding = 0) readonly buffer SrgbTable {
+	uint u_srgb_table[256]; // 8-bit linear to 8-bit sRGB, the table the CPU conversion uses
+};
+layout (std430, binding = 1) writeonly buffer Pixels {
+	uint u_pixels[]; // Packed RGBA8, top row first
+};
+
+layout (std140, binding = 0) uniform CarveParams {
+	ivec2 u_current_size;
+	ivec2 u_texture_size;
+	int u_current_iteration;
+};
+
+void main() {
+	const ivec2 coord = ivec2(gl_GlobalInvocationID.xy);
+	if (coord.x >= u_current_size.x || coord.y >= u_current_size.y) {
+		return;
+	}
+
+	// Same rounding as the readback to bytes, so the table lookup matches the CPU exactly.
+	const uvec4 linear_color = uvec4(round(imageLoad(u_image_linear, coord) * 255.0f));
+	const uint srgb_color =
+		u_srgb_table[linear_color.r] |
+		(u_srgb_table[linear_color.g] << 8) |
+		(u_srgb_table[linear_color.b] << 16) |
+		(linear_color.a << 24);
+
+	// Texture rows start at the bottom, image files at the top.
+	u_pixels[(u_current_size.y - 1 - coord.y) * u_current_size.x + coord.x] = srgb_color;
+}
 )");
 
 	String8 const cs_sobel = str8_literal(R"(
-#version 460 core
-layout (local_size_x = 8, local_size_y = 8, local_size_z = 1) in;
+layout (local_size_x = TILE_WIDTH, local_size_y = TILE_HEIGHT, local_size_z = 1) in;
 
 layout (binding = 0) uniform sampler2D u_image;
 layout (r32f, binding = 0) uniform image2D u_energy_map;
@@ -154,9 +308,29 @@ layout (std140, binding = 0) uniform CarveParams {
 	int u_current_iteration;
 };
 
-float luminance(vec3 c) {
-	return dot(c, vec3(0.2126f, 0.7152f, 0.0722f));
+void main() {
+	const ivec2 coord = ivec2(gl_GlobalInvocationID.xy);
+	if (coord.x >= u_current_size.x || coord.y >= u_current_size.y) {
+		return;
+	}
+
+	const float energy = energy_sobel(coord);
+	imageStore(u_energy_map, coord, vec4(energy));
 }
+)");
+
+	String8 const cs_sobel_index_map = str8_literal(R"(
+layout (local_size_x = TILE_WIDTH, local_size_y = TILE_HEIGHT, local_size_z = 1) in;
+
+layout (binding = 0) uniform sampler2D u_image;
+layout (r32f, binding = 0) uniform image2D u_energy_map;
+
+layout (std140, binding = 0) uniform CarveParams {
+	ivec2 u_current_size;
+	ivec2 u_texture_size;
+	int u_current_iteration;
+	int u_seam_count;
+};
 
 void main() {
 	const ivec2 coord = ivec2(gl_GlobalInvocationID.xy);
@@ -164,40 +338,85 @@ void main() {
 		return;
 	}
 
-	const vec2 uv = (vec2(coord) + 0.5f) / vec2(u_texture_size); 
-	const vec2 texel_size = 1.0f / vec2(u_texture_size);
+	const float energy = energy_sobel(coord);
+	imageStore(u_energy_map, coord, vec4(energy));
+}
+)");
+	String8 const cs_index_map_insert = str8_literal(R"(
+layout (local_size_x = 64, local_size_y = 1, local_size_z = 1) in;
 
-	const float kernel_x[9] = float[9](
-		-1.0f, 0.0f, 1.0f,
-		-2.0f, 0.0f, 2.0f,
-		-1.0f, 0.0f, 1.0f
-	);
-	const float kernel_y[9] = float[9](
-		-1.0f, -2.0f, -1.0f,
-		 0.0f,  0.0f,  0.0f,
-		 1.0f,  2.0f,  1.0f
-	);
+layout (std430, binding = 1) writeonly buffer IndexMapOutData {
+	int u_removed_out[]; // (u_removed_count + u_seam_count) per row/col
+};
+layout (std430, binding = 2) readonly buffer SeamData {
+	int u_seam_coords[]; // u_seam_count sorted coords in the carved image per row/col
+};
 
-	float gx = 0.0f;
-	float gy = 0.0f;
+layout (std140, binding = 0) uniform CarveParams {
+	ivec2 u_current_size;
+	ivec2 u_texture_size;
+	int u_current_iteration;
+	int u_seam_count;
+};
 
-	for (int y_offset = -1; y_offset <= 1; ++y_offset) {
-		for (int x_offset = -1; x_offset <= 1; ++x_offset) {
-			const int i = (y_offset + 1) * 3 + (x_offset + 1);
-			const float lum = luminance(texture(u_image, uv + texel_size * vec2(x_offset, y_offset)).rgb);
-			gx += kernel_x[i] * lum;
-			gy += kernel_y[i] * lum;
+void main() {
+	const int line = int(gl_GlobalInvocationID.x);
+	const int line_count = bool(u_removed_is_horizontal) ? u_current_size.x : u_current_size.y;
+	if (line >= line_count) {
+		return;
+	}
+
+	// The seams are sorted and the map is monotonic, so their source indices are
+	// sorted as well and can be merged into the removed list in one sweep.
+	const int in_base = line * u_removed_count;
+	const int out_base = line * (u_removed_count + u_seam_count);
+	int i = 0;
+	for (int s = 0; s < u_seam_count; ++s) {
+		const int removed = source_index(line, u_seam_coords[line * u_seam_count + s]);
+		while (i < u_removed_count && u_removed[in_base + i] < removed) {
+			u_removed_out[out_base + i + s] = u_removed[in_base + i];
+			++i;
 		}
+		u_removed_out[out_base + i + s] = removed;
 	}
+	for (; i < u_removed_count; ++i) {
+		u_removed_out[out_base + i + u_seam_count] = u_removed[in_base + i];
+	}
+}
+)");
 
-	const float energy = abs(gx) + abs(gy);
-	imageStore(u_energy_map, coord, vec4(energy));
+	String8 const cs_downsample = str8_literal(R"(
+layout (local_size_x = TILE_WIDTH, local_size_y = TILE_HEIGHT, local_size_z = 1) in;
+
+layout (binding = 0) uniform sampler2D u_image_in;
+layout (rgba8, binding = 0) uniform image2D u_image_out;
+
+layout (std140, binding = 1) uniform ResampleParams {
+	ivec2 u_src_size;
+	ivec2 u_dst_size;
+	int u_scale;
+};
+
+void main() {
+	const ivec2 coord = ivec2(gl_GlobalInvocationID.xy);
+	if (coord.x >= u_dst_size.x || coord.y >= u_dst_size.y) {
+		return;
+	}
+
+	vec4 sum = vec4(0.0f);
+	for (int y_offset = 0; y_offset < u_scale; ++y_offset) {
+		for (int x_offset = 0; x_offset < u_scale; ++x_offset) {
+			const ivec2 src_coord = min(coord * u_scale + ivec2(x_offset, y_offset), u_src_size - 1);
+			sum += texelFetch(u_image_in, src_coord, 0);
+		}
+	}
+
+	imageStore(u_image_out, coord, sum / float(u_scale * u_scale));
 }
 )");
 
-	String8 const cs_v_cost_row = str8_literal(R"(
-#version 460 core
-layout (local_size_x = 256, local_size_y = 1, local_size_z = 1) in;
+	String8 const cs_cost = str8_literal(R"(
+layout (local_size_x = WORKGROUP_SIZE, local_size_y = 1, local_size_z = 1) in;
 
 layout (binding = 1) uniform sampler2D u_energy_map;
 
@@ -211,33 +430,35 @@ layout (std140, binding = 0) uniform CarveParams {
 	int u_current_iteration;
 };
 
+int cost_index(ivec2 coord) {
+	return coord.y * u_current_size.x + coord.x;
+}
+
 void main() {
-	const int x = int(gl_GlobalInvocationID.x);
-	if (x >= u_current_size.x) {
+	const int pos = int(gl_GlobalInvocationID.x);
+	const int pos_count = SEAM_POS(u_current_size);
+	if (pos >= pos_count) {
 		return;
 	}
 
-	const int y = u_current_iteration;
-	const int width = u_current_size.x;
-	const int idx = y * width + x;
-	const vec2 uv = (vec2(x, y) + 0.5f) / vec2(u_texture_size);
+	const int line = u_current_iteration;
+	const ivec2 coord = SEAM_COORD(pos, line);
+	const vec2 uv = (vec2(coord) + 0.5f) / vec2(u_texture_size);
 	const float energy = texture(u_energy_map, uv).r;
 
-	if (y == 0) {
-		u_cost_map[idx] = energy;
+	if (line == 0) {
+		u_cost_map[cost_index(coord)] = energy;
 	} else {
-		const int prev_row_idx = (y - 1) * width;
-		const float C1 = u_cost_map[prev_row_idx + max(x - 1, 0)];
-		const float C2 = u_cost_map[prev_row_idx + x];
-		const float C3 = u_cost_map[prev_row_idx + min(x + 1, width - 1)];
-		u_cost_map[idx] = energy + min(C1, min(C2, C3));
+		const float C1 = u_cost_map[cost_index(SEAM_COORD(max(pos - 1, 0), line - 1))];
+		const float C2 = u_cost_map[cost_index(SEAM_COORD(pos, line - 1))];
+		const float C3 = u_cost_map[cost_index(SEAM_COORD(min(pos + 1, pos_count - 1), line - 1))];
+		u_cost_map[cost_index(coord)] = energy + min(C1, min(C2, C3));
 	}
 }
 )");
 
-	String8 const cs_v_find_min_local = str8_literal(R"(
-#version 460 core
-layout (local_size_x = 256, local_size_y = 1, local_size_z = 1) in;
+	String8 const cs_find_min_local = str8_literal(R"(
+layout (local_size_x = WORKGROUP_SIZE, local_size_y = 1, local_size_z = 1) in;
 
 layout (std430, binding = 0) buffer CostData {
 	float u_cost_map[];
@@ -252,41 +473,39 @@ layout (std140, binding = 0) uniform CarveParams {
 	int u_current_iteration;
 };
 
-shared uvec2 s_min_data[256]; // (cost_as_uint, index)
+shared uvec2 s_min_data[WORKGROUP_SIZE]; // (cost_as_uint, index)
 
 void main() {
-	const int x = int(gl_GlobalInvocationID.x);
-	const int local_x = int(gl_LocalInvocationID.x);
-	const int group_x = int(gl_WorkGroupID.x);
-	const int width = u_current_size.x;
+	const int pos = int(gl_GlobalInvocationID.x);
+	const int local_i = int(gl_LocalInvocationID.x);
+	const int group_i = int(gl_WorkGroupID.x);
 
 	float cost = 1e30f; // infinity
-	if (x < width) {
-		const int last_row_idx = (u_current_size.y - 1) * width;
-		cost = u_cost_map[last_row_idx + x];
+	if (pos < SEAM_POS(u_current_size)) {
+		const ivec2 coord = SEAM_COORD(pos, SEAM_LINE(u_current_size) - 1);
+		cost = u_cost_map[coord.y * u_current_size.x + coord.x];
 	}
 
-	s_min_data[local_x] = uvec2(floatBitsToUint(cost), x);
+	s_min_data[local_i] = uvec2(floatBitsToUint(cost), pos);
 	barrier();
 
-	for (int s = 128; s > 0; s >>= 1) {
-		if (local_x < s) {
-			if (s_min_data[local_x + s].x < s_min_data[local_x].x) {
-				s_min_data[local_x] = s_min_data[local_x + s];
+	for (int s = WORKGROUP_SIZE / 2; s > 0; s >>= 1) {
+		if (local_i < s) {
+			if (s_min_data[local_i + s].x < s_min_data[local_i].x) {
+				s_min_data[local_i] = s_min_data[local_i + s];
 			}
 		}
 		barrier();
 	}
 
-	if (local_x == 0) {
-		u_min_indices[group_x] = s_min_data[0];
+	if (local_i == 0) {
+		u_min_indices[group_i] = s_min_data[0];
 	}
 }
 )");
 
-	String8 const cs_v_find_min_global = str8_literal(R"(
-#version 460 core
-layout (local_size_x = 256, local_size_y = 1, local_size_z = 1) in;
+	String8 const cs_find_min_global = str8_literal(R"(
+layout (local_size_x = WORKGROUP_SIZE, local_size_y = 1, local_size_z = 1) in;
 
 layout (std430, binding = 2) buffer MinIndexData {
 	uvec2 u_min_indices[]; // (cost_as_uint, index)
@@ -298,43 +517,45 @@ layout (std140, binding = 0) uniform CarveParams {
 	int u_current_iteration;
 };
 
-shared uvec2 s_min_data[256];
+shared uvec2 s_min_data[WORKGROUP_SIZE];
 
 void main() {
-	const int local_x = int(gl_LocalInvocationID.x);
-	const int group_count = int(ceil(float(u_current_size.x) / 256.0f));
+	const int local_i = int(gl_LocalInvocationID.x);
+	const int group_count = (SEAM_POS(u_current_size) + WORKGROUP_SIZE - 1) / WORKGROUP_SIZE;
 
+	// Small workgroups can leave more local minima than invocations, each takes every WORKGROUP_SIZE-th.
 	uvec2 min_val = uvec2(0xFFFFFFFF, 0);
-	if (local_x < group_count) {
-		min_val = u_min_indices[local_x];
+	for (int i = local_i; i < group_count; i += WORKGROUP_SIZE) {
+		if (u_min_indices[i].x < min_val.x) {
+			min_val = u_min_indices[i];
+		}
 	}
-	s_min_data[local_x] = min_val;
+	s_min_data[local_i] = min_val;
 	barrier();
 
-	for (int s = 128; s > 0; s >>= 1) {
-		if (local_x < s) {
-			if (s_min_data[local_x + s].x < s_min_data[local_x].x) {
-				s_min_data[local_x] = s_min_data[local_x + s];
+	for (int s = WORKGROUP_SIZE / 2; s > 0; s >>= 1) {
+		if (local_i < s) {
+			if (s_min_data[local_i + s].x < s_min_data[local_i].x) {
+				s_min_data[local_i] = s_min_data[local_i + s];
 			}
 		}
 		barrier();
 	}
 
-	if (local_x == 0) {
+	if (local_i == 0) {
 		u_min_indices[0] = s_min_data[0];
 	}
 }
 )");
 
-	String8 const cs_v_backtrace = str8_literal(R"(
-#version 460 core
+	String8 const cs_backtrace = str8_literal(R"(
 layout (local_size_x = 1, local_size_y = 1, local_size_z = 1) in;
 
 layout (std430, binding = 0) buffer CostData {
 	float u_cost_map[];
 };
 layout (std430, binding = 1) buffer SeamData {
-	int u_seam_coords[]; // x-coord for each row y
+	int u_seam_coords[]; // position for each line
 };
 layout (std430, binding = 2) buffer MinIndexData {
 	uvec2 u_min_indices[]; // (cost_as_uint, index)
@@ -346,47 +567,51 @@ layout (std140, binding = 0) uniform CarveParams {
 	int u_current_iteration;
 };
 
+float cost_at(int pos, int line) {
+	const ivec2 coord = SEAM_COORD(pos, line);
+	return u_cost_map[coord.y * u_current_size.x + coord.x];
+}
+
 void main() {
-	const int y = u_current_iteration;
-	const int width = u_current_size.x;
+	const int line = u_current_iteration;
+	const int pos_count = SEAM_POS(u_current_size);
 
-	if (y == u_current_size.y - 1) {
-		u_seam_coords[y] = int(u_min_indices[0].y);
+	if (line == SEAM_LINE(u_current_size) - 1) {
+		u_seam_coords[line] = int(u_min_indices[0].y);
 	} else {
-		const int child_x = u_seam_coords[y + 1];
+		const int child_pos = u_seam_coords[line + 1];
 
-		int min_x = child_x;
-		float min_cost = u_cost_map[y * width + min_x];
+		int min_pos = child_pos;
+		float min_cost = cost_at(min_pos, line);
 
-		if (child_x > 0) {
-			float left_cost = u_cost_map[y * width + (child_x - 1)];
-			if (left_cost < min_cost) {
-				min_cost = left_cost;
-				min_x = child_x - 1;
+		if (child_pos > 0) {
+			float before_cost = cost_at(child_pos - 1, line);
+			if (before_cost < min_cost) {
+				min_cost = before_cost;
+				min_pos = child_pos - 1;
 			}
 		}
 
-		if (child_x < width - 1) {
-			float right_cost = u_cost_map[y * width + (child_x + 1)];
-			if (right_cost < min_cost) {
-				min_x = child_x + 1;
+		if (child_pos < pos_count - 1) {
+			float after_cost = cost_at(child_pos + 1, line);
+			if (after_cost < min_cost) {
+				min_pos = child_pos + 1;
 			}
 		}
 
-		u_seam_coords[y] = min_x;
+		u_seam_coords[line] = min_pos;
 	}
 }
 )");
 
-	String8 const cs_v_remove_seam = str8_literal(R"(
-#version 460 core
-layout (local_size_x = 8, local_size_y = 8, local_size_z = 1) in;
+	String8 const cs_remove_seam = str8_literal(R"(
+layout (local_size_x = TILE_WIDTH, local_size_y = TILE_HEIGHT, local_size_z = 1) in;
 
 layout (rgba8, binding = 0) uniform image2D u_image_in;
 layout (rgba8, binding = 1) uniform image2D u_image_out;
 
 layout (std430, binding = 0) buffer SeamData {
-	int u_seam_coords[]; // x-coord for each row y
+	int u_seam_coords[]; // position for each line
 };
 
 layout (std140, binding = 0) uniform CarveParams {
@@ -397,240 +622,420 @@ layout (std140, binding = 0) uniform CarveParams {
 
 void main() {
 	const ivec2 coord = ivec2(gl_GlobalInvocationID.xy);
-	if (coord.x >= u_current_size.x - 1 || coord.y >= u_current_size.y) {
+	const int pos = SEAM_POS(coord);
+	const int line = SEAM_LINE(coord);
+	if (pos >= SEAM_POS(u_current_size) - 1 || line >= SEAM_LINE(u_current_size)) {
 		return;
 	}
 
-	const int seam_x = u_seam_coords[coord.y];
-
-	ivec2 read_coord = coord;
-	if (coord.x >= seam_x) {
-		read_coord.x += 1;
-	}
+	const int seam_pos = u_seam_coords[line];
+	const ivec2 read_coord = SEAM_COORD(pos >= seam_pos ? pos + 1 : pos, line);
 
 	const vec4 color = imageLoad(u_image_in, read_coord);
 	imageStore(u_image_out, coord, color);
 }
 )");
 
-	String8 const cs_h_cost_col = str8_literal(R"(
-#version 460 core
-layout (local_size_x = 256, local_size_y = 1, local_size_z = 1) in;
+	String8 const cs_band_seam = str8_literal(R"(
+layout (local_size_x = WORKGROUP_SIZE, local_size_y = 1, local_size_z = 1) in;
 
-layout (binding = 1) uniform sampler2D u_energy_map;
+layout (binding = 0) uniform sampler2D u_image;
 
-layout (std430, binding = 0) buffer CostData {
-	float u_cost_map[];
+layout (std430, binding = 0) coherent buffer CostData {
+	float u_cost_map[]; // band_width entries per line
 };
-
-layout (std140, binding = 0) uniform CarveParams {
-	ivec2 u_current_size;
-	ivec2 u_texture_size;
-	int u_current_iteration;
-};
-
-void main() {
-	const int y = int(gl_GlobalInvocationID.x);
-	if (y >= u_current_size.y) {
-		return;
-	}
-
-	const int x = u_current_iteration;
-	const int width = u_current_size.x;
-	const int height = u_current_size.y;
-	const int idx = y * width + x;
-	const vec2 uv = (vec2(x, y) + 0.5f) / vec2(u_texture_size);
-	const float energy = texture(u_energy_map, uv).r;
-
-	if (x == 0) {
-		u_cost_map[idx] = energy;
-	} else {
-		const int prev_col_idx = x - 1;
-		const float C1 = u_cost_map[max(y - 1, 0) * width + prev_col_idx];
-		const float C2 = u_cost_map[y * width + prev_col_idx];
-		const float C3 = u_cost_map[min(y + 1, height - 1) * width + prev_col_idx];
-		u_cost_map[idx] = energy + min(C1, min(C2, C3));
-	}
-}
-)");
-
-	String8 const cs_h_find_min_local = str8_literal(R"(
-#version 460 core
-layout (local_size_x = 256, local_size_y = 1, local_size_z = 1) in;
-
-layout (std430, binding = 0) buffer CostData {
-	float u_cost_map[];
+layout (std430, binding = 1) buffer SeamData {
+	int u_seam_coords[]; // position for each line
 };
 layout (std430, binding = 2) buffer MinIndexData {
 	uvec2 u_min_indices[]; // (cost_as_uint, index)
 };
+layout (std430, binding = 3) buffer GuideData {
+	int u_guide_coords[]; // position for each line of the guide level
+};
 
-layout (std140, binding = 0) uniform CarveParams {
-	ivec2 u_current_size;
+layout (std140, binding = 1) uniform BandParams {
+	ivec2 u_size;
 	ivec2 u_texture_size;
-	int u_current_iteration;
+	ivec2 u_guide_size;
+	int u_guide_scale;
+	int u_band_offset;
+	int u_band_width;
+	int u_interpolate_guide;
 };
 
-shared uvec2 s_min_data[256];
+shared uvec2 s_min_data[WORKGROUP_SIZE]; // (cost_as_uint, index)
+
+int band_width() {
+	return min(u_band_width, SEAM_POS(u_size));
+}
+
+// The guide seam is upsampled either by linearly interpolating
+// between guide lines (band moves at most one pixel per line) or by covering the
+// exact block of pixels the guide pixel was averaged from.
+int band_start(int line) {
+	const int guide_line = min(line / u_guide_scale, SEAM_LINE(u_guide_size) - 1);
+	int guide_pos = u_guide_coords[guide_line] * u_guide_scale;
+	if (bool(u_interpolate_guide)) {
+		const int next_pos = u_guide_coords[min(guide_line + 1, SEAM_LINE(u_guide_size) - 1)];
+		const int t = line - guide_line * u_guide_scale;
+		guide_pos = u_guide_coords[guide_line] * (u_guide_scale - t) + next_pos * t;
+	}
+	return clamp(guide_pos + u_band_offset, 0, SEAM_POS(u_size) - band_width());
+}
 
 void main() {
-	const int y = int(gl_GlobalInvocationID.x);
-	const int local_y = int(gl_LocalInvocationID.x);
-	const int group_y = int(gl_WorkGroupID.x);
-	const int width = u_current_size.x;
-	const int height = u_current_size.y;
+	const int t = int(gl_LocalInvocationID.x);
+	const int width = band_width();
+	const int line_count = SEAM_LINE(u_size);
+
+	// The band is narrow enough for a single workgroup, so the
+	// whole DP runs in one dispatch with a barrier per line instead of one dispatch per line.
+	for (int line = 0; line < line_count; ++line) {
+		if (t < width) {
+			const int start = band_start(line);
+			float cost = energy_sobel(SEAM_COORD(start + t, line));
+
+			if (line > 0) {
+				const int prev_start = band_start(line - 1);
+				const int pos = start + t;
+				const int lo = clamp(pos - 1, prev_start, prev_start + width - 1);
+				const int hi = clamp(pos + 1, prev_start, prev_start + width - 1);
+
+				float min_cost = 1e30f;
+				for (int prev_pos = lo; prev_pos <= hi; ++prev_pos) {
+					min_cost = min(min_cost, u_cost_map[(line - 1) * width + (prev_pos - prev_start)]);
+				}
+				cost += min_cost;
+			}
 
-	float cost = 1e30f;
-	if (y < height) {
-		const int last_col_idx = width - 1;
-		cost = u_cost_map[y * width + last_col_idx];
+			u_cost_map[line * width + t] = cost;
+		}
+		memoryBarrierBuffer();
+		barrier();
+	}
+
+	float cost = 1e30f; // infinity
+	if (t < width) {
+		cost = u_cost_map[(line_count - 1) * width + t];
 	}
 
-	s_min_data[local_y] = uvec2(floatBitsToUint(cost), y);
+	s_min_data[t] = uvec2(floatBitsToUint(cost), t);
 	barrier();
 
-	for (int s = 128; s > 0; s >>= 1) {
-		if (local_y < s) {
-			if (s_min_data[local_y + s].x < s_min_data[local_y].x) {
-				s_min_data[local_y] = s_min_data[local_y + s];
+	for (int s = WORKGROUP_SIZE / 2; s > 0; s >>= 1) {
+		if (t < s) {
+			if (s_min_data[t + s].x < s_min_data[t].x) {
+				s_min_data[t] = s_min_data[t + s];
 			}
 		}
 		barrier();
 	}
 
-	if (local_y == 0) {
-		u_min_indices[group_y] = s_min_data[0];
+	if (t == 0) {
+		int pos = band_start(line_count - 1) + int(s_min_data[0].y);
+		u_min_indices[0] = uvec2(s_min_data[0].x, pos);
+		u_seam_coords[line_count - 1] = pos;
+
+		for (int line = line_count - 2; line >= 0; --line) {
+			const int start = band_start(line);
+			const int lo = clamp(pos - 1, start, start + width - 1);
+			const int hi = clamp(pos + 1, start, start + width - 1);
+
+			int min_pos = clamp(pos, lo, hi);
+			float min_cost = u_cost_map[line * width + (min_pos - start)];
+			for (int candidate = lo; candidate <= hi; ++candidate) {
+				const float candidate_cost = u_cost_map[line * width + (candidate - start)];
+				if (candidate_cost < min_cost) {
+					min_cost = candidate_cost;
+					min_pos = candidate;
+				}
+			}
+
+			pos = min_pos;
+			u_seam_coords[line] = pos;
+		}
 	}
 }
 )");
 
-	String8 const cs_h_find_min_global = str8_literal(R"(
-#version 460 core
-layout (local_size_x = 256, local_size_y = 1, local_size_z = 1) in;
+	String8 const cs_find_min_k = str8_literal(R"(
+layout (local_size_x = WORKGROUP_SIZE, local_size_y = 1, local_size_z = 1) in;
 
+layout (std430, binding = 0) buffer CostData {
+	float u_cost_map[];
+};
 layout (std430, binding = 2) buffer MinIndexData {
-	uvec2 u_min_indices[]; // (cost_as_uint, index)
+	uvec2 u_min_indices[]; // (cost_as_uint, index), u_seam_count entries sorted by index
 };
 
 layout (std140, binding = 0) uniform CarveParams {
 	ivec2 u_current_size;
 	ivec2 u_texture_size;
 	int u_current_iteration;
+	int u_seam_count;
 };
 
-shared uvec2 s_min_data[256];
+shared uvec2 s_min_data[WORKGROUP_SIZE]; // (cost_as_uint, index)
+
+bool key_less(uvec2 a, uvec2 b) {
+	return a.x < b.x || (a.x == b.x && a.y < b.y);
+}
 
 void main() {
-	const int local_x = int(gl_LocalInvocationID.x);
-	const int group_count = int(ceil(float(u_current_size.y) / 256.0f));
+	const int local_i = int(gl_LocalInvocationID.x);
+	const int count = SEAM_POS(u_current_size);
+	const int last_line = SEAM_LINE(u_current_size) - 1;
+
+	// Each pass takes the smallest (cost, index) key above the one found by the
+	// previous pass, which yields the u_seam_count cheapest ends of the last line.
+	uvec2 prev_key = uvec2(0, 0);
+	for (int k = 0; k < u_seam_count; ++k) {
+		uvec2 best_key = uvec2(0xFFFFFFFF, 0xFFFFFFFF);
+		for (int i = local_i; i < count; i += WORKGROUP_SIZE) {
+			const ivec2 coord = SEAM_COORD(i, last_line);
+			const uvec2 key = uvec2(floatBitsToUint(u_cost_map[coord.y * u_current_size.x + coord.x]), i);
+			if ((k == 0 || key_less(prev_key, key)) && key_less(key, best_key)) {
+				best_key = key;
+			}
+		}
 
-	uvec2 min_val = uvec2(0xFFFFFFFF, 0);
-	if (local_x < group_count) {
-		min_val = u_min_indices[local_x];
-	}
-	s_min_data[local_x] = min_val;
-	barrier();
+		s_min_data[local_i] = best_key;
+		barrier();
 
-	for (int s = 128; s > 0; s >>= 1) {
-		if (local_x < s) {
-			if (s_min_data[local_x + s].x < s_min_data[local_x].x) {
-				s_min_data[local_x] = s_min_data[local_x + s];
+		for (int s = WORKGROUP_SIZE / 2; s > 0; s >>= 1) {
+			if (local_i < s) {
+				if (key_less(s_min_data[local_i + s], s_min_data[local_i])) {
+					s_min_data[local_i] = s_min_data[local_i + s];
+				}
 			}
+			barrier();
+		}
+
+		prev_key = s_min_data[0];
+		if (local_i == 0) {
+			u_min_indices[k] = prev_key;
 		}
 		barrier();
 	}
 
-	if (local_x == 0) {
-		u_min_indices[0] = s_min_data[0];
+	// Backtracing keeps seams ordered, so hand the ends over sorted by index.
+	if (local_i == 0) {
+		for (int i = 1; i < u_seam_count; ++i) {
+			const uvec2 key = u_min_indices[i];
+			int j = i - 1;
+			while (j >= 0 && u_min_indices[j].y > key.y) {
+				u_min_indices[j + 1] = u_min_indices[j];
+				--j;
+			}
+			u_min_indices[j + 1] = key;
+		}
 	}
 }
 )");
 
-	String8 const cs_h_backtrace = str8_literal(R"(
-#version 460 core
-layout (local_size_x = 1, local_size_y = 1, local_size_z = 1) in;
+	String8 const cs_backtrace_k = str8_literal(R"(
+layout (local_size_x = MAX_SEAMS, local_size_y = 1, local_size_z = 1) in;
 
 layout (std430, binding = 0) buffer CostData {
 	float u_cost_map[];
 };
 layout (std430, binding = 1) buffer SeamData {
-	int u_seam_coords[]; // y-coord for each col x
+	int u_seam_coords[]; // u_seam_count sorted positions for each line
 };
 layout (std430, binding = 2) buffer MinIndexData {
-	uvec2 u_min_indices[]; // (cost_as_uint, index)
+	uvec2 u_min_indices[]; // (cost_as_uint, index), sorted by index
 };
 
 layout (std140, binding = 0) uniform CarveParams {
 	ivec2 u_current_size;
 	ivec2 u_texture_size;
 	int u_current_iteration;
+	int u_seam_count;
 };
 
+shared int s_seam_pos[MAX_SEAMS];
+
+float cost_at(int pos, int line) {
+	const ivec2 coord = SEAM_COORD(pos, line);
+	return u_cost_map[coord.y * u_current_size.x + coord.x];
+}
+
 void main() {
-	const int x = u_current_iteration;
-	const int width = u_current_size.x;
-	const int height = u_current_size.y;
+	const int seam = int(gl_LocalInvocationID.x);
+	const int line = u_current_iteration;
+	const int pos_count = SEAM_POS(u_current_size);
 
-	if (x == width - 1) {
-		u_seam_coords[x] = int(u_min_indices[0].y);
-	} else {
-		const int child_y = u_seam_coords[x + 1];
+	if (seam < u_seam_count) {
+		if (line == SEAM_LINE(u_current_size) - 1) {
+			s_seam_pos[seam] = int(u_min_indices[seam].y);
+		} else {
+			const int child_pos = u_seam_coords[(line + 1) * u_seam_count + seam];
 
-		int min_y = child_y;
-		float min_cost = u_cost_map[min_y * width + x];
+			int min_pos = child_pos;
+			float min_cost = cost_at(min_pos, line);
 
-		if (child_y > 0) {
-			float up_cost = u_cost_map[(child_y - 1) * width + x];
-			if (up_cost < min_cost) {
-				min_cost = up_cost;
-				min_y = child_y - 1;
+			if (child_pos > 0) {
+				float before_cost = cost_at(child_pos - 1, line);
+				if (before_cost < min_cost) {
+					min_cost = before_cost;
+					min_pos = child_pos - 1;
+				}
 			}
-		}
 
-		if (child_y < height - 1) {
-			float down_cost = u_cost_map[(child_y + 1) * width + x];
-			if (down_cost < min_cost) {
-				min_y = child_y + 1;
+			if (child_pos < pos_count - 1) {
+				float after_cost = cost_at(child_pos + 1, line);
+				if (after_cost < min_cost) {
+					min_pos = child_pos + 1;
+				}
 			}
+
+			s_seam_pos[seam] = min_pos;
 		}
+	}
+	barrier();
+
+	// Seams may want the same pixel. Nudge them apart so they stay strictly
+	// ordered and never cross, then pull them back inside the image.
+	if (seam == 0) {
+		for (int i = 1; i < u_seam_count; ++i) {
+			s_seam_pos[i] = max(s_seam_pos[i], s_seam_pos[i - 1] + 1);
+		}
+		s_seam_pos[u_seam_count - 1] = min(s_seam_pos[u_seam_count - 1], pos_count - 1);
+		for (int i = u_seam_count - 2; i >= 0; --i) {
+			s_seam_pos[i] = min(s_seam_pos[i], s_seam_pos[i + 1] - 1);
+		}
+	}
+	barrier();
 
-		u_seam_coords[x] = min_y;
+	if (seam < u_seam_count) {
+		u_seam_coords[line * u_seam_count + seam] = s_seam_pos[seam];
 	}
 }
 )");
 
-	String8 const cs_h_remove_seam = str8_literal(R"(
-#version 460 core
-layout (local_size_x = 8, local_size_y = 8, local_size_z = 1) in;
+	String8 const cs_compact = str8_literal(R"(
+layout (local_size_x = TILE_WIDTH, local_size_y = TILE_HEIGHT, local_size_z = 1) in;
 
 layout (rgba8, binding = 0) uniform image2D u_image_in;
 layout (rgba8, binding = 1) uniform image2D u_image_out;
 
 layout (std430, binding = 0) buffer SeamData {
-	int u_seam_coords[]; // y-coord for each col x
+	int u_seam_coords[]; // u_seam_count sorted positions for each line
 };
 
 layout (std140, binding = 0) uniform CarveParams {
 	ivec2 u_current_size;
 	ivec2 u_texture_size;
 	int u_current_iteration;
+	int u_seam_count;
 };
 
 void main() {
 	const ivec2 coord = ivec2(gl_GlobalInvocationID.xy);
-	if (coord.x >= u_current_size.x || coord.y >= u_current_size.y - 1) {
+	const int pos = SEAM_POS(coord);
+	const int line = SEAM_LINE(coord);
+	if (pos >= SEAM_POS(u_current_size) - u_seam_count || line >= SEAM_LINE(u_current_size)) {
 		return;
 	}
 
-	const int seam_y = u_seam_coords[coord.x];
-
-	ivec2 read_coord = coord;
-	if (coord.y >= seam_y) {
-		read_coord.y += 1;
+	// Pixels kept in front of removed entry i is (removed[i] - i), which never
+	// decreases, so a binary search gives the prefix count of removed pixels at
+	// or before the source of this output pixel.
+	const int base = line * u_seam_count;
+	int lo = 0;
+	int hi = u_seam_count;
+	while (lo < hi) {
+		const int mid = (lo + hi) / 2;
+		if (u_seam_coords[base + mid] - mid <= pos) {
+			lo = mid + 1;
+		} else {
+			hi = mid;
+		}
 	}
 
-	const vec4 color = imageLoad(u_image_in, read_coord);
+	const vec4 color = imageLoad(u_image_in, SEAM_COORD(pos + lo, line));
 	imageStore(u_image_out, coord, color);
 }
 )");
+
+	/// How the source of a stage is put together and which variant fields it reads.
+	struct SC_ShaderStageInfo {
+		String8 source;
+		b8 uses_axis; ///< Needs glsl_axis.
+		b8 uses_index_map; ///< Needs glsl_index_map.
+		b8 uses_energy; ///< Needs glsl_energy.
+		b8 uses_workgroup_size;
+		b8 uses_tiles;
+	};
+
+	SC_ShaderStageInfo const sc_shader_stages[] = {
+		{ .source = cs_srgb_to_linear, .uses_tiles = true },
+		{ .source = cs_linear_to_srgb, .uses_tiles = true },
+		{ .source = cs_sobel, .uses_energy = true, .uses_tiles = true },
+		{ .source = cs_sobel_index_map, .uses_index_map = true, .uses_energy = true, .uses_tiles = true },
+		{ .source = cs_index_map_insert, .uses_index_map = true },
+		{ .source = cs_downsample, .uses_tiles = true },
+		{ .source = cs_cost, .uses_axis = true, .uses_workgroup_size = true },
+		{ .source = cs_find_min_local, .uses_axis = true, .uses_workgroup_size = true },
+		{ .source = cs_find_min_global, .uses_axis = true, .uses_workgroup_size = true },
+		{ .source = cs_backtrace, .uses_axis = true },
+		{ .source = cs_remove_seam, .uses_axis = true, .uses_tiles = true },
+		{ .source = cs_band_seam, .uses_axis = true, .uses_energy = true, .uses_workgroup_size = true },
+		{ .source = cs_find_min_k, .uses_axis = true, .uses_workgroup_size = true },
+		{ .source = cs_backtrace_k, .uses_axis = true },
+		{ .source = cs_compact, .uses_axis = true, .uses_tiles = true },
+	};
+	static_assert(sizeof(sc_shader_stages) / sizeof(sc_shader_stages[0]) == static_cast<u64>(SC_ShaderStage::MAX_COUNT));
+}
+
+auto dk::sc_display_fragment_source(Arena *arena) noexcept -> String8 {
+	String8List pieces = {};
+	str8_list_push(arena, &pieces, fs_display_head);
+	str8_list_push(arena, &pieces, glsl_index_map);
+	str8_list_push(arena, &pieces, fs_display_body);
+	return str8_list_join(arena, pieces, nullptr);
+}
+
+auto dk::sc_shader_variant_canonical(SC_ShaderVariant const *variant) noexcept -> SC_ShaderVariant {
+	SC_ShaderStageInfo const *stage = &sc_shader_stages[static_cast<u32>(variant->stage)];
+	return {
+		.stage = variant->stage,
+		.axis = stage->uses_axis ? variant->axis : 0,
+		.workgroup_size = stage->uses_workgroup_size ? variant->workgroup_size : 0,
+		.tile_width = stage->uses_tiles ? variant->tile_width : 0,
+		.tile_height = stage->uses_tiles ? variant->tile_height : 0
+	};
+}
+
+auto dk::sc_shader_variant_source(Arena *arena, SC_ShaderVariant const *variant) noexcept -> String8 {
+	SC_ShaderStageInfo const *stage = &sc_shader_stages[static_cast<u32>(variant->stage)];
+
+	String8List pieces = {};
+	str8_list_pushf(
+		arena, &pieces,
+		"#version 460 core\n"
+		"#define AXIS %d\n"
+		"#define WORKGROUP_SIZE %d\n"
+		"#define TILE_WIDTH %d\n"
+		"#define TILE_HEIGHT %d\n"
+		"#define MAX_SEAMS %d\n"
+		"#define INDEX_MAP %d\n",
+		variant->axis, variant->workgroup_size, variant->tile_width, variant->tile_height, SC_MAX_SEAMS_PER_PASS,
+		stage->uses_index_map ? 1 : 0
+	);
+	if (stage->uses_axis) {
+		str8_list_push(arena, &pieces, glsl_axis);
+	}
+	if (stage->uses_index_map) {
+		str8_list_push(arena, &pieces, glsl_index_map);
+	}
+	if (stage->uses_energy) {
+		str8_list_push(arena, &pieces, glsl_energy_decl);
+	}
+	str8_list_push(arena, &pieces, stage->source);
+	if (stage->uses_energy) {
+		str8_list_push(arena, &pieces, glsl_energy);
+	}
+	return str8_list_join(arena, pieces, nullptr);
 }
@@ -5,10 +5,13 @@
 
 #pragma once
 
+#include "base/base_arena.hpp"
 #include "base/base_math.hpp"
 #include "base/base_strings.hpp"
 
 namespace dk {
+	constexpr s32 SC_MAX_SEAMS_PER_PASS = 32; ///< Batch backtrace runs one seam per invocation of a single workgroup.
+
 	struct SC_DisplayParams {
 		alignas(8) ivec2 window_size;
 		alignas(8) ivec2 image_size;
@@ -16,29 +19,76 @@ namespace dk {
 		alignas(4) s32 debug_view_mode; ///< 0: None, 1: Energy
 		alignas(4) s32 show_seam; ///< 0: false, 1: true
 		alignas(4) s32 is_horizontal; ///< 0: false, 1: true (for seam drawing)
+		alignas(4) s32 seam_count; ///< Seams stored per row/col in the seam buffer.
 	};
 
 	struct SC_CarveParams {
 		alignas(8) ivec2 current_size;
 		alignas(8) ivec2 texture_size;
 		alignas(4) s32 current_iteration;
+		alignas(4) s32 seam_count; ///< Seams extracted per pass, only read by the batch passes.
+	};
+
+	struct SC_IndexMapParams {
+		alignas(4) s32 removed_count; ///< Removed source indices stored per row/col, 0 when the image is dense.
+		alignas(4) s32 is_horizontal; ///< 0: lists are per row, 1: lists are per col.
+	};
+
+	struct SC_ResampleParams {
+		alignas(8) ivec2 src_size;
+		alignas(8) ivec2 dst_size;
+		alignas(4) s32 scale; ///< Box filter footprint (scale x scale source texels).
+	};
+
+	struct SC_BandParams {
+		alignas(8) ivec2 size; ///< Size of the level being refined.
+		alignas(8) ivec2 texture_size; ///< Size of the texture backing the level.
+		alignas(8) ivec2 guide_size; ///< Size of the level the guide seam was found on.
+		alignas(4) s32 guide_scale; ///< Ratio between the refined level and the guide level.
+		alignas(4) s32 band_offset; ///< Band start relative to the upsampled guide seam.
+		alignas(4) s32 band_width;
+		alignas(4) s32 interpolate_guide; ///< 0: false, 1: true
 	};
 
 	extern String8 const vs_display;
-	extern String8 const fs_display;
-
-	extern String8 const cs_srgb_to_linear;
-	extern String8 const cs_sobel;
-
-	extern String8 const cs_v_cost_row;
-	extern String8 const cs_v_find_min_local;
-	extern String8 const cs_v_find_min_global;
-	extern String8 const cs_v_backtrace;
-	extern String8 const cs_v_remove_seam;
-
-	extern String8 const cs_h_cost_col;
-	extern String8 const cs_h_find_min_local;
-	extern String8 const cs_h_find_min_global;
-	extern String8 const cs_h_backtrace;
-	extern String8 const cs_h_remove_seam;
+
+	/// Fragment source of the display program, allocated from `arena`.
+	auto sc_display_fragment_source(Arena *arena) noexcept -> String8;
+
+	/// Compute stages, each built from one source for every variant.
+	enum class SC_ShaderStage : u32 {
+		SRGB_TO_LINEAR = 0,
+		LINEAR_TO_SRGB,
+		SOBEL,
+		SOBEL_INDEX_MAP,
+		INDEX_MAP_INSERT,
+		DOWNSAMPLE,
+		COST,
+		FIND_MIN_LOCAL,
+		FIND_MIN_GLOBAL,
+		BACKTRACE,
+		REMOVE_SEAM,
+		BAND_SEAM,
+		FIND_MIN_K,
+		BACKTRACE_K,
+		COMPACT,
+
+		MAX_COUNT
+	};
+
+	// NOTE(Dedrick): Every field becomes a #define in front of the stage source.
+	/// One compiled form of a stage.
+	struct SC_ShaderVariant {
+		SC_ShaderStage stage;
+		s32 axis; ///< AXIS, 0: vertical seams, 1: horizontal seams.
+		s32 workgroup_size; ///< WORKGROUP_SIZE of the reductions, a power of two.
+		s32 tile_width; ///< TILE_WIDTH of the per pixel stages.
+		s32 tile_height; ///< TILE_HEIGHT of the per pixel stages.
+	};
+
+	/// `variant` with the fields its stage does not read zeroed, so they never tell two programs apart.
+	auto sc_shader_variant_canonical(SC_ShaderVariant const *variant) noexcept -> SC_ShaderVariant;
+
+	/// Full compute source of `variant`, allocated from `arena`.
+	auto sc_shader_variant_source(Arena *arena, SC_ShaderVariant const *variant) noexcept -> String8;
 }
@@ -0,0 +1,298 @@
+/*
+ * Copyright (C) 2025 Koh Swee Teck Dedrick.
+ * Licensed under the Apache License, Version 2.0 (http://www.apache.org/licenses/LICENSE-2.0)
+ */
+
+#include "sc_autotune.hpp"
+
+#include "base/base_assert.h"
+#include "base/base_math.hpp"
+#include "base/base_thread_context.hpp"
+#include "base/base_utils.hpp"
+#include "os/os_core.hpp"
+
+#include <cfloat>
+#include <cstdio>
+#include <cstring>
+
+namespace {
+	using namespace dk;
+
+	constexpr u32 SC_AUTOTUNE_WARMUP_RUNS = 1;
+	constexpr u32 SC_AUTOTUNE_TIMED_RUNS = 5;
+	constexpr s32 SC_AUTOTUNE_MIN_REDUCTION_SIZE = 32; ///< Allows band radii up to 15, well above the default of 4.
+
+	constexpr s32 sc_autotune_tiles[][2] = {
+		{ 8, 4 }, { 8, 8 }, { 16, 2 }, { 16, 4 }, { 16, 8 }, { 32, 1 }, { 32, 2 }, { 32, 4 }, { 32, 8 }
+	};
+	constexpr s32 sc_autotune_cost_sizes[] = { 32, 64, 128, 256, 512, 1024 };
+	constexpr s32 sc_autotune_reduction_sizes[] = { 64, 128, 256, 512, 1024 };
+
+	auto sc_autotune_candidate_count(SC_AutotuneKnob knob) noexcept -> u32 {
+		switch (knob) {
+			case SC_AutotuneKnob::TILES: return static_cast<u32>(array_size(sc_autotune_tiles));
+			case SC_AutotuneKnob::COST: return static_cast<u32>(array_size(sc_autotune_cost_sizes));
+			case SC_AutotuneKnob::REDUCTION: return static_cast<u32>(array_size(sc_autotune_reduction_sizes));
+			default: return 0;
+		}
+	}
+
+	/// `base` with the `index`-th candidate of `knob` applied.
+	auto sc_autotune_candidate(SC_KernelConfig const *base, SC_AutotuneKnob knob, u32 index) noexcept -> SC_KernelConfig {
+		SC_KernelConfig kernels = *base;
+		switch (knob) {
+			case SC_AutotuneKnob::TILES: {
+				kernels.tile_width = sc_autotune_tiles[index][0];
+				kernels.tile_height = sc_autotune_tiles[index][1];
+			} break;
+			case SC_AutotuneKnob::COST: {
+				kernels.cost_size = sc_autotune_cost_sizes[index];
+			} break;
+			case SC_AutotuneKnob::REDUCTION: {
+				kernels.reduction_size = sc_autotune_reduction_sizes[index];
+			} break;
+			default: break;
+		}
+		return kernels;
+	}
+
+	/// True when the device can run every variant of `kernels`.
+	auto sc_kernel_config_fits(SC_KernelConfig const *kernels) noexcept -> b8 {
+		GLint max_invocations = 0;
+		GLint max_size_x = 0;
+		GLint max_size_y = 0;
+		glGetIntegerv(GL_MAX_COMPUTE_WORK_GROUP_INVOCATIONS, &max_invocations);
+		glGetIntegeri_v(GL_MAX_COMPUTE_WORK_GROUP_SIZE, 0, &max_size_x);
+		glGetIntegeri_v(GL_MAX_COMPUTE_WORK_GROUP_SIZE, 1, &max_size_y);
+
+		s32 const max_local_x = glm::min(max_invocations, max_size_x);
+		b8 const reduction_is_pow2 = (kernels->reduction_size & (kernels->reduction_size - 1)) == 0;
+		return kernels->cost_size >= 1 && kernels->cost_size <= max_local_x
+			&& reduction_is_pow2 && kernels->reduction_size >= SC_AUTOTUNE_MIN_REDUCTION_SIZE && kernels->reduction_size <= max_local_x
+			&& kernels->tile_width >= 1 && kernels->tile_width <= max_size_x
+			&& kernels->tile_height >= 1 && kernels->tile_height <= max_size_y
+			&& kernels->tile_width * kernels->tile_height <= max_invocations;
+	}
+
+	/// Hashed blocks of color, enough edges for the energy and seams to look like a photo's.
+	auto sc_autotune_image(Arena *arena, s32 width, s32 height) noexcept -> u8 * {
+		u8 *pixels = arena_push_type_array<u8>(arena, static_cast<u64>(width) * height * 4);
+		for (s32 y = 0; y < height; ++y) {
+			for (s32 x = 0; x < width; ++x) {
+				u32 h = static_cast<u32>(x / 6) * 0x8DA6B343u ^ static_cast<u32>(y / 6) * 0xD8163841u;
+				h = (h ^ (h >> 15)) * 0x2C1B3C6Du;
+				h ^= h >> 12;
+				u8 *pixel = pixels + (static_cast<u64>(y) * width + x) * 4;
+				pixel[0] = static_cast<u8>(h);
+				pixel[1] = static_cast<u8>(h >> 8);
+				pixel[2] = static_cast<u8>(h >> 16);
+				pixel[3] = 255;
+			}
+		}
+		return pixels;
+	}
+
+	/// Fastest of the timed runs of the passes `knob` sizes, in milliseconds.
+	auto sc_autotune_time(SC_Carver *carver, SC_AutotuneKnob knob, GLuint const *queries) noexcept -> f64 {
+		ivec2 const texture_size = { carver->max_texture_size, carver->max_texture_size };
+		f64 best_ms = DBL_MAX;
+		for (u32 run = 0; run < SC_AUTOTUNE_WARMUP_RUNS + SC_AUTOTUNE_TIMED_RUNS; ++run) {
+			sc_carver_reset(carver);
+			ivec2 const size = { carver->current_width, carver->current_height };
+
+			// NOTE(Dedrick): Each (begin, end) pair brackets the timed passes of one segment, the untimed
+			// passes that feed them run outside.
+			u32 segment_count = 0;
+			if (knob == SC_AutotuneKnob::TILES) {
+				glQueryCounter(queries[0], GL_TIMESTAMP);
+				sc_compute_current_energy(carver);
+				sc_remove_seam(carver, SC_AXIS_VERTICAL);
+				sc_remove_seam(carver, SC_AXIS_HORIZONTAL);
+				glQueryCounter(queries[1], GL_TIMESTAMP);
+				segment_count = 1;
+			} else {
+				sc_compute_current_energy(carver);
+				for (u32 axis = 0; axis < SC_AXIS_MAX_COUNT; ++axis) {
+					SC_Axis const seam_axis = static_cast<SC_Axis>(axis);
+					if (knob == SC_AutotuneKnob::COST) {
+						glQueryCounter(queries[axis * 2], GL_TIMESTAMP);
+						sc_fill_cost_map(carver, seam_axis, carver->gpu.tex_energy, size, texture_size);
+						glQueryCounter(queries[axis * 2 + 1], GL_TIMESTAMP);
+					} else {
+						sc_fill_cost_map(carver, seam_axis, carver->gpu.tex_energy, size, texture_size);
+						glQueryCounter(queries[axis * 2], GL_TIMESTAMP);
+						sc_find_min_seam_end(carver, seam_axis, size, texture_size);
+						glQueryCounter(queries[axis * 2 + 1], GL_TIMESTAMP);
+					}
+				}
+				segment_count = SC_AXIS_MAX_COUNT;
+			}
+
+			u64 elapsed_ns = 0;
+			for (u32 segment = 0; segment < segment_count; ++segment) {
+				GLuint64 begin_ns = 0;
+				GLuint64 end_ns = 0;
+				glGetQueryObjectui64v(queries[segment * 2], GL_QUERY_RESULT, &begin_ns);
+				glGetQueryObjectui64v(queries[segment * 2 + 1], GL_QUERY_RESULT, &end_ns);
+				elapsed_ns += end_ns - begin_ns;
+			}
+			if (run >= SC_AUTOTUNE_WARMUP_RUNS) {
+				best_ms = glm::min(best_ms, static_cast<f64>(elapsed_ns) / 1.0e6);
+			}
+		}
+		return best_ms;
+	}
+
+	auto sc_kernel_profile_path(Arena *arena, SC_ShaderCache const *cache) noexcept -> String8 {
+		return str8f(arena, "%.*s/kernel_profile.txt", static_cast<int>(cache->directory.size), cache->directory.data);
+	}
+
+	/// Profile lines are "<gpu_hash> <cost_size> <reduction_size> <tile_width> <tile_height>".
+	auto sc_kernel_profile_parse(String8 line, u64 *gpu_hash, SC_KernelConfig *kernels) noexcept -> b8 {
+		char buffer[128];
+		if (line.size == 0 || line.size >= sizeof(buffer) || line.data[0] == '#') {
+			return false;
+		}
+		std::memcpy(buffer, line.data, line.size);
+		buffer[line.size] = '\0';
+
+		unsigned long long hash = 0;
+		int const matched = std::sscanf(
+			buffer, "%llx %d %d %d %d",
+			&hash, &kernels->cost_size, &kernels->reduction_size, &kernels->tile_width, &kernels->tile_height
+		);
+		*gpu_hash = static_cast<u64>(hash);
+		return matched == 5;
+	}
+
+	auto sc_kernel_profile_lines(Arena *arena, OS_FileMap map) noexcept -> String8List {
+		String8 const line_ends[] = { str8_literal("\n"), str8_literal("\r") };
+		return map.data != nullptr
+			? str8_list_split(arena, { .data = map.data, .size = map.size }, line_ends, array_size(line_ends))
+			: String8List{};
+	}
+}
+
+auto dk::sc_autotune(SC_Carver *carver, s32 width, s32 height, SC_AutotuneReport *report) noexcept -> void {
+	DK_ASSERT(carver != nullptr && report != nullptr);
+	DK_ASSERT(width <= carver->max_texture_size && height <= carver->max_texture_size);
+	*report = {};
+
+	ScratchArena const scratch = arena_scratch_begin(tc_get_scratch(nullptr, 0));
+	sc_carver_load_image(carver, sc_autotune_image(scratch.arena, width, height), width, height);
+	arena_scratch_end(scratch);
+
+	// NOTE(Dedrick): Submitting every candidate before timing any lets the driver compile them in parallel.
+	SC_KernelConfig const defaults = sc_kernel_config_default();
+	for (u32 knob = 0; knob < static_cast<u32>(SC_AutotuneKnob::MAX_COUNT); ++knob) {
+		for (u32 i = 0; i < sc_autotune_candidate_count(static_cast<SC_AutotuneKnob>(knob)); ++i) {
+			SC_KernelConfig const kernels = sc_autotune_candidate(&defaults, static_cast<SC_AutotuneKnob>(knob), i);
+			if (sc_kernel_config_fits(&kernels)) {
+				sc_carver_set_kernels(carver, &kernels);
+				sc_carver_prepare_axis(carver, SC_AXIS_VERTICAL);
+				sc_carver_prepare_axis(carver, SC_AXIS_HORIZONTAL);
+			}
+		}
+	}
+	sc_shader_cache_poll(carver->gpu.shader_cache, true);
+
+	GLuint queries[SC_AXIS_MAX_COUNT * 2];
+	glCreateQueries(GL_TIMESTAMP, static_cast<GLsizei>(array_size(queries)), queries);
+
+	SC_KernelConfig best = defaults;
+	for (u32 knob = 0; knob < static_cast<u32>(SC_AutotuneKnob::MAX_COUNT); ++knob) {
+		SC_AutotuneKnob const tuned_knob = static_cast<SC_AutotuneKnob>(knob);
+		f64 best_ms = DBL_MAX;
+		for (u32 i = 0; i < sc_autotune_candidate_count(tuned_knob); ++i) {
+			SC_KernelConfig const kernels = sc_autotune_candidate(&defaults, tuned_knob, i);
+			if (!sc_kernel_config_fits(&kernels) || report->trial_count == SC_AUTOTUNE_MAX_TRIALS) {
+				continue;
+			}
+			sc_carver_set_kernels(carver, &kernels);
+			f64 const time_ms = sc_autotune_time(carver, tuned_knob, queries);
+			report->trials[report->trial_count++] = {
+				.knob = tuned_knob,
+				.kernels = kernels,
+				.time_ms = time_ms
+			};
+
+			if (time_ms < best_ms) {
+				best_ms = time_ms;
+				best = sc_autotune_candidate(&best, tuned_knob, i);
+			}
+		}
+	}
+
+	glDeleteQueries(static_cast<GLsizei>(array_size(queries)), queries);
+	sc_carver_set_kernels(carver, &best);
+	sc_carver_reset(carver);
+	report->best = best;
+}
+
+auto dk::sc_kernel_profile_load(SC_ShaderCache const *cache, SC_KernelConfig *kernels) noexcept -> b8 {
+	DK_ASSERT(kernels != nullptr);
+	if (cache == nullptr || cache->directory.size == 0) {
+		return false;
+	}
+
+	ScratchArena const scratch = arena_scratch_begin(tc_get_scratch(nullptr, 0));
+	OS_Handle const file = os_file_open(sc_kernel_profile_path(scratch.arena, cache), OS_ACCESS_FLAG_READ);
+	OS_FileMap const map = os_file_map(file);
+	os_file_close(file);
+
+	b8 found = false;
+	String8List const lines = sc_kernel_profile_lines(scratch.arena, map);
+	for (String8Node const *node = lines.first; node != nullptr && !found; node = node->next) {
+		u64 gpu_hash = 0;
+		SC_KernelConfig entry = {};
+		if (sc_kernel_profile_parse(node->string, &gpu_hash, &entry) && gpu_hash == cache->gpu_hash
+			&& sc_kernel_config_fits(&entry)) {
+			*kernels = entry;
+			found = true;
+		}
+	}
+	os_file_unmap(map);
+	arena_scratch_end(scratch);
+	return found;
+}
+
+auto dk::sc_kernel_profile_store(SC_ShaderCache const *cache, SC_KernelConfig const *kernels) noexcept -> b8 {
+	DK_ASSERT(kernels != nullptr);
+	if (cache == nullptr || cache->directory.size == 0) {
+		return false;
+	}
+
+	ScratchArena const scratch = arena_scratch_begin(tc_get_scratch(nullptr, 0));
+	String8 const path = sc_kernel_profile_path(scratch.arena, cache);
+	OS_Handle const read_file = os_file_open(path, OS_ACCESS_FLAG_READ);
+	OS_FileMap const map = os_file_map(read_file);
+	os_file_close(read_file);
+
+	// NOTE(Dedrick): Entries of other GPUs are kept, so one profile can be shared by a whole fleet.
+	String8List out = {};
+	str8_list_push(scratch.arena, &out, str8_literal("# gpu cost_size reduction_size tile_width tile_height\n"));
+	String8List const lines = sc_kernel_profile_lines(scratch.arena, map);
+	for (String8Node const *node = lines.first; node != nullptr; node = node->next) {
+		u64 gpu_hash = 0;
+		SC_KernelConfig entry = {};
+		if (sc_kernel_profile_parse(node->string, &gpu_hash, &entry) && gpu_hash != cache->gpu_hash) {
+			str8_list_pushf(scratch.arena, &out, "%.*s\n", static_cast<int>(node->string.size), node->string.data);
+		}
+	}
+	str8_list_pushf(
+		scratch.arena, &out, "%016llx %d %d %d %d\n",
+		static_cast<unsigned long long>(cache->gpu_hash),
+		kernels->cost_size, kernels->reduction_size, kernels->tile_width, kernels->tile_height
+	);
+	String8 const contents = str8_list_join(scratch.arena, out, nullptr);
+	os_file_unmap(map);
+
+	b8 written = false;
+	OS_Handle const file = os_file_open(path, OS_ACCESS_FLAG_WRITE);
+	if (file != os_handle_invalid()) {
+		written = os_file_write(file, 0, contents.size, contents.data) == contents.size;
+		os_file_close(file);
+	}
+	arena_scratch_end(scratch);
+	return written;
+}
@@ -0,0 +1,50 @@
+/*
+ * Copyright (C) 2025 Koh Swee Teck Dedrick.
+ * Licensed under the Apache License, Version 2.0 (http://www.apache.org/licenses/LICENSE-2.0)
+ */
+
+#pragma once
+
+#include "base/base_types.hpp"
+#include "sc/sc_carve.hpp"
+#include "sc/sc_shader_cache.hpp"
+
+namespace dk {
+	constexpr u32 SC_AUTOTUNE_MAX_TRIALS = 32;
+	constexpr s32 SC_AUTOTUNE_DEFAULT_WIDTH = 1920;
+	constexpr s32 SC_AUTOTUNE_DEFAULT_HEIGHT = 1080;
+
+	/// Part of SC_KernelConfig tuned on its own, timed on the passes it sizes.
+	enum class SC_AutotuneKnob : u32 {
+		TILES = 0, ///< tile_width and tile_height, timed on the energy and seam removal passes.
+		COST, ///< cost_size, timed on the cost map pass.
+		REDUCTION, ///< reduction_size, timed on the min search.
+
+		MAX_COUNT
+	};
+
+	struct SC_AutotuneTrial {
+		SC_AutotuneKnob knob;
+		SC_KernelConfig kernels;
+		f64 time_ms; ///< Fastest timed run, both axes.
+	};
+
+	struct SC_AutotuneReport {
+		SC_AutotuneTrial trials[SC_AUTOTUNE_MAX_TRIALS];
+		u32 trial_count;
+		SC_KernelConfig best;
+	};
+
+	// NOTE(Dedrick): Knobs only change how the work is split, so each is tuned with the others at their
+	// default. Candidates the device cannot run are skipped, every candidate is compiled up front.
+	/// Times the candidates of every knob on a generated `width` x `height` image with GL_TIMESTAMP
+	/// queries. Replaces the carver's image and leaves it on the fastest config.
+	auto sc_autotune(SC_Carver *carver, s32 width, s32 height, SC_AutotuneReport *report) noexcept -> void;
+
+	/// Reads the entry of this GPU from the profile in the shader cache directory. False, leaving
+	/// `kernels` untouched, without a cache directory, an entry, or when the entry does not fit the device.
+	auto sc_kernel_profile_load(SC_ShaderCache const *cache, SC_KernelConfig *kernels) noexcept -> b8;
+
+	/// Writes `kernels` as the entry of this GPU, keeping the entries of other GPUs.
+	auto sc_kernel_profile_store(SC_ShaderCache const *cache, SC_KernelConfig const *kernels) noexcept -> b8;
+}
@@ -0,0 +1,307 @@
+/*
+ * Copyright (C) 2025 Koh Swee Teck Dedrick.
+ * Licensed under the Apache License, Version 2.0 (http://www.apache.org/licenses/LICENSE-2.0)
+ */
+
+#include "sc_batch.hpp"
+
+#include "base/base_assert.h"
+#include "base/base_jobs.hpp"
+#include "base/base_math.hpp"
+#include "base/base_profile.hpp"
+#include "base/base_thread_context.hpp"
+#include "os/os_core.hpp"
+#include "sc/sc_cpu.hpp"
+#include "sc/sc_image.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+
+namespace {
+	using namespace dk;
+
+	struct SC_ThroughputImage {
+		u32 path_index;
+		u64 pixel_count; ///< From the header, only orders the images.
+		u64 latency_us; ///< Decode, carve and encode.
+		b8 failed;
+	};
+
+	/// Written by its own worker only, padded so workers never share a cache line.
+	struct alignas(64) SC_ThroughputWorker {
+		SC_CpuCarver carver; ///< Zeroed until the first image.
+		u64 busy_us;
+	};
+
+	struct SC_Throughput {
+		SC_ThroughputParams const *params;
+		SC_ThroughputImage *images; ///< Largest first once sorted.
+		SC_ThroughputWorker *workers;
+		std::atomic<u32> next_image;
+	};
+
+	auto sc_batch_file_name(String8 path) noexcept -> String8 {
+		u64 start = path.size;
+		while (start > 0 && !char_is_slash(path.data[start - 1])) {
+			start -= 1;
+		}
+		return { .data = path.data + start, .size = path.size - start };
+	}
+
+	auto sc_batch_paths_alloc(Arena *arena, u64 count, SC_BatchPaths *out_paths) noexcept -> void {
+		out_paths->input_paths = arena_push_type_array<String8>(arena, count);
+		out_paths->output_paths = arena_push_type_array<String8>(arena, count);
+		out_paths->count = 0;
+	}
+
+	auto sc_batch_paths_push(Arena *arena, SC_BatchPaths *paths, String8 input_path, String8 output_directory) noexcept -> void {
+		String8 const file_name = sc_batch_file_name(input_path);
+		paths->input_paths[paths->count] = str8_copy(arena, input_path);
+		paths->output_paths[paths->count] = str8f(
+			arena, "%.*s/%.*s",
+			static_cast<int>(output_directory.size), output_directory.data,
+			static_cast<int>(file_name.size), file_name.data
+		);
+		paths->count += 1;
+	}
+
+	// NOTE(Dedrick): Outputs keep only the file name, so two listed files with the same name would overwrite
+	// each other. Compared case-insensitively as the file system is. Lists are short enough for the pairwise check.
+	/// Prints the first two inputs that write the same output path.
+	auto sc_batch_paths_unique(SC_BatchPaths const *paths) noexcept -> b8 {
+		for (u32 i = 0; i < paths->count; ++i) {
+			for (u32 j = i + 1; j < paths->count; ++j) {
+				if (str8_compare(paths->output_paths[i], paths->output_paths[j], STRING_MATCH_FLAG_CASE_INSENSITIVE) == 0) {
+					(void)std::fprintf(
+						stderr, "Error: %.*s and %.*s both write %.*s\n",
+						static_cast<int>(paths->input_paths[i].size), paths->input_paths[i].data,
+						static_cast<int>(paths->input_paths[j].size), paths->input_paths[j].data,
+						static_cast<int>(paths->output_paths[i].size), paths->output_paths[i].data
+					);
+					return false;
+				}
+			}
+		}
+		return true;
+	}
+
+	auto sc_throughput_info(void *params, u32 worker_index, u32 worker_count) noexcept -> void {
+		SC_Throughput *throughput = static_cast<SC_Throughput *>(params);
+		SC_BatchPaths const *paths = &throughput->params->paths;
+		JobRange const range = job_range(paths->count, worker_index, worker_count);
+		for (u64 i = range.begin; i < range.end; ++i) {
+			SC_Image const info = sc_image_info(paths->input_paths[i]);
+			throughput->images[i] = {
+				.path_index = static_cast<u32>(i),
+				.pixel_count = static_cast<u64>(info.width) * static_cast<u64>(info.height)
+			};
+		}
+	}
+
+	auto sc_throughput_carve(SC_ThroughputWorker *worker, SC_ThroughputParams const *params, u32 path_index) noexcept -> b8 {
+		DK_PROFILE_SCOPE("image");
+		String8 const input_path = params->paths.input_paths[path_index];
+		String8 const output_path = params->paths.output_paths[path_index];
+
+		ScratchArena const scratch = arena_scratch_begin(tc_get_scratch(nullptr, 0));
+		SC_Image const image = sc_image_load(scratch.arena, input_path);
+		if (image.pixels == nullptr) {
+			(void)std::fprintf(stderr, "Error: Failed to load image: %s\n", reinterpret_cast<char const *>(input_path.data));
+			arena_scratch_end(scratch);
+			return false;
+		}
+
+		// NOTE(Dedrick): Largest first means the first image of a worker is usually its largest,
+		// so the carver is sized once instead of growing.
+		u64 const texel_count = static_cast<u64>(image.width) * image.height;
+		s32 const size = glm::max(image.width, image.height);
+		if (texel_count > worker->carver.texel_capacity || size > worker->carver.max_size) {
+			u64 const texel_capacity = glm::max(texel_count, worker->carver.texel_capacity);
+			s32 const max_size = glm::max(size, worker->carver.max_size);
+			if (worker->carver.arena != nullptr) {
+				sc_cpu_carver_release(&worker->carver);
+			}
+			sc_cpu_carver_init(&worker->carver, nullptr, texel_capacity, max_size, ARENA_FLAG_NONE);
+		}
+
+		SC_CpuCarver *carver = &worker->carver;
+		sc_cpu_carver_load_image(carver, image.pixels, image.width, image.height);
+		{
+			DK_PROFILE_SCOPE("carve");
+			s32 const target_width = params->target_width > 0 ? glm::min(params->target_width, image.width) : image.width;
+			s32 const target_height = params->target_height > 0 ? glm::min(params->target_height, image.height) : image.height;
+			sc_cpu_carve_seams(carver, SC_AXIS_VERTICAL, carver->current_width - target_width);
+			sc_cpu_carve_seams(carver, SC_AXIS_HORIZONTAL, carver->current_height - target_height);
+		}
+
+		SC_Image const carved = {
+			.pixels = static_cast<u8 *>(arena_push_no_zero(
+				scratch.arena,
+				static_cast<u64>(carver->current_width) * carver->current_height * 4,
+				64
+			)),
+			.width = carver->current_width,
+			.height = carver->current_height
+		};
+		sc_cpu_carver_read_pixels(carver, carved.pixels);
+		// NOTE(Dedrick): Every worker is busy with an image of its own, so each encodes on its own thread.
+		SC_ImageSaveParams const save_params = { .pool = nullptr, .png_level = params->png_level };
+		b8 const saved = sc_image_save(output_path, carved, sc_image_format_from_path(output_path), &save_params);
+		if (!saved) {
+			(void)std::fprintf(stderr, "Error: Failed to save image: %s\n", reinterpret_cast<char const *>(output_path.data));
+		}
+		arena_scratch_end(scratch);
+		return saved;
+	}
+
+	auto sc_throughput_worker(void *params, u32 worker_index, u32 worker_count) noexcept -> void {
+		(void)worker_count;
+		SC_Throughput *throughput = static_cast<SC_Throughput *>(params);
+		SC_ThroughputWorker *worker = &throughput->workers[worker_index];
+		u32 const image_count = throughput->params->paths.count;
+		for (;;) {
+			u32 const i = throughput->next_image.fetch_add(1, std::memory_order_relaxed);
+			if (i >= image_count) {
+				break;
+			}
+			SC_ThroughputImage *image = &throughput->images[i];
+			u64 const start_time_us = os_now_microseconds();
+			image->failed = !sc_throughput_carve(worker, throughput->params, image->path_index);
+			image->latency_us = os_now_microseconds() - start_time_us;
+			worker->busy_us += image->latency_us;
+		}
+	}
+
+	/// Nearest rank, `sorted` must be ascending and not empty.
+	auto sc_batch_percentile_ms(u64 const *sorted, u32 count, f64 percentile) noexcept -> f64 {
+		s32 const index = glm::clamp(static_cast<s32>(glm::ceil(percentile * count)) - 1, 0, static_cast<s32>(count) - 1);
+		return static_cast<f64>(sorted[index]) / 1000.0;
+	}
+}
+
+auto dk::sc_batch_paths_from_directory(Arena *arena, String8 input_directory, String8 output_directory, SC_BatchPaths *out_paths) noexcept -> b8 {
+	DK_ASSERT(arena != nullptr && out_paths != nullptr);
+
+	if (!os_directory_create(output_directory)) {
+		(void)std::fprintf(stderr, "Error: Failed to create output directory: %s\n", reinterpret_cast<char const *>(output_directory.data));
+		return false;
+	}
+	String8List const files = os_directory_list_files(arena, input_directory);
+	if (files.node_count == 0) {
+		(void)std::fprintf(stderr, "Error: No files in %s\n", reinterpret_cast<char const *>(input_directory.data));
+		return false;
+	}
+
+	sc_batch_paths_alloc(arena, files.node_count, out_paths);
+	for (String8Node const *node = files.first; node != nullptr; node = node->next) {
+		String8 const input_path = str8f(
+			arena, "%.*s/%.*s",
+			static_cast<int>(input_directory.size), input_directory.data,
+			static_cast<int>(node->string.size), node->string.data
+		);
+		sc_batch_paths_push(arena, out_paths, input_path, output_directory);
+	}
+	return true;
+}
+
+auto dk::sc_batch_paths_from_list(Arena *arena, String8 list_path, String8 output_directory, SC_BatchPaths *out_paths) noexcept -> b8 {
+	DK_ASSERT(arena != nullptr && out_paths != nullptr);
+
+	OS_Handle const file = os_file_open(list_path, OS_ACCESS_FLAG_READ);
+	OS_FileMap const map = os_file_map(file);
+	os_file_close(file);
+	if (map.data == nullptr) {
+		(void)std::fprintf(stderr, "Error: Failed to read image list: %s\n", reinterpret_cast<char const *>(list_path.data));
+		return false;
+	}
+	if (!os_directory_create(output_directory)) {
+		(void)std::fprintf(stderr, "Error: Failed to create output directory: %s\n", reinterpret_cast<char const *>(output_directory.data));
+		os_file_unmap(map);
+		return false;
+	}
+
+	ScratchArena const scratch = arena_scratch_begin(tc_get_scratch(&arena, 1));
+	String8 const line_ends[] = { str8_literal("\n"), str8_literal("\r") };
+	String8List const lines = str8_list_split(
+		scratch.arena,
+		{ .data = map.data, .size = map.size },
+		line_ends,
+		array_size(line_ends)
+	);
+	sc_batch_paths_alloc(arena, lines.node_count, out_paths);
+	for (String8Node const *node = lines.first; node != nullptr; node = node->next) {
+		if (node->string.size > 0) {
+			sc_batch_paths_push(arena, out_paths, node->string, output_directory);
+		}
+	}
+	arena_scratch_end(scratch);
+	os_file_unmap(map);
+
+	if (out_paths->count == 0) {
+		(void)std::fprintf(stderr, "Error: No images listed in %s\n", reinterpret_cast<char const *>(list_path.data));
+		return false;
+	}
+	return sc_batch_paths_unique(out_paths);
+}
+
+auto dk::sc_batch_run_throughput(Arena *arena, SC_ThroughputParams const *params) noexcept -> b8 {
+	DK_ASSERT(arena != nullptr && params != nullptr && params->paths.count > 0);
+
+	JobPool *pool = job_pool_alloc(glm::clamp(params->worker_count, 1u, params->paths.count));
+	u32 const worker_count = pool->worker_count;
+	SC_Throughput throughput = {};
+	throughput.params = params;
+	throughput.images = arena_push_type_array<SC_ThroughputImage>(arena, params->paths.count);
+	throughput.workers = arena_push_type_array<SC_ThroughputWorker>(arena, worker_count);
+
+	{
+		DK_PROFILE_SCOPE("image_info");
+		job_pool_run(pool, sc_throughput_info, &throughput);
+		std::stable_sort(
+			throughput.images,
+			throughput.images + params->paths.count,
+			[](SC_ThroughputImage const &a, SC_ThroughputImage const &b) { return a.pixel_count > b.pixel_count; }
+		);
+	}
+
+	u64 const start_time_us = os_now_microseconds();
+	job_pool_run(pool, sc_throughput_worker, &throughput);
+	u64 const elapsed_us = os_now_microseconds() - start_time_us;
+	job_pool_release(pool);
+
+	u64 busy_us = 0;
+	for (u32 i = 0; i < worker_count; ++i) {
+		busy_us += throughput.workers[i].busy_us;
+		if (throughput.workers[i].carver.arena != nullptr) {
+			sc_cpu_carver_release(&throughput.workers[i].carver);
+		}
+	}
+
+	Arena *conflicts[] = { arena };
+	ScratchArena const scratch = arena_scratch_begin(tc_get_scratch(conflicts, 1));
+	u32 const image_count = params->paths.count;
+	u64 *latencies_us = arena_push_type_array<u64>(scratch.arena, image_count);
+	u32 failed_count = 0;
+	for (u32 i = 0; i < image_count; ++i) {
+		latencies_us[i] = throughput.images[i].latency_us;
+		failed_count += throughput.images[i].failed ? 1 : 0;
+	}
+	std::sort(latencies_us, latencies_us + image_count);
+
+	f64 const elapsed_s = static_cast<f64>(elapsed_us) / 1000000.0;
+	std::printf(
+		"%u images (%u failed) on %u workers in %.2f s, %.2f images/s\n"
+		"Latency: p50 %.2f ms, p90 %.2f ms, p99 %.2f ms, max %.2f ms\n"
+		"Core utilization: %.1f%%\n",
+		image_count, failed_count, worker_count, elapsed_s,
+		elapsed_s > 0.0 ? static_cast<f64>(image_count) / elapsed_s : 0.0,
+		sc_batch_percentile_ms(latencies_us, image_count, 0.50),
+		sc_batch_percentile_ms(latencies_us, image_count, 0.90),
+		sc_batch_percentile_ms(latencies_us, image_count, 0.99),
+		static_cast<f64>(latencies_us[image_count - 1]) / 1000.0,
+		elapsed_us > 0 ? 100.0 * static_cast<f64>(busy_us) / (static_cast<f64>(elapsed_us) * worker_count) : 0.0
+	);
+	arena_scratch_end(scratch);
+	return failed_count == 0;
+}
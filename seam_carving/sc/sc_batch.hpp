@@ -0,0 +1,41 @@
+/*
+ * Copyright (C) 2025 Koh Swee Teck Dedrick.
+ * Licensed under the Apache License, Version 2.0 (http://www.apache.org/licenses/LICENSE-2.0)
+ */
+
+#pragma once
+
+#include "base/base_arena.hpp"
+#include "base/base_strings.hpp"
+#include "base/base_types.hpp"
+
+namespace dk {
+	/// Input and output path of every image in a batch.
+	struct SC_BatchPaths {
+		String8 *input_paths;
+		String8 *output_paths;
+		u32 count;
+	};
+
+	struct SC_ThroughputParams {
+		SC_BatchPaths paths;
+		s32 target_width; ///< 0 keeps the original width.
+		s32 target_height; ///< 0 keeps the original height.
+		u32 worker_count;
+		s32 png_level;
+	};
+
+	/// Every file in `input_directory`, written to `output_directory` (created if needed) under the same name.
+	/// Errors are printed to stderr.
+	auto sc_batch_paths_from_directory(Arena *arena, String8 input_directory, String8 output_directory, SC_BatchPaths *out_paths) noexcept -> b8;
+
+	/// Every non-empty line of the text file at `list_path`, written to `output_directory` under its file name.
+	/// Fails when two listed files share a file name. Errors are printed to stderr.
+	auto sc_batch_paths_from_list(Arena *arena, String8 list_path, String8 output_directory, SC_BatchPaths *out_paths) noexcept -> b8;
+
+	// NOTE(Dedrick): Carves whole images on the single-threaded CPU engine, one image per worker.
+	// Needs no GPU. Each worker has its own carver and scratch arenas, they only share the index
+	// of the next image. Images are handed out largest first so no big one is left for the end.
+	/// Prints images/sec, latency percentiles and core utilization. False if any image failed.
+	auto sc_batch_run_throughput(Arena *arena, SC_ThroughputParams const *params) noexcept -> b8;
+}
@@ -0,0 +1,910 @@
+/*
+ * Copyright (C) 2025 Koh Swee Teck Dedrick.
+ * Licensed under the Apache License, Version 2.0 (http://www.apache.org/licenses/LICENSE-2.0)
+ */
+
+#include "sc_carve.hpp"
+
+#include "base/base_assert.h"
+#include "base/base_thread_context.hpp"
+#include "base/base_utils.hpp"
+#include "sc/sc_assets.hpp"
+#include "sc/sc_autotune.hpp"
+#include "sc/sc_color.hpp"
+#include "sc/sc_opengl.hpp"
+#include "sc/sc_shader_cache.hpp"
+
+#include <bit>
+
+namespace {
+	using namespace dk;
+
+	auto sc_coarse_texture_size(s32 max_texture_size) noexcept -> s32 {
+		return (max_texture_size + 1) / 2;
+	}
+
+	auto sc_kernel_program(SC_GpuResource const *gpu, SC_ShaderStage stage, SC_Axis axis) noexcept -> GLuint {
+		SC_ShaderVariant const variant = {
+			.stage = stage,
+			.axis = static_cast<s32>(axis),
+			.workgroup_size = stage == SC_ShaderStage::COST ? gpu->kernels.cost_size : gpu->kernels.reduction_size,
+			.tile_width = gpu->kernels.tile_width,
+			.tile_height = gpu->kernels.tile_height
+		};
+		return sc_shader_cache_variant(gpu->shader_cache, &variant);
+	}
+
+	/// One invocation per pixel of a `width` x `height` region.
+	auto sc_dispatch_tiles(SC_GpuResource const *gpu, s32 width, s32 height) noexcept -> void {
+		s32 const tile_width = gpu->kernels.tile_width;
+		s32 const tile_height = gpu->kernels.tile_height;
+		glDispatchCompute((width + tile_width - 1) / tile_width, (height + tile_height - 1) / tile_height, 1);
+	}
+
+	auto sc_kernel_programs_fetch(SC_GpuResource *gpu) noexcept -> void {
+		gpu->prog_srgb_to_linear = sc_kernel_program(gpu, SC_ShaderStage::SRGB_TO_LINEAR, SC_AXIS_VERTICAL);
+		gpu->prog_linear_to_srgb = sc_kernel_program(gpu, SC_ShaderStage::LINEAR_TO_SRGB, SC_AXIS_VERTICAL);
+		gpu->prog_sobel = sc_kernel_program(gpu, SC_ShaderStage::SOBEL, SC_AXIS_VERTICAL);
+		gpu->prog_sobel_index_map = sc_kernel_program(gpu, SC_ShaderStage::SOBEL_INDEX_MAP, SC_AXIS_VERTICAL);
+		gpu->prog_index_map_insert = sc_kernel_program(gpu, SC_ShaderStage::INDEX_MAP_INSERT, SC_AXIS_VERTICAL);
+		gpu->prog_downsample = sc_kernel_program(gpu, SC_ShaderStage::DOWNSAMPLE, SC_AXIS_VERTICAL);
+
+		// NOTE(Dedrick): Seam programs are only submitted once their axis is first carved, see sc_carver_seam_passes.
+		for (b8 &created : gpu->seam_passes_created) {
+			created = false;
+		}
+	}
+
+	auto sc_gpu_alloc(SC_GpuResource *gpu, s32 max_texture_size, SC_ShaderCache *shader_cache) noexcept -> void {
+		glCreateVertexArrays(1, &gpu->empty_vao);
+		glCreateQueries(GL_TIME_ELAPSED, static_cast<GLsizei>(array_size(gpu->time_queries)), gpu->time_queries);
+		for (b8 &in_flight : gpu->time_queries_in_flight) {
+			in_flight = false;
+		}
+		gl_profiler_init(&gpu->profiler);
+
+		gpu->ubo_display = gl_buffer_create(sizeof(SC_DisplayParams), GL_DYNAMIC_STORAGE_BIT, nullptr);
+		gpu->ubo_carve = gl_buffer_create(sizeof(SC_CarveParams), GL_DYNAMIC_STORAGE_BIT, nullptr);
+		gpu->ubo_resample = gl_buffer_create(sizeof(SC_ResampleParams), GL_DYNAMIC_STORAGE_BIT, nullptr);
+		gpu->ubo_band = gl_buffer_create(sizeof(SC_BandParams), GL_DYNAMIC_STORAGE_BIT, nullptr);
+		gpu->ubo_index_map = gl_buffer_create(sizeof(SC_IndexMapParams), GL_DYNAMIC_STORAGE_BIT, nullptr);
+
+		gpu->ssbo_cost = gl_buffer_create(static_cast<u64>(max_texture_size) * max_texture_size * sizeof(f32), 0, nullptr);
+		gpu->ssbo_seam = gl_buffer_create(static_cast<u64>(max_texture_size) * SC_MAX_SEAMS_PER_PASS * sizeof(s32), 0, nullptr);
+		gpu->ssbo_seam_guide = gl_buffer_create(static_cast<u64>(max_texture_size) * sizeof(s32), 0, nullptr);
+		gpu->ssbo_min_index = gl_buffer_create(static_cast<u64>(max_texture_size) * sizeof(uvec2), 0, nullptr);
+		gpu->ssbo_srgb_table = gl_buffer_create(256 * sizeof(u32), 0, sc_color_linear_to_srgb_table());
+		gpu->ssbo_removed[0] = gl_buffer_create(static_cast<u64>(max_texture_size) * SC_LAZY_MAX_REMOVED * sizeof(s32), 0, nullptr);
+		gpu->ssbo_removed[1] = gl_buffer_create(static_cast<u64>(max_texture_size) * SC_LAZY_MAX_REMOVED * sizeof(s32), 0, nullptr);
+
+		s32 const coarse_size = sc_coarse_texture_size(max_texture_size);
+		gpu->tex_scratch[0] = gl_texture_create(GL_RGBA8, max_texture_size, max_texture_size);
+		gpu->tex_scratch[1] = gl_texture_create(GL_RGBA8, max_texture_size, max_texture_size);
+		gpu->tex_original = gl_texture_create(GL_SRGB8_ALPHA8, max_texture_size, max_texture_size);
+		gpu->tex_energy = gl_texture_create(GL_R32F, max_texture_size, max_texture_size);
+		gpu->tex_coarse[0] = gl_texture_create(GL_RGBA8, coarse_size, coarse_size);
+		gpu->tex_coarse[1] = gl_texture_create(GL_RGBA8, coarse_size, coarse_size);
+		gpu->tex_energy_coarse = gl_texture_create(GL_R32F, coarse_size, coarse_size);
+
+		// NOTE(Dedrick): Compute programs are variants owned by the cache, only the display program is ours.
+		gpu->shader_cache = shader_cache;
+		gpu->kernels = sc_kernel_config_default();
+		sc_kernel_profile_load(shader_cache, &gpu->kernels);
+		ScratchArena const scratch = arena_scratch_begin(tc_get_scratch(nullptr, 0));
+		gpu->prog_display = sc_shader_cache_program(shader_cache, vs_display, sc_display_fragment_source(scratch.arena));
+		arena_scratch_end(scratch);
+		sc_kernel_programs_fetch(gpu);
+	}
+
+	auto sc_seam_passes_create(SC_GpuResource *gpu, SC_Axis axis) noexcept -> void {
+		SC_SeamPassShaders *passes = &gpu->seam_passes[static_cast<u32>(axis)];
+		passes->prog_cost = sc_kernel_program(gpu, SC_ShaderStage::COST, axis);
+		passes->prog_find_min_local = sc_kernel_program(gpu, SC_ShaderStage::FIND_MIN_LOCAL, axis);
+		passes->prog_find_min_global = sc_kernel_program(gpu, SC_ShaderStage::FIND_MIN_GLOBAL, axis);
+		passes->prog_backtrace = sc_kernel_program(gpu, SC_ShaderStage::BACKTRACE, axis);
+		passes->prog_remove_seam = sc_kernel_program(gpu, SC_ShaderStage::REMOVE_SEAM, axis);
+		passes->prog_band_seam = sc_kernel_program(gpu, SC_ShaderStage::BAND_SEAM, axis);
+		passes->prog_find_min_k = sc_kernel_program(gpu, SC_ShaderStage::FIND_MIN_K, axis);
+		passes->prog_backtrace_k = sc_kernel_program(gpu, SC_ShaderStage::BACKTRACE_K, axis);
+		passes->prog_compact = sc_kernel_program(gpu, SC_ShaderStage::COMPACT, axis);
+		gpu->seam_passes_created[static_cast<u32>(axis)] = true;
+	}
+
+	auto sc_gpu_release(SC_GpuResource *gpu) noexcept -> void {
+		// NOTE(Dedrick): The display program may still be compiling, the cache would check it after it is gone.
+		sc_shader_cache_poll(gpu->shader_cache, true);
+		gl_program_destroy(gpu->prog_display);
+
+		gl_texture_destroy(gpu->tex_energy_coarse);
+		gl_texture_destroy(gpu->tex_coarse[1]);
+		gl_texture_destroy(gpu->tex_coarse[0]);
+		gl_texture_destroy(gpu->tex_energy);
+		gl_texture_destroy(gpu->tex_original);
+		gl_texture_destroy(gpu->tex_scratch[1]);
+		gl_texture_destroy(gpu->tex_scratch[0]);
+
+		gl_buffer_destroy(gpu->ssbo_removed[1]);
+		gl_buffer_destroy(gpu->ssbo_removed[0]);
+		gl_buffer_destroy(gpu->ssbo_srgb_table);
+		gl_buffer_destroy(gpu->ssbo_min_index);
+		gl_buffer_destroy(gpu->ssbo_seam_guide);
+		gl_buffer_destroy(gpu->ssbo_seam);
+		gl_buffer_destroy(gpu->ssbo_cost);
+
+		gl_buffer_destroy(gpu->ubo_index_map);
+		gl_buffer_destroy(gpu->ubo_band);
+		gl_buffer_destroy(gpu->ubo_resample);
+		gl_buffer_destroy(gpu->ubo_carve);
+		gl_buffer_destroy(gpu->ubo_display);
+
+		gl_profiler_release(&gpu->profiler);
+		glDeleteQueries(static_cast<GLsizei>(array_size(gpu->time_queries)), gpu->time_queries);
+		glDeleteVertexArrays(1, &gpu->empty_vao);
+	}
+
+	auto sc_upload_carve_params(
+		SC_GpuResource *gpu,
+		ivec2 size,
+		ivec2 texture_size,
+		s32 current_iteration,
+		s32 seam_count
+	) noexcept -> void {
+		SC_CarveParams const params = {
+			.current_size = size,
+			.texture_size = texture_size,
+			.current_iteration = current_iteration,
+			.seam_count = seam_count
+		};
+		glNamedBufferSubData(gpu->ubo_carve, 0, sizeof(SC_CarveParams), &params);
+	}
+
+	auto sc_update_carve_params(SC_Carver *carver, s32 current_iteration) noexcept -> void {
+		sc_upload_carve_params(
+			&carver->gpu,
+			{ carver->current_width, carver->current_height },
+			{ carver->max_texture_size, carver->max_texture_size },
+			current_iteration,
+			1
+		);
+	}
+
+	/// Box-filters the current image by `proxy_scale` into the proxy ping-pong pair.
+	auto sc_build_proxy(SC_Carver *carver) noexcept -> void {
+		GL_PROFILE_SCOPE(&carver->gpu.profiler, "build_proxy");
+		s32 const scale = carver->proxy_scale;
+		ivec2 const proxy_size = ivec2(carver->current_width, carver->current_height) / scale;
+		if (proxy_size.x < 2 || proxy_size.y < 2) {
+			carver->proxy_width = 0;
+			carver->proxy_height = 0;
+			return;
+		}
+
+		SC_ResampleParams const params = {
+			.src_size = { carver->current_width, carver->current_height },
+			.dst_size = proxy_size,
+			.scale = scale
+		};
+		glUseProgram(carver->gpu.prog_downsample);
+		glNamedBufferSubData(carver->gpu.ubo_resample, 0, sizeof(SC_ResampleParams), &params);
+		glBindBufferBase(GL_UNIFORM_BUFFER, 1, carver->gpu.ubo_resample);
+		glBindTextureUnit(0, carver->tex_src);
+		glBindImageTexture(0, carver->gpu.tex_coarse[0], 0, GL_FALSE, 0, GL_WRITE_ONLY, GL_RGBA8);
+		sc_dispatch_tiles(&carver->gpu, proxy_size.x, proxy_size.y);
+		glMemoryBarrier(GL_SHADER_IMAGE_ACCESS_BARRIER_BIT | GL_TEXTURE_FETCH_BARRIER_BIT);
+
+		carver->proxy_src = carver->gpu.tex_coarse[0];
+		carver->proxy_dst = carver->gpu.tex_coarse[1];
+		carver->proxy_width = proxy_size.x;
+		carver->proxy_height = proxy_size.y;
+	}
+
+	auto sc_compute_energy(
+		SC_Carver *carver,
+		GLuint tex_image,
+		GLuint tex_energy,
+		ivec2 size,
+		ivec2 texture_size
+	) noexcept -> void {
+		glUseProgram(carver->gpu.prog_sobel);
+		sc_upload_carve_params(&carver->gpu, size, texture_size, 0, 1);
+		glBindBufferBase(GL_UNIFORM_BUFFER, 0, carver->gpu.ubo_carve);
+		glBindTextureUnit(0, tex_image);
+		glBindImageTexture(0, tex_energy, 0, GL_FALSE, 0, GL_WRITE_ONLY, GL_R32F);
+		sc_dispatch_tiles(&carver->gpu, size.x, size.y);
+		glMemoryBarrier(GL_SHADER_IMAGE_ACCESS_BARRIER_BIT | GL_TEXTURE_FETCH_BARRIER_BIT);
+	}
+
+	auto sc_remove_seam_from(
+		SC_Carver *carver,
+		SC_Axis axis,
+		GLuint tex_in,
+		GLuint tex_out,
+		ivec2 size,
+		ivec2 texture_size
+	) noexcept -> void {
+		SC_SeamPassShaders const *passes = sc_carver_seam_passes(carver, axis);
+
+		// NOTE(Dedrick): Remove seam.
+		glUseProgram(passes->prog_remove_seam);
+		sc_upload_carve_params(&carver->gpu, size, texture_size, 0, 1);
+		glBindBufferBase(GL_UNIFORM_BUFFER, 0, carver->gpu.ubo_carve);
+		glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 0, carver->gpu.ssbo_seam);
+		glBindImageTexture(0, tex_in, 0, GL_FALSE, 0, GL_READ_ONLY, GL_RGBA8);
+		glBindImageTexture(1, tex_out, 0, GL_FALSE, 0, GL_WRITE_ONLY, GL_RGBA8);
+
+		s32 const dispatch_w = axis == SC_AXIS_VERTICAL ? size.x - 1 : size.x;
+		s32 const dispatch_h = axis == SC_AXIS_VERTICAL ? size.y : size.y - 1;
+		sc_dispatch_tiles(&carver->gpu, dispatch_w, dispatch_h);
+		glMemoryBarrier(GL_SHADER_IMAGE_ACCESS_BARRIER_BIT);
+	}
+
+	/// Removes `removed_count` pixels from every row/col of `tex_in` in one pass.
+	/// `ssbo_removed` holds `removed_count` sorted indices per row/col, so every
+	/// pixel moves exactly once no matter how many seams are removed.
+	auto sc_compact_from(
+		SC_Carver *carver,
+		SC_Axis axis,
+		GLuint ssbo_removed,
+		GLuint tex_in,
+		GLuint tex_out,
+		ivec2 size,
+		ivec2 texture_size,
+		s32 removed_count
+	) noexcept -> void {
+		SC_SeamPassShaders const *passes = sc_carver_seam_passes(carver, axis);
+
+		glUseProgram(passes->prog_compact);
+		sc_upload_carve_params(&carver->gpu, size, texture_size, 0, removed_count);
+		glBindBufferBase(GL_UNIFORM_BUFFER, 0, carver->gpu.ubo_carve);
+		glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 0, ssbo_removed);
+		glBindImageTexture(0, tex_in, 0, GL_FALSE, 0, GL_READ_ONLY, GL_RGBA8);
+		glBindImageTexture(1, tex_out, 0, GL_FALSE, 0, GL_WRITE_ONLY, GL_RGBA8);
+
+		s32 const dispatch_w = axis == SC_AXIS_VERTICAL ? size.x - removed_count : size.x;
+		s32 const dispatch_h = axis == SC_AXIS_VERTICAL ? size.y : size.y - removed_count;
+		sc_dispatch_tiles(&carver->gpu, dispatch_w, dispatch_h);
+		glMemoryBarrier(GL_SHADER_IMAGE_ACCESS_BARRIER_BIT);
+	}
+
+	auto sc_find_seam_exact(SC_Carver *carver, SC_Axis axis) noexcept -> void {
+		ivec2 const size = { carver->current_width, carver->current_height };
+		ivec2 const texture_size = { carver->max_texture_size, carver->max_texture_size };
+
+		sc_compute_current_energy(carver);
+		sc_accumulate_cost(carver, axis, carver->gpu.tex_energy, size, texture_size);
+		sc_backtrace_seam(carver, axis, size, texture_size);
+	}
+
+	/// Runs the exact DP on the coarsest pyramid level, then refines the seam
+	/// level by level inside a band of +/- `band_radius` around the upsampled seam.
+	auto sc_find_seam_pyramid(SC_Carver *carver, SC_Axis axis) noexcept -> void {
+		GL_PROFILE_SCOPE(&carver->gpu.profiler, "find_seam_pyramid");
+		ivec2 level_sizes[SC_PYRAMID_MAX_LEVELS];
+		level_sizes[0] = { carver->current_width, carver->current_height };
+		s32 level_count = 1;
+		for (; level_count < carver->pyramid_levels; ++level_count) {
+			ivec2 const next_size = level_sizes[level_count - 1] / 2;
+			if (next_size.x < SC_PYRAMID_MIN_SIZE || next_size.y < SC_PYRAMID_MIN_SIZE) {
+				break;
+			}
+			level_sizes[level_count] = next_size;
+		}
+
+		if (level_count < 2) {
+			sc_find_seam_exact(carver, axis);
+			return;
+		}
+
+		s32 const coarse_size = sc_coarse_texture_size(carver->max_texture_size);
+		ivec2 const full_texture_size = { carver->max_texture_size, carver->max_texture_size };
+		ivec2 const coarse_texture_size = { coarse_size, coarse_size };
+
+		// NOTE(Dedrick): Build the coarse levels from the current image.
+		glUseProgram(carver->gpu.prog_downsample);
+		glBindBufferBase(GL_UNIFORM_BUFFER, 1, carver->gpu.ubo_resample);
+		for (s32 level = 1; level < level_count; ++level) {
+			SC_ResampleParams const params = {
+				.src_size = level_sizes[level - 1],
+				.dst_size = level_sizes[level],
+				.scale = 2
+			};
+			glNamedBufferSubData(carver->gpu.ubo_resample, 0, sizeof(SC_ResampleParams), &params);
+			glBindTextureUnit(0, level == 1 ? carver->tex_src : carver->gpu.tex_coarse[level - 2]);
+			glBindImageTexture(0, carver->gpu.tex_coarse[level - 1], 0, GL_FALSE, 0, GL_WRITE_ONLY, GL_RGBA8);
+			sc_dispatch_tiles(&carver->gpu, level_sizes[level].x, level_sizes[level].y);
+			glMemoryBarrier(GL_SHADER_IMAGE_ACCESS_BARRIER_BIT | GL_TEXTURE_FETCH_BARRIER_BIT);
+		}
+
+		// NOTE(Dedrick): Exact seam on the coarsest level.
+		s32 const coarsest = level_count - 1;
+		sc_compute_energy(
+			carver,
+			carver->gpu.tex_coarse[coarsest - 1],
+			carver->gpu.tex_energy_coarse,
+			level_sizes[coarsest],
+			coarse_texture_size
+		);
+		sc_accumulate_cost(carver, axis, carver->gpu.tex_energy_coarse, level_sizes[coarsest], coarse_texture_size);
+		sc_backtrace_seam(carver, axis, level_sizes[coarsest], coarse_texture_size);
+
+		// NOTE(Dedrick): Narrow-band refinement towards the full resolution level.
+		SC_SeamPassShaders const *passes = sc_carver_seam_passes(carver, axis);
+		glUseProgram(passes->prog_band_seam);
+		glBindBufferBase(GL_UNIFORM_BUFFER, 1, carver->gpu.ubo_band);
+		glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 0, carver->gpu.ssbo_cost);
+		glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 1, carver->gpu.ssbo_seam);
+		glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 2, carver->gpu.ssbo_min_index);
+		glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 3, carver->gpu.ssbo_seam_guide);
+
+		s32 const band_radius = glm::clamp(carver->band_radius, 1, sc_band_max_radius(&carver->gpu.kernels));
+		for (s32 level = coarsest - 1; level >= 0; --level) {
+			ivec2 const guide_size = level_sizes[level + 1];
+			s32 const guide_count = axis == SC_AXIS_VERTICAL ? guide_size.y : guide_size.x;
+
+			glMemoryBarrier(GL_BUFFER_UPDATE_BARRIER_BIT);
+			glCopyNamedBufferSubData(
+				carver->gpu.ssbo_seam,
+				carver->gpu.ssbo_seam_guide,
+				0, 0,
+				static_cast<GLsizeiptr>(guide_count) * static_cast<GLsizeiptr>(sizeof(s32))
+			);
+
+			SC_BandParams const params = {
+				.size = level_sizes[level],
+				.texture_size = level == 0 ? full_texture_size : coarse_texture_size,
+				.guide_size = guide_size,
+				.guide_scale = 2,
+				.band_offset = -band_radius,
+				.band_width = 2 * band_radius + 2, // NOTE(Dedrick): Both fine pixels of the coarse pixel.
+				.interpolate_guide = 1
+			};
+			glNamedBufferSubData(carver->gpu.ubo_band, 0, sizeof(SC_BandParams), &params);
+			glBindTextureUnit(0, level == 0 ? carver->tex_src : carver->gpu.tex_coarse[level - 1]);
+			glDispatchCompute(1, 1, 1);
+			glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT);
+		}
+	}
+
+	/// Compares the cost of the seam just found against the exact seam cost.
+	/// Only the reduction of the exact search is run, `ssbo_seam` is left untouched.
+	auto sc_measure_seam_quality(SC_Carver *carver, SC_Axis axis) noexcept -> void {
+		uvec2 found_min{};
+		glGetNamedBufferSubData(carver->gpu.ssbo_min_index, 0, sizeof(uvec2), &found_min);
+
+		ivec2 const size = { carver->current_width, carver->current_height };
+		ivec2 const texture_size = { carver->max_texture_size, carver->max_texture_size };
+		sc_compute_energy(carver, carver->tex_src, carver->gpu.tex_energy, size, texture_size);
+		sc_accumulate_cost(carver, axis, carver->gpu.tex_energy, size, texture_size);
+
+		uvec2 exact_min{};
+		glGetNamedBufferSubData(carver->gpu.ssbo_min_index, 0, sizeof(uvec2), &exact_min);
+
+		f32 const found_cost = std::bit_cast<f32>(found_min.x);
+		f32 const exact_cost = std::bit_cast<f32>(exact_min.x);
+		f32 const ratio = exact_cost > 0.0f ? found_cost / exact_cost : 1.0f;
+		carver->seam_cost_ratio_sum += ratio;
+		carver->seam_cost_ratio_max = glm::max(carver->seam_cost_ratio_max, ratio);
+		carver->seam_cost_ratio_count += 1;
+	}
+
+	/// Extracts the `seam_count` cheapest seams from one cost map into `ssbo_seam`.
+	/// Seams are kept in index order on every row/col, so they never cross.
+	auto sc_find_seams_batch(SC_Carver *carver, SC_Axis axis, s32 seam_count) noexcept -> void {
+		GL_PROFILE_SCOPE(&carver->gpu.profiler, "find_seams_batch");
+		ivec2 const size = { carver->current_width, carver->current_height };
+		ivec2 const texture_size = { carver->max_texture_size, carver->max_texture_size };
+		s32 const minor_dim = axis == SC_AXIS_VERTICAL ? size.y : size.x;
+		SC_SeamPassShaders const *passes = sc_carver_seam_passes(carver, axis);
+
+		sc_compute_current_energy(carver);
+		sc_fill_cost_map(carver, axis, carver->gpu.tex_energy, size, texture_size);
+
+		// NOTE(Dedrick): k cheapest seam ends, sorted by index.
+		glUseProgram(passes->prog_find_min_k);
+		sc_upload_carve_params(&carver->gpu, size, texture_size, 0, seam_count);
+		glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 0, carver->gpu.ssbo_cost);
+		glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 2, carver->gpu.ssbo_min_index);
+		glDispatchCompute(1, 1, 1);
+		glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT);
+
+		// NOTE(Dedrick): Back-trace all seams together, one row/col per dispatch.
+		glUseProgram(passes->prog_backtrace_k);
+		glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 1, carver->gpu.ssbo_seam);
+		for (s32 i = minor_dim - 1; i >= 0; --i) {
+			sc_upload_carve_params(&carver->gpu, size, texture_size, i, seam_count);
+			glDispatchCompute(1, 1, 1);
+			glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT);
+		}
+	}
+
+	/// Removes the `seam_count` seams in `ssbo_seam` with a single compaction pass.
+	auto sc_remove_seams_batch(SC_Carver *carver, SC_Axis axis, s32 seam_count) noexcept -> void {
+		GL_PROFILE_SCOPE(&carver->gpu.profiler, "remove_batch");
+		ivec2 const size = { carver->current_width, carver->current_height };
+		ivec2 const texture_size = { carver->max_texture_size, carver->max_texture_size };
+		sc_compact_from(carver, axis, carver->gpu.ssbo_seam, carver->tex_src, carver->tex_dst, size, texture_size, seam_count);
+
+		swap(&carver->tex_src, &carver->tex_dst);
+		if (axis == SC_AXIS_VERTICAL) {
+			carver->current_width -= seam_count;
+		} else {
+			carver->current_height -= seam_count;
+		}
+	}
+
+	/// Records the `seam_count` seams in `ssbo_seam` in the index map without moving any pixel.
+	auto sc_remove_seams_lazy(SC_Carver *carver, SC_Axis axis, s32 seam_count) noexcept -> void {
+		DK_ASSERT(carver->removed_count == 0 || carver->removed_axis == axis);
+		DK_ASSERT(carver->removed_count + seam_count <= SC_LAZY_MAX_REMOVED);
+		GL_PROFILE_SCOPE(&carver->gpu.profiler, "remove_lazy");
+
+		ivec2 const size = { carver->current_width, carver->current_height };
+		s32 const minor_dim = axis == SC_AXIS_VERTICAL ? size.y : size.x;
+
+		carver->removed_axis = axis;
+		glUseProgram(carver->gpu.prog_index_map_insert);
+		sc_upload_carve_params(&carver->gpu, size, { carver->max_texture_size, carver->max_texture_size }, 0, seam_count);
+		sc_upload_index_map_params(carver);
+		glBindBufferBase(GL_UNIFORM_BUFFER, 0, carver->gpu.ubo_carve);
+		glBindBufferBase(GL_UNIFORM_BUFFER, 2, carver->gpu.ubo_index_map);
+		glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 4, carver->removed_src);
+		glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 1, carver->removed_dst);
+		glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 2, carver->gpu.ssbo_seam);
+		glDispatchCompute((minor_dim + 63) / 64, 1, 1);
+		glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT);
+
+		swap(&carver->removed_src, &carver->removed_dst);
+		carver->removed_count += seam_count;
+		if (axis == SC_AXIS_VERTICAL) {
+			carver->current_width -= seam_count;
+		} else {
+			carver->current_height -= seam_count;
+		}
+	}
+
+	/// Carves one seam on the proxy and widens it into up to `proxy_scale` full
+	/// resolution seams, each picked per row among the pixels the proxy pixel covers.
+	/// The full resolution image is only read by the band DP and the removal passes.
+	auto sc_carve_seams_proxy(SC_Carver *carver, SC_Axis axis, s32 max_seams) noexcept -> s32 {
+		s32 const coarse_size = sc_coarse_texture_size(carver->max_texture_size);
+		ivec2 const coarse_texture_size = { coarse_size, coarse_size };
+		ivec2 const proxy_size = { carver->proxy_width, carver->proxy_height };
+		s32 const guide_count = axis == SC_AXIS_VERTICAL ? proxy_size.y : proxy_size.x;
+
+		// NOTE(Dedrick): Exact seam on the proxy, then remove it from the proxy too.
+		sc_compute_energy(carver, carver->proxy_src, carver->gpu.tex_energy_coarse, proxy_size, coarse_texture_size);
+		sc_accumulate_cost(carver, axis, carver->gpu.tex_energy_coarse, proxy_size, coarse_texture_size);
+		sc_backtrace_seam(carver, axis, proxy_size, coarse_texture_size);
+		sc_remove_seam_from(carver, axis, carver->proxy_src, carver->proxy_dst, proxy_size, coarse_texture_size);
+		swap(&carver->proxy_src, &carver->proxy_dst);
+		if (axis == SC_AXIS_VERTICAL) {
+			carver->proxy_width -= 1;
+		} else {
+			carver->proxy_height -= 1;
+		}
+
+		glMemoryBarrier(GL_BUFFER_UPDATE_BARRIER_BIT);
+		glCopyNamedBufferSubData(
+			carver->gpu.ssbo_seam,
+			carver->gpu.ssbo_seam_guide,
+			0, 0,
+			static_cast<GLsizeiptr>(guide_count) * static_cast<GLsizeiptr>(sizeof(s32))
+		);
+
+		// NOTE(Dedrick): Each full resolution seam removes one pixel per row from the
+		// covered block, so the band shrinks by one for every seam already taken out.
+		s32 const scale = carver->proxy_scale;
+		s32 const seam_count = glm::min(scale, max_seams);
+		SC_SeamPassShaders const *passes = sc_carver_seam_passes(carver, axis);
+		for (s32 i = 0; i < seam_count; ++i) {
+			SC_BandParams const params = {
+				.size = { carver->current_width, carver->current_height },
+				.texture_size = { carver->max_texture_size, carver->max_texture_size },
+				.guide_size = proxy_size,
+				.guide_scale = scale,
+				.band_offset = 0,
+				.band_width = scale - i,
+				.interpolate_guide = 0
+			};
+			glUseProgram(passes->prog_band_seam);
+			glNamedBufferSubData(carver->gpu.ubo_band, 0, sizeof(SC_BandParams), &params);
+			glBindBufferBase(GL_UNIFORM_BUFFER, 1, carver->gpu.ubo_band);
+			glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 0, carver->gpu.ssbo_cost);
+			glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 1, carver->gpu.ssbo_seam);
+			glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 2, carver->gpu.ssbo_min_index);
+			glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 3, carver->gpu.ssbo_seam_guide);
+			glBindTextureUnit(0, carver->tex_src);
+			glDispatchCompute(1, 1, 1);
+			glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT);
+
+			sc_remove_seam(carver, axis);
+		}
+		return seam_count;
+	}
+}
+
+auto dk::sc_carver_init(SC_Carver *carver, s32 max_texture_size, SC_ShaderCache *shader_cache) noexcept -> void {
+	sc_gpu_alloc(&carver->gpu, max_texture_size, shader_cache);
+
+	carver->max_texture_size = max_texture_size;
+	carver->tex_src = carver->gpu.tex_scratch[0];
+	carver->tex_dst = carver->gpu.tex_scratch[1];
+	carver->seam_search = SC_SeamSearch::EXACT;
+	carver->pyramid_levels = SC_PYRAMID_MAX_LEVELS;
+	carver->band_radius = 4;
+	carver->seams_per_pass = 1;
+	carver->last_seam_count = 1;
+	carver->lazy_threshold = SC_MAX_SEAMS_PER_PASS;
+	carver->removed_src = carver->gpu.ssbo_removed[0];
+	carver->removed_dst = carver->gpu.ssbo_removed[1];
+	carver->proxy_scale = 2;
+	carver->flags = SC_CARVE_FLAG_NONE;
+}
+
+auto dk::sc_carver_release(SC_Carver *carver) noexcept -> void {
+	sc_gpu_release(&carver->gpu);
+}
+
+auto dk::sc_carver_gpu_bytes(s32 max_texture_size) noexcept -> u64 {
+	u64 const size = static_cast<u64>(max_texture_size);
+	u64 const coarse_size = static_cast<u64>(sc_coarse_texture_size(max_texture_size));
+	u64 const texture_bytes =
+		size * size * 4 * 4 + // tex_scratch[2], tex_original, tex_energy
+		coarse_size * coarse_size * 4 * 3; // tex_coarse[2], tex_energy_coarse
+	u64 const buffer_bytes =
+		size * size * sizeof(f32) + // ssbo_cost
+		size * SC_MAX_SEAMS_PER_PASS * sizeof(s32) + // ssbo_seam
+		size * sizeof(s32) + // ssbo_seam_guide
+		size * sizeof(uvec2) + // ssbo_min_index
+		256 * sizeof(u32) + // ssbo_srgb_table
+		size * SC_LAZY_MAX_REMOVED * sizeof(s32) * 2; // ssbo_removed[2]
+	return texture_bytes + buffer_bytes;
+}
+
+auto dk::sc_kernel_config_default() noexcept -> SC_KernelConfig {
+	return {
+		.cost_size = 256,
+		.reduction_size = 256,
+		.tile_width = 8,
+		.tile_height = 8
+	};
+}
+
+auto dk::sc_carver_set_kernels(SC_Carver *carver, SC_KernelConfig const *kernels) noexcept -> void {
+	carver->gpu.kernels = *kernels;
+	sc_kernel_programs_fetch(&carver->gpu);
+}
+
+auto dk::sc_band_max_radius(SC_KernelConfig const *kernels) noexcept -> s32 {
+	return kernels->reduction_size / 2 - 1;
+}
+
+auto dk::sc_carver_load_image(SC_Carver *carver, u8 const *pixels, s32 width, s32 height) noexcept -> void {
+	DK_ASSERT(width <= carver->max_texture_size && height <= carver->max_texture_size);
+	GL_PROFILE_SCOPE(&carver->gpu.profiler, "upload");
+
+	glTextureSubImage2D(carver->gpu.tex_original, 0, 0, 0, width, height, GL_RGBA, GL_UNSIGNED_BYTE, pixels);
+	carver->original_width = width;
+	carver->original_height = height;
+	sc_carver_reset(carver);
+}
+
+auto dk::sc_carver_reset(SC_Carver *carver) noexcept -> void {
+	GL_PROFILE_SCOPE(&carver->gpu.profiler, "linearize");
+	carver->current_width = carver->original_width;
+	carver->current_height = carver->original_height;
+	carver->proxy_width = 0;
+	carver->proxy_height = 0;
+
+	glUseProgram(carver->gpu.prog_srgb_to_linear);
+	sc_update_carve_params(carver, 0);
+	glBindBufferBase(GL_UNIFORM_BUFFER, 0, carver->gpu.ubo_carve);
+	glBindTextureUnit(0, carver->gpu.tex_original);
+	glBindImageTexture(0, carver->gpu.tex_scratch[0], 0, GL_FALSE, 0, GL_WRITE_ONLY, GL_RGBA8);
+	sc_dispatch_tiles(&carver->gpu, carver->original_width, carver->original_height);
+	glMemoryBarrier(GL_SHADER_IMAGE_ACCESS_BARRIER_BIT | GL_TEXTURE_FETCH_BARRIER_BIT);
+
+	carver->tex_src = carver->gpu.tex_scratch[0];
+	carver->tex_dst = carver->gpu.tex_scratch[1];
+
+	constexpr s32 clear_value = -1;
+	glClearNamedBufferData(carver->gpu.ssbo_seam, GL_R32I, GL_RED_INTEGER, GL_INT, &clear_value);
+	carver->last_seam_count = 1;
+	carver->removed_count = 0;
+}
+
+auto dk::sc_carver_begin(SC_Carver *carver) noexcept -> void {
+	GL_PROFILE_SCOPE(&carver->gpu.profiler, "carve_begin");
+	carver->seam_cost_ratio_sum = 0.0;
+	carver->seam_cost_ratio_max = 0.0f;
+	carver->seam_cost_ratio_count = 0;
+
+	if ((carver->flags & SC_CARVE_FLAG_PROXY) != 0) {
+		sc_carver_materialize(carver);
+		sc_build_proxy(carver);
+	}
+}
+
+auto dk::sc_carver_seam_passes(SC_Carver *carver, SC_Axis axis) noexcept -> SC_SeamPassShaders const * {
+	if (!carver->gpu.seam_passes_created[static_cast<u32>(axis)]) {
+		sc_seam_passes_create(&carver->gpu, axis);
+	}
+	return &carver->gpu.seam_passes[static_cast<u32>(axis)];
+}
+
+auto dk::sc_carver_prepare_axis(SC_Carver *carver, SC_Axis axis) noexcept -> b8 {
+	SC_SeamPassShaders const *passes = sc_carver_seam_passes(carver, axis);
+	GLuint const programs[] = {
+		passes->prog_cost, passes->prog_find_min_local, passes->prog_find_min_global,
+		passes->prog_backtrace, passes->prog_remove_seam, passes->prog_band_seam,
+		passes->prog_find_min_k, passes->prog_backtrace_k, passes->prog_compact
+	};
+	for (GLuint const program : programs) {
+		if (sc_shader_cache_is_pending(carver->gpu.shader_cache, program)) {
+			return false;
+		}
+	}
+	return true;
+}
+
+auto dk::sc_carver_materialize(SC_Carver *carver) noexcept -> void {
+	GL_PROFILE_SCOPE(&carver->gpu.profiler, "materialize");
+	if (carver->removed_count == 0) {
+		return;
+	}
+
+	ivec2 source_size = { carver->current_width, carver->current_height };
+	if (carver->removed_axis == SC_AXIS_VERTICAL) {
+		source_size.x += carver->removed_count;
+	} else {
+		source_size.y += carver->removed_count;
+	}
+
+	sc_compact_from(
+		carver,
+		carver->removed_axis,
+		carver->removed_src,
+		carver->tex_src,
+		carver->tex_dst,
+		source_size,
+		{ carver->max_texture_size, carver->max_texture_size },
+		carver->removed_count
+	);
+	swap(&carver->tex_src, &carver->tex_dst);
+	carver->removed_count = 0;
+}
+
+auto dk::sc_carver_read_pixels_async(SC_Carver *carver, SC_Readback *readback) noexcept -> void {
+	DK_ASSERT(readback->fence == nullptr);
+	GL_PROFILE_SCOPE(&carver->gpu.profiler, "readback");
+	sc_carver_materialize(carver);
+
+	u64 const byte_count = static_cast<u64>(carver->current_width) * carver->current_height * 4;
+	if (byte_count > readback->capacity) {
+		sc_readback_release(readback);
+		// NOTE(Dedrick): Client storage asks for the buffer to live in host memory, the CPU is its only reader.
+		constexpr GLbitfield map_flags = GL_MAP_READ_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+		readback->buffer = gl_buffer_create(byte_count, map_flags | GL_CLIENT_STORAGE_BIT, nullptr);
+		readback->mapped = static_cast<u8 *>(glMapNamedBufferRange(readback->buffer, 0, static_cast<GLsizeiptr>(byte_count), map_flags));
+		readback->capacity = byte_count;
+	}
+	readback->width = carver->current_width;
+	readback->height = carver->current_height;
+
+	// NOTE(Dedrick): The encode pass writes straight into the mapped buffer, so the CPU gets
+	// file ready pixels and the save path has no conversion or flip left to do.
+	glUseProgram(carver->gpu.prog_linear_to_srgb);
+	sc_update_carve_params(carver, 0);
+	glBindBufferBase(GL_UNIFORM_BUFFER, 0, carver->gpu.ubo_carve);
+	glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 0, carver->gpu.ssbo_srgb_table);
+	glBindBufferRange(GL_SHADER_STORAGE_BUFFER, 1, readback->buffer, 0, static_cast<GLsizeiptr>(byte_count));
+	glBindImageTexture(0, carver->tex_src, 0, GL_FALSE, 0, GL_READ_ONLY, GL_RGBA8);
+	sc_dispatch_tiles(&carver->gpu, carver->current_width, carver->current_height);
+	glMemoryBarrier(GL_CLIENT_MAPPED_BUFFER_BARRIER_BIT);
+	readback->fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+	glFlush();
+}
+
+auto dk::sc_readback_poll(SC_Readback *readback, b8 wait) noexcept -> b8 {
+	if (readback->fence == nullptr) {
+		return true;
+	}
+
+	constexpr GLuint64 wait_timeout_ns = 1000000000;
+	GLenum status = GL_TIMEOUT_EXPIRED;
+	do {
+		status = glClientWaitSync(readback->fence, GL_SYNC_FLUSH_COMMANDS_BIT, wait ? wait_timeout_ns : 0);
+	} while (wait && status == GL_TIMEOUT_EXPIRED);
+	if (status == GL_TIMEOUT_EXPIRED) {
+		return false;
+	}
+
+	// NOTE(Dedrick): GL_WAIT_FAILED only happens on a lost context, nothing to wait for anymore.
+	glDeleteSync(readback->fence);
+	readback->fence = nullptr;
+	return true;
+}
+
+auto dk::sc_readback_release(SC_Readback *readback) noexcept -> void {
+	sc_readback_poll(readback, true);
+	if (readback->buffer != 0) {
+		gl_buffer_destroy(readback->buffer);
+	}
+	*readback = {};
+}
+
+auto dk::sc_upload_index_map_params(SC_Carver *carver) noexcept -> void {
+	SC_IndexMapParams const params = {
+		.removed_count = carver->removed_count,
+		.is_horizontal = carver->removed_axis == SC_AXIS_HORIZONTAL
+	};
+	glNamedBufferSubData(carver->gpu.ubo_index_map, 0, sizeof(SC_IndexMapParams), &params);
+}
+
+/// Energy of the current image, read through the index map while seams are only removed lazily.
+auto dk::sc_compute_current_energy(SC_Carver *carver) noexcept -> void {
+	GL_PROFILE_SCOPE(&carver->gpu.profiler, "energy");
+	ivec2 const size = { carver->current_width, carver->current_height };
+	ivec2 const texture_size = { carver->max_texture_size, carver->max_texture_size };
+	if (carver->removed_count == 0) {
+		sc_compute_energy(carver, carver->tex_src, carver->gpu.tex_energy, size, texture_size);
+		return;
+	}
+
+	glUseProgram(carver->gpu.prog_sobel_index_map);
+	sc_upload_carve_params(&carver->gpu, size, texture_size, 0, 1);
+	sc_upload_index_map_params(carver);
+	glBindBufferBase(GL_UNIFORM_BUFFER, 0, carver->gpu.ubo_carve);
+	glBindBufferBase(GL_UNIFORM_BUFFER, 2, carver->gpu.ubo_index_map);
+	glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 4, carver->removed_src);
+	glBindTextureUnit(0, carver->tex_src);
+	glBindImageTexture(0, carver->gpu.tex_energy, 0, GL_FALSE, 0, GL_WRITE_ONLY, GL_R32F);
+	sc_dispatch_tiles(&carver->gpu, size.x, size.y);
+	glMemoryBarrier(GL_SHADER_IMAGE_ACCESS_BARRIER_BIT | GL_TEXTURE_FETCH_BARRIER_BIT);
+}
+
+auto dk::sc_fill_cost_map(
+	SC_Carver *carver,
+	SC_Axis axis,
+	GLuint tex_energy,
+	ivec2 size,
+	ivec2 texture_size
+) noexcept -> void {
+	GL_PROFILE_SCOPE(&carver->gpu.profiler, "cost");
+	s32 const major_dim = axis == SC_AXIS_VERTICAL ? size.x : size.y;
+	s32 const minor_dim = axis == SC_AXIS_VERTICAL ? size.y : size.x;
+	s32 const group_count = (major_dim + carver->gpu.kernels.cost_size - 1) / carver->gpu.kernels.cost_size;
+	SC_SeamPassShaders const *passes = sc_carver_seam_passes(carver, axis);
+
+	glBindBufferBase(GL_UNIFORM_BUFFER, 0, carver->gpu.ubo_carve);
+	glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 0, carver->gpu.ssbo_cost);
+
+	// NOTE(Dedrick): Cost map (DP).
+	glUseProgram(passes->prog_cost);
+	glBindTextureUnit(1, tex_energy);
+	for (s32 i = 0; i < minor_dim; ++i) {
+		sc_upload_carve_params(&carver->gpu, size, texture_size, i, 1);
+		glDispatchCompute(group_count, 1, 1);
+		glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT);
+	}
+}
+
+/// Reduces the last row/column of the cost map so that
+/// `ssbo_min_index[0]` holds the (cost, index) of the cheapest seam end.
+auto dk::sc_find_min_seam_end(SC_Carver *carver, SC_Axis axis, ivec2 size, ivec2 texture_size) noexcept -> void {
+	GL_PROFILE_SCOPE(&carver->gpu.profiler, "find_min");
+	s32 const major_dim = axis == SC_AXIS_VERTICAL ? size.x : size.y;
+	SC_SeamPassShaders const *passes = sc_carver_seam_passes(carver, axis);
+
+	glBindBufferBase(GL_UNIFORM_BUFFER, 0, carver->gpu.ubo_carve);
+	glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 0, carver->gpu.ssbo_cost);
+	glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 2, carver->gpu.ssbo_min_index);
+
+	// NOTE(Dedrick): Find minimum seam (2-pass reduction).
+	s32 const num_groups = (major_dim + carver->gpu.kernels.reduction_size - 1) / carver->gpu.kernels.reduction_size;
+	glUseProgram(passes->prog_find_min_local);
+	sc_upload_carve_params(&carver->gpu, size, texture_size, 0, 1);
+	glDispatchCompute(num_groups, 1, 1);
+	glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT);
+
+	glUseProgram(passes->prog_find_min_global);
+	glDispatchCompute(1, 1, 1);
+	glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT);
+}
+
+auto dk::sc_accumulate_cost(
+	SC_Carver *carver,
+	SC_Axis axis,
+	GLuint tex_energy,
+	ivec2 size,
+	ivec2 texture_size
+) noexcept -> void {
+	sc_fill_cost_map(carver, axis, tex_energy, size, texture_size);
+	sc_find_min_seam_end(carver, axis, size, texture_size);
+}
+
+auto dk::sc_backtrace_seam(SC_Carver *carver, SC_Axis axis, ivec2 size, ivec2 texture_size) noexcept -> void {
+	GL_PROFILE_SCOPE(&carver->gpu.profiler, "backtrace");
+	s32 const minor_dim = axis == SC_AXIS_VERTICAL ? size.y : size.x;
+	SC_SeamPassShaders const *passes = sc_carver_seam_passes(carver, axis);
+
+	// NOTE(Dedrick): Seam back-tracing.
+	glUseProgram(passes->prog_backtrace);
+	glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 0, carver->gpu.ssbo_cost);
+	glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 1, carver->gpu.ssbo_seam);
+	glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 2, carver->gpu.ssbo_min_index);
+	for (s32 i = minor_dim - 1; i >= 0; --i) {
+		sc_upload_carve_params(&carver->gpu, size, texture_size, i, 1);
+		glDispatchCompute(1, 1, 1);
+		glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT);
+	}
+}
+
+auto dk::sc_remove_seam(SC_Carver *carver, SC_Axis axis) noexcept -> void {
+	GL_PROFILE_SCOPE(&carver->gpu.profiler, "remove");
+	sc_remove_seam_from(
+		carver,
+		axis,
+		carver->tex_src,
+		carver->tex_dst,
+		{ carver->current_width, carver->current_height },
+		{ carver->max_texture_size, carver->max_texture_size }
+	);
+
+	swap(&carver->tex_src, &carver->tex_dst);
+	if (axis == SC_AXIS_VERTICAL) {
+		carver->current_width -= 1;
+	}
+	else {
+		carver->current_height -= 1;
+	}
+}
+
+/// Removes up to `max_seams` seams along `axis` and returns how many were removed.
+auto dk::sc_carve_seams(SC_Carver *carver, SC_Axis axis, s32 max_seams) noexcept -> s32 {
+	GL_PROFILE_SCOPE(&carver->gpu.profiler, "carve_seams");
+	s32 const proxy_major = axis == SC_AXIS_VERTICAL ? carver->proxy_width : carver->proxy_height;
+	b8 const use_proxy = (carver->flags & SC_CARVE_FLAG_PROXY) != 0 && proxy_major > 1;
+	b8 const use_exact = !use_proxy && carver->seam_search == SC_SeamSearch::EXACT;
+
+	// NOTE(Dedrick): Leave at least one pixel, the backtrace needs room to keep seams apart.
+	s32 const major_dim = axis == SC_AXIS_VERTICAL ? carver->current_width : carver->current_height;
+	s32 const seam_count = glm::max(glm::min(glm::min(carver->seams_per_pass, max_seams), major_dim - 1), 1);
+
+	// NOTE(Dedrick): Only the exact search reads the image through the index map.
+	b8 const lazy = use_exact && (carver->flags & SC_CARVE_FLAG_LAZY_REMOVAL) != 0;
+	if (!lazy || carver->removed_axis != axis || carver->removed_count + seam_count > carver->lazy_threshold) {
+		sc_carver_materialize(carver);
+	}
+
+	if (use_proxy) {
+		carver->last_seam_count = 1;
+		return sc_carve_seams_proxy(carver, axis, max_seams);
+	}
+
+	if (!use_exact) {
+		sc_find_seam_pyramid(carver, axis);
+		if ((carver->flags & SC_CARVE_FLAG_MEASURE_QUALITY) != 0) {
+			sc_measure_seam_quality(carver, axis);
+		}
+		sc_remove_seam(carver, axis);
+		carver->last_seam_count = 1;
+		return 1;
+	}
+
+	if (seam_count > 1) {
+		sc_find_seams_batch(carver, axis, seam_count);
+	} else {
+		sc_find_seam_exact(carver, axis);
+	}
+
+	if (lazy) {
+		sc_remove_seams_lazy(carver, axis, seam_count);
+	} else if (seam_count > 1) {
+		sc_remove_seams_batch(carver, axis, seam_count);
+	} else {
+		sc_remove_seam(carver, axis);
+	}
+	carver->last_seam_count = seam_count;
+	return seam_count;
+}
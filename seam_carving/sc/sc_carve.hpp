@@ -0,0 +1,238 @@
+/*
+ * Copyright (C) 2025 Koh Swee Teck Dedrick.
+ * Licensed under the Apache License, Version 2.0 (http://www.apache.org/licenses/LICENSE-2.0)
+ */
+
+#pragma once
+
+#include "base/base_math.hpp"
+#include "base/base_types.hpp"
+#include "sc/sc_assets.hpp"
+#include "sc/sc_opengl.hpp"
+#include "sc/sc_shader_cache.hpp"
+
+#include <glad/gl.h>
+
+namespace dk {
+	constexpr s32 SC_PYRAMID_MAX_LEVELS = 3; ///< Including the full resolution level.
+	constexpr s32 SC_PYRAMID_MIN_SIZE = 16; ///< Coarsest level is never made smaller than this.
+	constexpr s32 SC_PROXY_MAX_SCALE = 8;
+	constexpr s32 SC_LAZY_MAX_REMOVED = 2 * SC_MAX_SEAMS_PER_PASS; ///< Index map capacity per row/col.
+
+	enum SC_Axis : u8 {
+		SC_AXIS_VERTICAL = 0,
+		SC_AXIS_HORIZONTAL,
+
+		SC_AXIS_MAX_COUNT
+	};
+
+	enum class SC_SeamSearch : s32 {
+		EXACT = 0,
+		PYRAMID ///< Coarse-to-fine search, refined inside a narrow band at each level.
+	};
+
+	// NOTE(Dedrick): Sizes the shader variants are compiled with. They only change how the work is split
+	// into workgroups, every config carves the same seams.
+	/// Workgroup sizes of the compute stages.
+	struct SC_KernelConfig {
+		s32 cost_size; ///< Invocations of the cost map pass, one line of the cost map per dispatch.
+		s32 reduction_size; ///< Invocations of the min search and band passes, a power of two.
+		s32 tile_width; ///< Workgroup of the per pixel passes.
+		s32 tile_height;
+	};
+
+	struct SC_SeamPassShaders {
+		GLuint prog_cost;
+		GLuint prog_find_min_local;
+		GLuint prog_find_min_global;
+		GLuint prog_backtrace;
+		GLuint prog_remove_seam;
+		GLuint prog_band_seam;
+		GLuint prog_find_min_k;
+		GLuint prog_backtrace_k;
+		GLuint prog_compact;
+	};
+
+	struct SC_GpuResource {
+		GLuint empty_vao;
+
+		GLuint time_queries[8];
+		b8 time_queries_in_flight[8];
+		GL_Profiler profiler;
+
+		GLuint tex_scratch[2]; ///< GL_RGBA8
+		GLuint tex_original; ///< GL_SRGB8_ALPHA8
+		GLuint tex_energy; ///< GL_R32F
+		GLuint tex_coarse[2]; ///< GL_RGBA8, half resolution. Coarse pyramid levels or the proxy ping-pong pair.
+		GLuint tex_energy_coarse; ///< GL_R32F, half resolution.
+
+		GLuint ubo_display;
+		GLuint ubo_carve;
+		GLuint ubo_resample;
+		GLuint ubo_band;
+		GLuint ssbo_cost;
+		GLuint ssbo_seam; ///< Up to SC_MAX_SEAMS_PER_PASS entries per row/col.
+		GLuint ssbo_seam_guide; ///< Seam found on the next coarser level.
+		GLuint ssbo_min_index; ///< uvec2 = (cost, index)
+		GLuint ssbo_removed[2]; ///< Index map, sorted removed source indices per row/col.
+		GLuint ubo_index_map;
+		GLuint ssbo_srgb_table; ///< 256 uints, see sc_color_linear_to_srgb_table.
+
+		GLuint prog_srgb_to_linear;
+		GLuint prog_linear_to_srgb;
+		GLuint prog_display;
+		GLuint prog_sobel;
+		GLuint prog_sobel_index_map;
+		GLuint prog_index_map_insert;
+		GLuint prog_downsample;
+
+		SC_SeamPassShaders seam_passes[SC_AXIS_MAX_COUNT]; ///< Created on the first carve of each axis.
+		b8 seam_passes_created[SC_AXIS_MAX_COUNT];
+		SC_KernelConfig kernels;
+		SC_ShaderCache *shader_cache; ///< Owns every compute program.
+	};
+
+	/// Persistently mapped buffer the carved image is read back into without stalling.
+	struct SC_Readback {
+		GLuint buffer;
+		u8 *mapped; ///< sRGB RGBA8, top row first. Only valid once `sc_readback_poll` returned true.
+		u64 capacity;
+		GLsync fence; ///< nullptr when no readback is pending.
+		s32 width;
+		s32 height;
+	};
+
+	using SC_CarveFlags = u32;
+	enum : SC_CarveFlags {
+		SC_CARVE_FLAG_NONE = 0,
+		SC_CARVE_FLAG_MEASURE_QUALITY = 1u << 0,
+		SC_CARVE_FLAG_PROXY = 1u << 1,
+		SC_CARVE_FLAG_LAZY_REMOVAL = 1u << 2,
+	};
+
+	/// GPU carving engine, shared by the viewer, batch mode and the benchmark.
+	struct SC_Carver {
+		SC_GpuResource gpu;
+
+		s32 max_texture_size;
+		s32 original_width;
+		s32 original_height;
+		s32 current_width;
+		s32 current_height;
+
+		SC_SeamSearch seam_search;
+		s32 pyramid_levels;
+		s32 band_radius;
+		s32 seams_per_pass; ///< Seams extracted from one cost map, exact search only.
+		s32 last_seam_count; ///< Seams per row/col stored in ssbo_seam by the last pass.
+
+		// NOTE(Dedrick): With SC_CARVE_FLAG_LAZY_REMOVAL seams are only recorded in the index map
+		// and tex_src keeps `removed_count` extra pixels per row/col until it is compacted.
+		s32 lazy_threshold; ///< Removed pixels per row/col before tex_src is compacted.
+		s32 removed_count;
+		SC_Axis removed_axis;
+		GLuint removed_src; ///< Points to ssbo_removed[0] or ssbo_removed[1]
+		GLuint removed_dst;
+
+		s32 proxy_scale;
+		s32 proxy_width; ///< 0 when there is no valid proxy.
+		s32 proxy_height;
+		GLuint proxy_src; ///< Points to tex_coarse[0] or tex_coarse[1]
+		GLuint proxy_dst;
+
+		// NOTE(Dedrick): Only gathered with SC_CARVE_FLAG_MEASURE_QUALITY, since it runs
+		// the exact search alongside and stalls on the readback.
+		f64 seam_cost_ratio_sum; ///< Sum of (found seam cost / exact seam cost).
+		f32 seam_cost_ratio_max;
+		u32 seam_cost_ratio_count;
+
+		GLuint tex_src; ///< Points to tex_scratch[0] or tex_scratch[1]
+		GLuint tex_dst;
+
+		SC_CarveFlags flags;
+	};
+
+
+	/* --- Lifetime --- */
+
+	/// Compute programs are variants from `shader_cache`, which has to outlive the carver.
+	auto sc_carver_init(SC_Carver *carver, s32 max_texture_size, SC_ShaderCache *shader_cache) noexcept -> void;
+
+	auto sc_carver_release(SC_Carver *carver) noexcept -> void;
+
+	/// GPU memory held by a carver created with `max_texture_size`.
+	auto sc_carver_gpu_bytes(s32 max_texture_size) noexcept -> u64;
+
+	/// 256 invocation cost pass and reductions, 8x8 tiles.
+	auto sc_kernel_config_default() noexcept -> SC_KernelConfig;
+
+	/// Switches to the variants of `kernels`. Seam programs are fetched again on the next carve of their axis.
+	auto sc_carver_set_kernels(SC_Carver *carver, SC_KernelConfig const *kernels) noexcept -> void;
+
+	/// Band must fit one reduction workgroup.
+	auto sc_band_max_radius(SC_KernelConfig const *kernels) noexcept -> s32;
+
+
+	/* --- Image --- */
+
+	/// Uploads sRGB RGBA8 pixels as the original image and resets to it.
+	auto sc_carver_load_image(SC_Carver *carver, u8 const *pixels, s32 width, s32 height) noexcept -> void;
+
+	auto sc_carver_reset(SC_Carver *carver) noexcept -> void;
+
+	/// Compacts any lazily removed seams, so tex_src holds the dense carved image.
+	auto sc_carver_materialize(SC_Carver *carver) noexcept -> void;
+
+	/// Queues an sRGB encode of the carved image into `readback`, growing its buffer when needed, and
+	/// returns right away. The previous readback into it must have completed.
+	auto sc_carver_read_pixels_async(SC_Carver *carver, SC_Readback *readback) noexcept -> void;
+
+	/// True once the pending readback completed, or when there is none. `wait` blocks until it completes.
+	auto sc_readback_poll(SC_Readback *readback, b8 wait) noexcept -> b8;
+
+	auto sc_readback_release(SC_Readback *readback) noexcept -> void;
+
+
+	/* --- Carving --- */
+
+	/// Clears the carve statistics and builds the proxy when proxy carving is enabled.
+	auto sc_carver_begin(SC_Carver *carver) noexcept -> void;
+
+	/// Programs of `axis`, submitted on the first call. Using them while they compile blocks.
+	auto sc_carver_seam_passes(SC_Carver *carver, SC_Axis axis) noexcept -> SC_SeamPassShaders const *;
+
+	/// Submits the programs of `axis` if needed. True once they are compiled, so carving `axis` does not block.
+	auto sc_carver_prepare_axis(SC_Carver *carver, SC_Axis axis) noexcept -> b8;
+
+	/// Removes up to `max_seams` seams along `axis` and returns how many were removed.
+	auto sc_carve_seams(SC_Carver *carver, SC_Axis axis, s32 max_seams) noexcept -> s32;
+
+
+	/* --- Stages (exact search) --- */
+
+	auto sc_upload_index_map_params(SC_Carver *carver) noexcept -> void;
+
+	auto sc_compute_current_energy(SC_Carver *carver) noexcept -> void;
+
+	auto sc_fill_cost_map(
+		SC_Carver *carver,
+		SC_Axis axis,
+		GLuint tex_energy,
+		ivec2 size,
+		ivec2 texture_size
+	) noexcept -> void;
+
+	auto sc_find_min_seam_end(SC_Carver *carver, SC_Axis axis, ivec2 size, ivec2 texture_size) noexcept -> void;
+
+	auto sc_accumulate_cost(
+		SC_Carver *carver,
+		SC_Axis axis,
+		GLuint tex_energy,
+		ivec2 size,
+		ivec2 texture_size
+	) noexcept -> void;
+
+	auto sc_backtrace_seam(SC_Carver *carver, SC_Axis axis, ivec2 size, ivec2 texture_size) noexcept -> void;
+
+	auto sc_remove_seam(SC_Carver *carver, SC_Axis axis) noexcept -> void;
+}
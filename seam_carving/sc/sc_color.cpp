@@ -0,0 +1,100 @@
+/*
+ * Copyright (C) 2025 Koh Swee Teck Dedrick.
+ * Licensed under the Apache License, Version 2.0 (http://www.apache.org/licenses/LICENSE-2.0)
+ */
+
+#include "sc_color.hpp"
+
+#include "base/base_cpu.hpp"
+#include "base/base_math.hpp"
+
+#include <immintrin.h>
+
+namespace {
+	using namespace dk;
+
+	struct SC_ColorTables {
+		u32 linear_to_srgb[256];
+		f32 luminance[3][256]; ///< Channel weight times the 8-bit linear value of every sRGB value.
+	};
+
+	auto sc_color_tables_build() noexcept -> SC_ColorTables {
+		constexpr f64 luminance_weights[3] = { 0.2126, 0.7152, 0.0722 };
+
+		SC_ColorTables tables = {};
+		for (u32 value = 0; value < 256; ++value) {
+			// NOTE(Dedrick): Same float math and truncation the CPU save path used, so files do not change.
+			f32 c = static_cast<f32>(value) / 255.0f;
+			c = (c <= 0.0031308f) ? (c * 12.92f) : (1.055f * glm::pow(c, 1.0f / 2.4f) - 0.055f);
+			u32 const srgb = static_cast<u32>(static_cast<u8>(glm::clamp(c, 0.0f, 1.0f) * 255.0f));
+
+			// NOTE(Dedrick): GL_SRGB8_ALPHA8 sampling, then the round to nearest of the rgba8 imageStore.
+			f64 const s = static_cast<f64>(value) / 255.0;
+			f64 const linear = (s <= 0.04045) ? (s / 12.92) : glm::pow((s + 0.055) / 1.055, 2.4);
+			f64 const linear_8bit = glm::round(linear * 255.0);
+
+			tables.linear_to_srgb[value] = srgb;
+			for (u32 channel = 0; channel < 3; ++channel) {
+				tables.luminance[channel][value] = static_cast<f32>(luminance_weights[channel] / 255.0 * linear_8bit);
+			}
+		}
+		return tables;
+	}
+
+	auto sc_color_tables() noexcept -> SC_ColorTables const * {
+		static SC_ColorTables const tables = sc_color_tables_build();
+		return &tables;
+	}
+
+	/// Luminance of the first pixels of the row 8 at a time, returns how many it did.
+	DK_TARGET_AVX2 auto sc_color_luminance_avx2(SC_ColorTables const *tables, f32 *out, u32 const *row, s32 count) noexcept -> s32 {
+		__m256i const byte_mask = _mm256_set1_epi32(0xFF);
+		s32 x = 0;
+		for (; x + 8 <= count; x += 8) {
+			__m256i const p = _mm256_loadu_si256(reinterpret_cast<__m256i const *>(row + x));
+			__m256 const r = _mm256_i32gather_ps(tables->luminance[0], _mm256_and_si256(p, byte_mask), 4);
+			__m256 const g = _mm256_i32gather_ps(tables->luminance[1], _mm256_and_si256(_mm256_srli_epi32(p, 8), byte_mask), 4);
+			__m256 const b = _mm256_i32gather_ps(tables->luminance[2], _mm256_and_si256(_mm256_srli_epi32(p, 16), byte_mask), 4);
+			_mm256_storeu_ps(out + x, _mm256_add_ps(_mm256_add_ps(r, g), b));
+		}
+		_mm256_zeroupper();
+		return x;
+	}
+
+	/// Luminance of the first pixels of the row 4 at a time, returns how many it did.
+	auto sc_color_luminance_sse2(SC_ColorTables const *tables, f32 *out, u32 const *row, s32 count) noexcept -> s32 {
+		__m128i const byte_mask = _mm_set1_epi32(0xFF);
+		s32 x = 0;
+		for (; x + 4 <= count; x += 4) {
+			__m128i const p = _mm_loadu_si128(reinterpret_cast<__m128i const *>(row + x));
+			alignas(16) u32 channels[3][4];
+			_mm_store_si128(reinterpret_cast<__m128i *>(channels[0]), _mm_and_si128(p, byte_mask));
+			_mm_store_si128(reinterpret_cast<__m128i *>(channels[1]), _mm_and_si128(_mm_srli_epi32(p, 8), byte_mask));
+			_mm_store_si128(reinterpret_cast<__m128i *>(channels[2]), _mm_and_si128(_mm_srli_epi32(p, 16), byte_mask));
+			__m128 sum = _mm_setzero_ps();
+			for (u32 channel = 0; channel < 3; ++channel) {
+				f32 const *table = tables->luminance[channel];
+				u32 const *index = channels[channel];
+				sum = _mm_add_ps(sum, _mm_setr_ps(table[index[0]], table[index[1]], table[index[2]], table[index[3]]));
+			}
+			_mm_storeu_ps(out + x, sum);
+		}
+		return x;
+	}
+}
+
+auto dk::sc_color_linear_to_srgb_table() noexcept -> u32 const * {
+	return sc_color_tables()->linear_to_srgb;
+}
+
+auto dk::sc_color_luminance_row(f32 *out, u32 const *row, s32 count) noexcept -> void {
+	SC_ColorTables const *tables = sc_color_tables();
+
+	s32 x = (cpu_features() & CPU_FEATURE_FLAG_AVX2) != 0
+		? sc_color_luminance_avx2(tables, out, row, count)
+		: sc_color_luminance_sse2(tables, out, row, count);
+	for (; x < count; ++x) {
+		u32 const p = row[x];
+		out[x] = tables->luminance[0][p & 0xFFu] + tables->luminance[1][(p >> 8) & 0xFFu] + tables->luminance[2][(p >> 16) & 0xFFu];
+	}
+}
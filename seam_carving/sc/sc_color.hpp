@@ -0,0 +1,20 @@
+/*
+ * Copyright (C) 2025 Koh Swee Teck Dedrick.
+ * Licensed under the Apache License, Version 2.0 (http://www.apache.org/licenses/LICENSE-2.0)
+ */
+
+#pragma once
+
+#include "base/base_types.hpp"
+
+namespace dk {
+	// NOTE(Dedrick): Every input is 8 bits, so each conversion is a 256 entry table lookup per channel.
+	// The tables are built on first use, from the same transfer functions the GPU carver uses.
+
+	/// 256 entry 8-bit linear to 8-bit sRGB table of the GPU encode pass.
+	auto sc_color_linear_to_srgb_table() noexcept -> u32 const *;
+
+	/// Luminance in [0, 1] of sRGB RGBA8 pixels. Computed on the linear color rounded to 8 bits,
+	/// which is what the GPU carver's energy pass reads from its linear texture.
+	auto sc_color_luminance_row(f32 *out, u32 const *row, s32 count) noexcept -> void;
+}
@@ -0,0 +1,76 @@
+/*
+ * Copyright (C) 2025 Koh Swee Teck Dedrick.
+ * Licensed under the Apache License, Version 2.0 (http://www.apache.org/licenses/LICENSE-2.0)
+ */
+
+#include "sc_compact.hpp"
+
+#include "base/base_assert.h"
+#include "base/base_cpu.hpp"
+
+#include <immintrin.h>
+
+namespace {
+	using namespace dk;
+
+	/// Copies the first elements 8 at a time, returns how many it did.
+	DK_TARGET_AVX2 auto copy_forward_avx2(u32 *dst, u32 const *src, s32 count) noexcept -> s32 {
+		s32 i = 0;
+		for (; i + 8 <= count; i += 8) {
+			__m256i const v = _mm256_loadu_si256(reinterpret_cast<__m256i const *>(src + i));
+			_mm256_storeu_si256(reinterpret_cast<__m256i *>(dst + i), v);
+		}
+		_mm256_zeroupper();
+		return i;
+	}
+
+	/// Forward copy that is safe while `dst <= src`, which always holds when compacting in place:
+	/// a store never reaches past the vector that was just loaded.
+	auto copy_forward(u32 *dst, u32 const *src, s32 count, b8 use_avx2) noexcept -> void {
+		if (dst == src) {
+			return;
+		}
+
+		s32 i = use_avx2 ? copy_forward_avx2(dst, src, count) : 0;
+		for (; i + 4 <= count; i += 4) {
+			__m128i const v = _mm_loadu_si128(reinterpret_cast<__m128i const *>(src + i));
+			_mm_storeu_si128(reinterpret_cast<__m128i *>(dst + i), v);
+		}
+		for (; i < count; ++i) {
+			dst[i] = src[i];
+		}
+	}
+}
+
+auto dk::sc_compact_rows(
+	u32 *pixels,
+	s32 width,
+	s32 height,
+	s32 row_stride,
+	s32 const *removed,
+	s32 removed_count
+) noexcept -> void {
+	DK_ASSERT(pixels != nullptr);
+	DK_ASSERT(removed_count >= 0 && removed_count < width);
+	DK_ASSERT(removed_count == 0 || removed != nullptr);
+
+	if (removed_count == 0) {
+		return;
+	}
+
+	b8 const use_avx2 = (cpu_features() & CPU_FEATURE_FLAG_AVX2) != 0;
+	for (s32 y = 0; y < height; ++y) {
+		u32 *row = pixels + static_cast<usize>(y) * row_stride;
+		s32 const *row_removed = removed + static_cast<usize>(y) * removed_count;
+
+		// NOTE(Dedrick): Everything in front of the first removed column stays put,
+		// the runs in between move left by the number of columns removed so far.
+		s32 write = row_removed[0];
+		for (s32 i = 0; i < removed_count; ++i) {
+			s32 const run_begin = row_removed[i] + 1;
+			s32 const run_end = i + 1 < removed_count ? row_removed[i + 1] : width;
+			copy_forward(row + write, row + run_begin, run_end - run_begin, use_avx2);
+			write += run_end - run_begin;
+		}
+	}
+}
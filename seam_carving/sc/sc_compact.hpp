@@ -0,0 +1,22 @@
+/*
+ * Copyright (C) 2025 Koh Swee Teck Dedrick.
+ * Licensed under the Apache License, Version 2.0 (http://www.apache.org/licenses/LICENSE-2.0)
+ */
+
+#pragma once
+
+#include "base/base_types.hpp"
+
+namespace dk {
+	/// Removes `removed_count` columns from every row of an RGBA8 image in place.
+	/// `removed` holds `removed_count` strictly increasing columns per row, the same
+	/// layout the batch seam passes write to `ssbo_seam`.
+	auto sc_compact_rows(
+		u32 *pixels,
+		s32 width,
+		s32 height,
+		s32 row_stride,
+		s32 const *removed,
+		s32 removed_count
+	) noexcept -> void;
+}
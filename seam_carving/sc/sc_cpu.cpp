@@ -0,0 +1,356 @@
+/*
+ * Copyright (C) 2025 Koh Swee Teck Dedrick.
+ * Licensed under the Apache License, Version 2.0 (http://www.apache.org/licenses/LICENSE-2.0)
+ */
+
+#include "sc_cpu.hpp"
+
+#include "base/base_assert.h"
+#include "base/base_math.hpp"
+#include "base/base_profile.hpp"
+#include "base/base_utils.hpp"
+#include "os/os_core.hpp"
+#include "sc/sc_color.hpp"
+#include "sc/sc_compact.hpp"
+
+#include <bit>
+#include <cstring>
+
+namespace {
+	using namespace dk;
+
+	constexpr u32 SC_CPU_WAIT_STRIDE = 8; ///< u64s per cache line, keeps the wait counters apart.
+	constexpr s32 SC_CPU_TRANSPOSE_TILE = 32;
+
+	constexpr char const *SC_CPU_STAGE_NAMES[SC_CPU_STAGE_MAX_COUNT] = {
+		"cpu_energy",
+		"cpu_cost",
+		"cpu_find_min",
+		"cpu_backtrace",
+		"cpu_remove",
+		"cpu_transpose",
+	};
+
+	/// (columns, rows) of the buffers, seams always run from the first row to the last.
+	auto sc_cpu_layout_size(SC_CpuCarver const *carver) noexcept -> ivec2 {
+		return carver->transposed
+			? ivec2(carver->current_height, carver->current_width)
+			: ivec2(carver->current_width, carver->current_height);
+	}
+
+	/// Barrier between the workers of a stage, the time spent waiting is what stops a stage from scaling.
+	auto sc_cpu_barrier(SC_CpuCarver *carver, u32 worker_index) noexcept -> void {
+		if (carver->pool == nullptr) {
+			return;
+		}
+		u64 const start_time_us = os_now_microseconds();
+		job_pool_barrier(carver->pool);
+		carver->worker_wait_us[worker_index * SC_CPU_WAIT_STRIDE] += os_now_microseconds() - start_time_us;
+	}
+
+	auto sc_cpu_run(SC_CpuCarver *carver, SC_CpuStage stage, JobFunction function) noexcept -> void {
+		for (u32 i = 0; i < carver->worker_count; ++i) {
+			carver->worker_wait_us[i * SC_CPU_WAIT_STRIDE] = 0;
+		}
+
+		u64 const start_time_us = os_now_microseconds();
+		if (carver->pool != nullptr) {
+			job_pool_run(carver->pool, function, carver);
+		} else {
+			function(carver, 0, 1);
+		}
+		u64 const end_time_us = os_now_microseconds();
+		concurrent_arena_clear(carver->scratch);
+		carver->times.time_us[stage] += end_time_us - start_time_us;
+		if (profile_is_enabled()) {
+			profile_push_event(PROFILE_TRACK_CPU, SC_CPU_STAGE_NAMES[stage], start_time_us, end_time_us);
+		}
+
+		for (u32 i = 0; i < carver->worker_count; ++i) {
+			carver->times.wait_us[stage] += carver->worker_wait_us[i * SC_CPU_WAIT_STRIDE];
+		}
+	}
+
+	/// Sobel energy |gx| + |gy| of the luminance with clamped edges, same as energy_sobel on the GPU.
+	auto sc_cpu_energy_job(void *params, u32 worker_index, u32 worker_count) noexcept -> void {
+		SC_CpuCarver *carver = static_cast<SC_CpuCarver *>(params);
+		ivec2 const size = sc_cpu_layout_size(carver);
+		JobRange const range = job_range(static_cast<u64>(size.y), worker_index, worker_count);
+
+		if (range.begin < range.end) {
+			ConcurrentArenaBlock *block = &carver->worker_scratch[worker_index].block;
+			f32 *lum[3];
+			for (f32 *&row : lum) {
+				row = concurrent_arena_block_push_type_array<f32>(carver->scratch, block, static_cast<u64>(size.x));
+			}
+
+			// NOTE(Dedrick): Rolling window of three luminance rows, each row is converted once.
+			s32 const begin = static_cast<s32>(range.begin);
+			s32 const end = static_cast<s32>(range.end);
+			sc_color_luminance_row(lum[0], carver->pixels + static_cast<usize>(glm::max(begin - 1, 0)) * carver->stride, size.x);
+			sc_color_luminance_row(lum[1], carver->pixels + static_cast<usize>(begin) * carver->stride, size.x);
+			sc_color_luminance_row(lum[2], carver->pixels + static_cast<usize>(glm::min(begin + 1, size.y - 1)) * carver->stride, size.x);
+
+			for (s32 y = begin; y < end; ++y) {
+				f32 *energy_row = carver->energy + static_cast<usize>(y) * carver->stride;
+				for (s32 x = 0; x < size.x; ++x) {
+					s32 const l = glm::max(x - 1, 0);
+					s32 const r = glm::min(x + 1, size.x - 1);
+					f32 const gx =
+						(lum[0][r] - lum[0][l]) +
+						2.0f * (lum[1][r] - lum[1][l]) +
+						(lum[2][r] - lum[2][l]);
+					f32 const gy =
+						(lum[2][l] + 2.0f * lum[2][x] + lum[2][r]) -
+						(lum[0][l] + 2.0f * lum[0][x] + lum[0][r]);
+					energy_row[x] = glm::abs(gx) + glm::abs(gy);
+				}
+
+				if (y + 1 < end) {
+					f32 *const recycled = lum[0];
+					lum[0] = lum[1];
+					lum[1] = lum[2];
+					lum[2] = recycled;
+					sc_color_luminance_row(lum[2], carver->pixels + static_cast<usize>(glm::min(y + 2, size.y - 1)) * carver->stride, size.x);
+				}
+			}
+		}
+		sc_cpu_barrier(carver, worker_index);
+	}
+
+	/// Row by row DP. Every worker owns a range of columns and all of them meet after each row,
+	/// this is the sequential dependency that limits scaling.
+	auto sc_cpu_cost_job(void *params, u32 worker_index, u32 worker_count) noexcept -> void {
+		SC_CpuCarver *carver = static_cast<SC_CpuCarver *>(params);
+		ivec2 const size = sc_cpu_layout_size(carver);
+		JobRange const range = job_range(static_cast<u64>(size.x), worker_index, worker_count);
+		s32 const begin = static_cast<s32>(range.begin);
+		s32 const end = static_cast<s32>(range.end);
+
+		std::memcpy(carver->cost + begin, carver->energy + begin, static_cast<usize>(end - begin) * sizeof(f32));
+		sc_cpu_barrier(carver, worker_index);
+
+		for (s32 y = 1; y < size.y; ++y) {
+			f32 const *prev_row = carver->cost + static_cast<usize>(y - 1) * carver->stride;
+			f32 const *energy_row = carver->energy + static_cast<usize>(y) * carver->stride;
+			f32 *cost_row = carver->cost + static_cast<usize>(y) * carver->stride;
+			for (s32 x = begin; x < end; ++x) {
+				f32 const c1 = prev_row[glm::max(x - 1, 0)];
+				f32 const c2 = prev_row[x];
+				f32 const c3 = prev_row[glm::min(x + 1, size.x - 1)];
+				cost_row[x] = energy_row[x] + glm::min(c1, glm::min(c2, c3));
+			}
+			sc_cpu_barrier(carver, worker_index);
+		}
+	}
+
+	/// (cost, index) keys like the GPU reduction, so ties resolve to the lowest index.
+	auto sc_cpu_find_min_job(void *params, u32 worker_index, u32 worker_count) noexcept -> void {
+		SC_CpuCarver *carver = static_cast<SC_CpuCarver *>(params);
+		ivec2 const size = sc_cpu_layout_size(carver);
+		JobRange const range = job_range(static_cast<u64>(size.x), worker_index, worker_count);
+		f32 const *last_row = carver->cost + static_cast<usize>(size.y - 1) * carver->stride;
+
+		u64 min_key = ~0ull;
+		for (u64 x = range.begin; x < range.end; ++x) {
+			u64 const key = (static_cast<u64>(std::bit_cast<u32>(last_row[x])) << 32) | x;
+			min_key = glm::min(min_key, key);
+		}
+		carver->worker_min[worker_index] = min_key;
+		sc_cpu_barrier(carver, worker_index);
+
+		if (worker_index == 0) {
+			for (u32 i = 1; i < worker_count; ++i) {
+				min_key = glm::min(min_key, carver->worker_min[i]);
+			}
+			carver->seam[size.y - 1] = static_cast<s32>(min_key & 0xFFFFFFFFu);
+		}
+	}
+
+	/// Sequential, the other workers only wait for it.
+	auto sc_cpu_backtrace_job(void *params, u32 worker_index, u32 worker_count) noexcept -> void {
+		(void)worker_count;
+		SC_CpuCarver *carver = static_cast<SC_CpuCarver *>(params);
+		if (worker_index == 0) {
+			ivec2 const size = sc_cpu_layout_size(carver);
+			for (s32 y = size.y - 2; y >= 0; --y) {
+				f32 const *row = carver->cost + static_cast<usize>(y) * carver->stride;
+				s32 const x = carver->seam[y + 1];
+				s32 best = x;
+				if (x > 0 && row[x - 1] < row[best]) {
+					best = x - 1;
+				}
+				if (x + 1 < size.x && row[x + 1] < row[best]) {
+					best = x + 1;
+				}
+				carver->seam[y] = best;
+			}
+		}
+		sc_cpu_barrier(carver, worker_index);
+	}
+
+	auto sc_cpu_remove_job(void *params, u32 worker_index, u32 worker_count) noexcept -> void {
+		SC_CpuCarver *carver = static_cast<SC_CpuCarver *>(params);
+		ivec2 const size = sc_cpu_layout_size(carver);
+		JobRange const range = job_range(static_cast<u64>(size.y), worker_index, worker_count);
+		if (range.begin < range.end) {
+			sc_compact_rows(
+				carver->pixels + range.begin * carver->stride,
+				size.x,
+				static_cast<s32>(range.end - range.begin),
+				carver->stride,
+				carver->seam + range.begin,
+				1
+			);
+		}
+		sc_cpu_barrier(carver, worker_index);
+	}
+
+	/// Transposes `pixels` into `pixels_scratch` in tiles, every worker owns a range of destination rows.
+	/// The destination is packed, its pitch is the row count of the source layout.
+	auto sc_cpu_transpose_job(void *params, u32 worker_index, u32 worker_count) noexcept -> void {
+		SC_CpuCarver *carver = static_cast<SC_CpuCarver *>(params);
+		ivec2 const src_size = sc_cpu_layout_size(carver);
+		JobRange const range = job_range(static_cast<u64>(src_size.x), worker_index, worker_count);
+		s32 const begin = static_cast<s32>(range.begin);
+		s32 const end = static_cast<s32>(range.end);
+
+		for (s32 tile_y = begin; tile_y < end; tile_y += SC_CPU_TRANSPOSE_TILE) {
+			s32 const tile_y_end = glm::min(tile_y + SC_CPU_TRANSPOSE_TILE, end);
+			for (s32 tile_x = 0; tile_x < src_size.y; tile_x += SC_CPU_TRANSPOSE_TILE) {
+				s32 const tile_x_end = glm::min(tile_x + SC_CPU_TRANSPOSE_TILE, src_size.y);
+				for (s32 y = tile_y; y < tile_y_end; ++y) {
+					u32 *dst_row = carver->pixels_scratch + static_cast<usize>(y) * src_size.y;
+					for (s32 x = tile_x; x < tile_x_end; ++x) {
+						dst_row[x] = carver->pixels[static_cast<usize>(x) * carver->stride + y];
+					}
+				}
+			}
+		}
+		sc_cpu_barrier(carver, worker_index);
+	}
+}
+
+auto dk::sc_cpu_carver_init(SC_CpuCarver *carver, JobPool *pool, u64 max_texel_count, s32 max_size, ArenaFlags arena_flags) noexcept -> void {
+	DK_ASSERT(carver != nullptr && max_texel_count > 0 && max_size > 0);
+
+	// NOTE(Dedrick): Planes are packed at the pitch of the current layout, so a w x h image needs
+	// w * h texels whichever way it is transposed, not the square of its longest side.
+	u32 const worker_count = pool != nullptr ? pool->worker_count : 1;
+	u64 const texel_count = max_texel_count;
+	u64 const worker_bytes = static_cast<u64>(worker_count) * (SC_CPU_WAIT_STRIDE + 1) * sizeof(u64);
+	ArenaParams const params = {
+		.reserve_size = texel_count * 4 * 5 + static_cast<u64>(max_size) * sizeof(s32) + worker_bytes + mega_bytes(1),
+		.commit_size = mega_bytes(1),
+		.name = "cpu_carver",
+		// NOTE(Dedrick): With a pool the buffers are pre-faulted by all workers below instead.
+		.flags = pool != nullptr ? (arena_flags & ~ARENA_FLAG_PREFAULT) : arena_flags
+	};
+
+	*carver = {};
+	carver->arena = arena_alloc(&params);
+	carver->pool = pool;
+	carver->worker_count = worker_count;
+	carver->texel_capacity = texel_count;
+	carver->max_size = max_size;
+	carver->original = static_cast<u32 *>(arena_push_no_zero(carver->arena, texel_count * sizeof(u32), 64));
+	carver->pixels = static_cast<u32 *>(arena_push_no_zero(carver->arena, texel_count * sizeof(u32), 64));
+	carver->pixels_scratch = static_cast<u32 *>(arena_push_no_zero(carver->arena, texel_count * sizeof(u32), 64));
+	carver->energy = static_cast<f32 *>(arena_push_no_zero(carver->arena, texel_count * sizeof(f32), 64));
+	carver->cost = static_cast<f32 *>(arena_push_no_zero(carver->arena, texel_count * sizeof(f32), 64));
+	carver->seam = arena_push_type_array<s32>(carver->arena, static_cast<u64>(max_size));
+	carver->worker_min = arena_push_type_array<u64>(carver->arena, worker_count);
+	carver->worker_wait_us = static_cast<u64 *>(
+		arena_push(carver->arena, static_cast<usize>(worker_count) * SC_CPU_WAIT_STRIDE * sizeof(u64), 64)
+	);
+	carver->worker_scratch = arena_push_type_array<SC_CpuWorkerScratch>(carver->arena, worker_count);
+
+	// NOTE(Dedrick): A sub-block holds the three luminance rows of the energy pass, so each worker
+	// takes one block per stage with a single atomic and the rows themselves take none.
+	u64 const row_bytes = static_cast<u64>(max_size) * sizeof(f32);
+	u64 const block_size = align_forward_pow_2(4 * (row_bytes + alignof(f32)) + 64, 64);
+	ConcurrentArenaParams const scratch_params = {
+		.reserve_size = worker_count * (block_size + 64) + mega_bytes(1),
+		.commit_size = block_size,
+		.block_size = block_size,
+		.name = "cpu_carver_scratch"
+	};
+	carver->scratch = concurrent_arena_alloc(&scratch_params);
+
+	if (pool != nullptr && (arena_flags & ARENA_FLAG_PREFAULT) != 0) {
+		void *const planes[] = { carver->original, carver->pixels, carver->pixels_scratch, carver->energy, carver->cost };
+		for (void *plane : planes) {
+			job_prefault(pool, plane, texel_count * 4);
+		}
+	}
+}
+
+auto dk::sc_cpu_carver_release(SC_CpuCarver *carver) noexcept -> void {
+	concurrent_arena_release(carver->scratch);
+	arena_release(carver->arena);
+	*carver = {};
+}
+
+auto dk::sc_cpu_carver_load_image(SC_CpuCarver *carver, u8 const *pixels, s32 width, s32 height) noexcept -> void {
+	DK_ASSERT(width <= carver->max_size && height <= carver->max_size);
+	DK_ASSERT(static_cast<u64>(width) * height <= carver->texel_capacity);
+
+	std::memcpy(carver->original, pixels, static_cast<usize>(width) * height * sizeof(u32));
+	carver->original_width = width;
+	carver->original_height = height;
+	sc_cpu_carver_reset(carver);
+}
+
+auto dk::sc_cpu_carver_reset(SC_CpuCarver *carver) noexcept -> void {
+	std::memcpy(carver->pixels, carver->original, static_cast<usize>(carver->original_width) * carver->original_height * sizeof(u32));
+	carver->stride = carver->original_width;
+	carver->current_width = carver->original_width;
+	carver->current_height = carver->original_height;
+	carver->transposed = false;
+	carver->times = {};
+}
+
+auto dk::sc_cpu_carver_read_pixels(SC_CpuCarver *carver, u8 *out_pixels) noexcept -> void {
+	u32 *out = reinterpret_cast<u32 *>(out_pixels);
+	for (s32 y = 0; y < carver->current_height; ++y) {
+		u32 *out_row = out + static_cast<usize>(y) * carver->current_width;
+		if (carver->transposed) {
+			for (s32 x = 0; x < carver->current_width; ++x) {
+				out_row[x] = carver->pixels[static_cast<usize>(x) * carver->stride + y];
+			}
+		} else {
+			std::memcpy(out_row, carver->pixels + static_cast<usize>(y) * carver->stride, static_cast<usize>(carver->current_width) * sizeof(u32));
+		}
+	}
+}
+
+auto dk::sc_cpu_carve_seams(SC_CpuCarver *carver, SC_Axis axis, s32 seam_count) noexcept -> s32 {
+	b8 const want_transposed = axis == SC_AXIS_HORIZONTAL;
+	if (carver->transposed != want_transposed) {
+		s32 const transposed_stride = sc_cpu_layout_size(carver).y;
+		sc_cpu_run(carver, SC_CPU_STAGE_TRANSPOSE, sc_cpu_transpose_job);
+		swap(&carver->pixels, &carver->pixels_scratch);
+		carver->stride = transposed_stride;
+		carver->transposed = want_transposed;
+	}
+
+	s32 removed = 0;
+	for (; removed < seam_count; ++removed) {
+		if (sc_cpu_layout_size(carver).x <= 1) {
+			break;
+		}
+
+		sc_cpu_run(carver, SC_CPU_STAGE_ENERGY, sc_cpu_energy_job);
+		sc_cpu_run(carver, SC_CPU_STAGE_COST, sc_cpu_cost_job);
+		sc_cpu_run(carver, SC_CPU_STAGE_FIND_MIN, sc_cpu_find_min_job);
+		sc_cpu_run(carver, SC_CPU_STAGE_BACKTRACE, sc_cpu_backtrace_job);
+		sc_cpu_run(carver, SC_CPU_STAGE_REMOVE, sc_cpu_remove_job);
+
+		if (axis == SC_AXIS_VERTICAL) {
+			carver->current_width -= 1;
+		} else {
+			carver->current_height -= 1;
+		}
+	}
+	return removed;
+}
@@ -0,0 +1,85 @@
+/*
+ * Copyright (C) 2025 Koh Swee Teck Dedrick.
+ * Licensed under the Apache License, Version 2.0 (http://www.apache.org/licenses/LICENSE-2.0)
+ */
+
+#pragma once
+
+#include "base/base_arena.hpp"
+#include "base/base_arena_concurrent.hpp"
+#include "base/base_jobs.hpp"
+#include "base/base_types.hpp"
+#include "sc/sc_carve.hpp"
+
+namespace dk {
+	enum SC_CpuStage : u8 {
+		SC_CPU_STAGE_ENERGY = 0,
+		SC_CPU_STAGE_COST,
+		SC_CPU_STAGE_FIND_MIN,
+		SC_CPU_STAGE_BACKTRACE,
+		SC_CPU_STAGE_REMOVE,
+		SC_CPU_STAGE_TRANSPOSE, ///< Switching between vertical and horizontal seams.
+
+		SC_CPU_STAGE_MAX_COUNT
+	};
+
+	/// Accumulated since the last `sc_cpu_carver_reset`.
+	struct SC_CpuStageTimes {
+		u64 time_us[SC_CPU_STAGE_MAX_COUNT]; ///< Wall time on the calling thread.
+		u64 wait_us[SC_CPU_STAGE_MAX_COUNT]; ///< Time spent in barriers, summed over all workers.
+	};
+
+	/// Scratch sub-block of one worker, on its own cache line.
+	struct alignas(64) SC_CpuWorkerScratch {
+		ConcurrentArenaBlock block;
+	};
+
+	/// CPU carving engine, rows are split into contiguous ranges across the workers of `pool`.
+	/// Without a pool everything runs on the calling thread.
+	struct SC_CpuCarver {
+		Arena *arena;
+		JobPool *pool;
+		u32 worker_count;
+
+		// NOTE(Dedrick): Seams are always removed along rows. Horizontal seams
+		// are carved on the transposed image, `transposed` tracks the layout.
+		u32 *original; ///< RGBA8, never transposed, `original_width` texels per row.
+		u32 *pixels; ///< RGBA8, `stride` texels per row.
+		u32 *pixels_scratch; ///< Transpose target.
+		f32 *energy;
+		f32 *cost;
+		s32 *seam;
+		u64 *worker_min; ///< (cost bits << 32 | index) per worker.
+		u64 *worker_wait_us; ///< Padded to a cache line per worker.
+		ConcurrentArena *scratch; ///< Temporaries of the workers, cleared after every stage.
+		SC_CpuWorkerScratch *worker_scratch;
+		u64 texel_capacity; ///< Texels in each plane.
+		s32 max_size; ///< Longest side the seam and row buffers hold.
+		s32 stride; ///< Row pitch of the current layout, the image width or height once transposed.
+		b8 transposed;
+
+		s32 original_width;
+		s32 original_height;
+		s32 current_width; ///< In image space, regardless of `transposed`.
+		s32 current_height;
+
+		SC_CpuStageTimes times;
+	};
+
+	/// `pool` may be nullptr. Buffers are sized for images of up to `max_texel_count` texels and `max_size`
+	/// on either side. `arena_flags` selects large pages and pre-faulting for the buffers, pre-faulting runs on the pool.
+	auto sc_cpu_carver_init(SC_CpuCarver *carver, JobPool *pool, u64 max_texel_count, s32 max_size, ArenaFlags arena_flags) noexcept -> void;
+
+	auto sc_cpu_carver_release(SC_CpuCarver *carver) noexcept -> void;
+
+	/// Copies RGBA8 pixels as the original image and resets to it.
+	auto sc_cpu_carver_load_image(SC_CpuCarver *carver, u8 const *pixels, s32 width, s32 height) noexcept -> void;
+
+	auto sc_cpu_carver_reset(SC_CpuCarver *carver) noexcept -> void;
+
+	/// `out_pixels` holds current_width * current_height * 4 bytes.
+	auto sc_cpu_carver_read_pixels(SC_CpuCarver *carver, u8 *out_pixels) noexcept -> void;
+
+	/// Removes `seam_count` seams along `axis` one at a time and returns how many were removed.
+	auto sc_cpu_carve_seams(SC_CpuCarver *carver, SC_Axis axis, s32 seam_count) noexcept -> s32;
+}
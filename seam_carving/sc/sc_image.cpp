@@ -0,0 +1,120 @@
+/*
+ * Copyright (C) 2025 Koh Swee Teck Dedrick.
+ * Licensed under the Apache License, Version 2.0 (http://www.apache.org/licenses/LICENSE-2.0)
+ */
+
+#include "sc_image.hpp"
+
+#include "base/base_assert.h"
+#include "base/base_math.hpp"
+#include "base/base_profile.hpp"
+#include "base/base_thread_context.hpp"
+#include "os/os_core.hpp"
+#include "sc/sc_png.hpp"
+#include "thirdparty/stb_image.h"
+#include "thirdparty/stb_image_write.h"
+
+#include <climits>
+
+namespace {
+	using namespace dk;
+
+	/// Destination of the encoders' writes.
+	struct SC_ImageWriter {
+		OS_Handle file;
+		u64 offset;
+		b8 failed;
+	};
+
+	auto sc_image_writer_write(void *context, void *data, int size) noexcept -> void {
+		SC_ImageWriter *writer = static_cast<SC_ImageWriter *>(context);
+		if (writer->failed) {
+			return;
+		}
+		u64 const written = os_file_write(writer->file, writer->offset, writer->offset + static_cast<u64>(size), data);
+		writer->failed = written != static_cast<u64>(size);
+		writer->offset += written;
+	}
+}
+
+auto dk::sc_image_load(Arena *arena, String8 path) noexcept -> SC_Image {
+	DK_ASSERT(arena != nullptr);
+	DK_PROFILE_SCOPE("decode");
+
+	OS_Handle const file = os_file_open(path, OS_ACCESS_FLAG_READ);
+	OS_FileMap const map = os_file_map(file);
+	os_file_close(file);
+	if (map.data == nullptr || map.size > INT_MAX) {
+		os_file_unmap(map);
+		return {};
+	}
+
+	SC_Image image = {};
+	s32 channels = 0;
+	Arena *const previous_alloc_arena = tc_set_alloc_arena(arena);
+	image.pixels = stbi_load_from_memory(map.data, static_cast<int>(map.size), &image.width, &image.height, &channels, 4);
+	tc_set_alloc_arena(previous_alloc_arena);
+	os_file_unmap(map);
+	return image;
+}
+
+auto dk::sc_image_info(String8 path) noexcept -> SC_Image {
+	OS_Handle const file = os_file_open(path, OS_ACCESS_FLAG_READ);
+	OS_FileMap const map = os_file_map(file);
+	os_file_close(file);
+
+	SC_Image image = {};
+	s32 channels = 0;
+	if (map.data != nullptr && map.size <= INT_MAX
+		&& !stbi_info_from_memory(map.data, static_cast<int>(map.size), &image.width, &image.height, &channels)) {
+		image.width = 0;
+		image.height = 0;
+	}
+	os_file_unmap(map);
+	return image;
+}
+
+auto dk::sc_image_format_from_path(String8 path) noexcept -> SC_ImageFormat {
+	String8 const jpeg_extensions[] = { str8_literal(".jpg"), str8_literal(".jpeg") };
+	for (String8 const extension : jpeg_extensions) {
+		if (path.size >= extension.size) {
+			String8 const suffix = { .data = path.data + path.size - extension.size, .size = extension.size };
+			if (str8_compare(suffix, extension, STRING_MATCH_FLAG_CASE_INSENSITIVE) == 0) {
+				return SC_IMAGE_FORMAT_JPEG;
+			}
+		}
+	}
+	return SC_IMAGE_FORMAT_PNG;
+}
+
+auto dk::sc_image_save(String8 path, SC_Image image, SC_ImageFormat format, SC_ImageSaveParams const *params) noexcept -> b8 {
+	DK_ASSERT(image.pixels != nullptr && params != nullptr);
+	DK_PROFILE_SCOPE("save");
+
+	ScratchArena const scratch = arena_scratch_begin(tc_get_scratch(nullptr, 0));
+
+	// NOTE(Dedrick): Encoding goes through a callback instead of stb's FILE based writers,
+	// so neither the encoder nor the CRT touch the heap.
+	SC_ImageWriter writer = {
+		.file = os_file_open(path, OS_ACCESS_FLAG_WRITE),
+	};
+	s32 written = 0;
+	if (writer.file != os_handle_invalid()) {
+		DK_PROFILE_SCOPE("encode");
+		if (format == SC_IMAGE_FORMAT_JPEG) {
+			Arena *const previous_alloc_arena = tc_set_alloc_arena(scratch.arena);
+			written = stbi_write_jpg_to_func(sc_image_writer_write, &writer, image.width, image.height, 4, image.pixels, 90);
+			tc_set_alloc_arena(previous_alloc_arena);
+		} else {
+			SC_PngParams const png_params = { .pool = params->pool, .level = params->png_level };
+			String8List const pieces = sc_png_encode(scratch.arena, image.pixels, image.width, image.height, &png_params);
+			for (String8Node const *node = pieces.first; node != nullptr; node = node->next) {
+				sc_image_writer_write(&writer, const_cast<u8 *>(node->string.data), static_cast<int>(node->string.size));
+			}
+			written = 1;
+		}
+		os_file_close(writer.file);
+	}
+	arena_scratch_end(scratch);
+	return written != 0 && !writer.failed;
+}
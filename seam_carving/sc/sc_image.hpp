@@ -0,0 +1,44 @@
+/*
+ * Copyright (C) 2025 Koh Swee Teck Dedrick.
+ * Licensed under the Apache License, Version 2.0 (http://www.apache.org/licenses/LICENSE-2.0)
+ */
+
+#pragma once
+
+#include "base/base_arena.hpp"
+#include "base/base_jobs.hpp"
+#include "base/base_strings.hpp"
+#include "base/base_types.hpp"
+
+namespace dk {
+	enum SC_ImageFormat : u32 {
+		SC_IMAGE_FORMAT_PNG = 0, ///< Same order as the save dialog filters.
+		SC_IMAGE_FORMAT_JPEG,
+	};
+
+	/// Tightly packed RGBA8 pixels.
+	struct SC_Image {
+		u8 *pixels; ///< nullptr when loading failed.
+		s32 width;
+		s32 height;
+	};
+
+	struct SC_ImageSaveParams {
+		JobPool *pool; ///< Converts and encodes PNGs on every worker, nullptr does it on the calling thread.
+		s32 png_level; ///< 0 stores the pixels uncompressed, SC_PNG_MAX_LEVEL is smallest.
+	};
+
+	/// Decodes the file at `path` straight from a read-only mapping, without copying it first.
+	/// The pixels and everything stb allocates while decoding are pushed on `arena`.
+	auto sc_image_load(Arena *arena, String8 path) noexcept -> SC_Image;
+
+	/// JPEG for .jpg/.jpeg, PNG for everything else.
+	auto sc_image_format_from_path(String8 path) noexcept -> SC_ImageFormat;
+
+	/// Header only, `pixels` stays nullptr. Width and height are 0 when the file is not an image.
+	auto sc_image_info(String8 path) noexcept -> SC_Image;
+
+	/// Writes the sRGB image to `path`, rows top to bottom.
+	/// NOTE(Dedrick): Everything it allocates comes from the calling thread's scratch arenas.
+	auto sc_image_save(String8 path, SC_Image image, SC_ImageFormat format, SC_ImageSaveParams const *params) noexcept -> b8;
+}
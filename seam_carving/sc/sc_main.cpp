@@ -6,59 +6,43 @@
 #include "base/base.hpp"
 #include "os/os.hpp"
 #include "sc/sc_assets.hpp"
+#include "sc/sc_autotune.hpp"
+#include "sc/sc_batch.hpp"
+#include "sc/sc_carve.hpp"
+#include "sc/sc_image.hpp"
 #include "sc/sc_imgui.hpp"
 #include "sc/sc_opengl.hpp"
+#include "sc/sc_png.hpp"
+#include "sc/sc_shader_cache.hpp"
 #include "thirdparty/argh.h"
 #include "thirdparty/stb_image.h"
-#include "thirdparty/stb_image_write.h"
+
+#include <atomic>
 
 using namespace dk;
 
 namespace {
-	constexpr s32 REDUCTION_WORKGROUP_SIZE = 256;
-
-	enum SC_Axis : u8 {
-		SC_AXIS_VERTICAL = 0,
-		SC_AXIS_HORIZONTAL,
-
-		SC_AXIS_MAX_COUNT
-	};
-
 	struct SC_Config {
 		s32 win_width;
 		s32 win_height;
 		s32 max_texture_size; ///< Maximum texture size supported on width and height.
-	};
-
-	struct SC_SeamPassShaders {
-		GLuint prog_cost;
-		GLuint prog_find_min_local;
-		GLuint prog_find_min_global;
-		GLuint prog_backtrace;
-		GLuint prog_remove_seam;
-	};
-
-	struct SC_GpuResource {
-		GLuint empty_vao;
-
-		GLuint time_queries[8];
-		b8 time_queries_in_flight[8];
-
-		GLuint tex_scratch[2]; ///< GL_RGBA8
-		GLuint tex_original; ///< GL_SRGB8_ALPHA8
-		GLuint tex_energy; ///< GL_R32F
-
-		GLuint ubo_display;
-		GLuint ubo_carve;
-		GLuint ssbo_cost;
-		GLuint ssbo_seam;
-		GLuint ssbo_min_index; ///< uvec2 = (cost, index)
-
-		GLuint prog_srgb_to_linear;
-		GLuint prog_display;
-		GLuint prog_sobel;
 
-		SC_SeamPassShaders seam_passes[SC_AXIS_MAX_COUNT];
+		// NOTE(Dedrick): Batch mode runs headless when an input path is given.
+		String8 input_path;
+		String8 output_path;
+		s32 target_width; ///< 0 keeps the original width.
+		s32 target_height; ///< 0 keeps the original height.
+		s32 proxy_scale; ///< 0 or 1 disables proxy carving.
+		s32 seams_per_pass; ///< 0 or 1 removes one seam per DP pass.
+		String8 trace_path; ///< Chrome trace written at exit, empty disables the profiler.
+		s32 in_flight; ///< Batch images being decoded, carved or encoded at once.
+		String8 input_list_path; ///< Text file with one input image per line, replaces input_path.
+		b8 throughput; ///< Carve the batch on the CPU engine, one image per worker, without a window.
+		s32 worker_count; ///< Throughput workers, 0 uses every logical processor.
+		s32 png_level; ///< 0 stores saved PNGs uncompressed, SC_PNG_MAX_LEVEL is smallest.
+		String8 shader_cache_path; ///< Program binary directory, empty compiles every program from source.
+		b8 verbose; ///< Print startup timings.
+		b8 autotune; ///< Time the kernel configs on this GPU and store the fastest in the kernel profile.
 	};
 
 	using SC_ContextFlags = u32;
@@ -72,6 +56,7 @@ namespace {
 		SC_FLAG_PENDING_RESET = 1u << 5,
 		SC_FLAG_PENDING_CARVE = 1u << 6,
 		SC_FLAG_VSYNC_ENABLED = 1u << 7,
+		SC_FLAG_BATCH = 1u << 8,
 	};
 
 	enum class SC_DebugView : s32 {
@@ -79,29 +64,44 @@ namespace {
 		ENERGY
 	};
 
+	enum class SC_SaveState : u8 {
+		IDLE = 0,
+		READBACK, ///< Waiting on the readback fence.
+		ENCODE ///< Encoding on `thread`.
+	};
+
+	// NOTE(Dedrick): The readback is polled once per frame and encoded on a thread of its own,
+	// so saving never holds up the frame loop.
+	/// Save started from the UI.
+	struct SC_Save {
+		SC_SaveState state;
+		Arena *arena; ///< Copy of the path, cleared by every save.
+		String8 path;
+		SC_ImageFormat format;
+		SC_ImageSaveParams const *params;
+		SC_Readback readback;
+		OS_Handle thread;
+		std::atomic<b8> encoded;
+		b8 saved;
+	};
+
 	struct SC_Context {
 		Arena *global_arena;
 		OS_Handle window;
 
-		SC_GpuResource gpu;
+		SC_ShaderCache shader_cache;
+		SC_Carver carver;
+		SC_ImageSaveParams save_params; ///< Its pool encodes for the UI save and the batch encoder, never both at once.
+		SC_Save save;
 
 		Arena *image_arena;
 		String8 image_path;
 		u64 carve_time_us;
 		u32 seam_count_vertical;
 		u32 seam_count_horizontal;
-		
-		s32 max_texture_size;
-		s32 original_width;
-		s32 original_height;
-		s32 current_width;
-		s32 current_height;
 		s32 target_width;
 		s32 target_height;
 
-		GLuint tex_src; ///< Points to tex_scratch[0] or tex_scratch[1]
-		GLuint tex_dst;
-
 		u64 frame_time_us;
 		SC_DebugView current_view;
 		SC_ContextFlags flags;
@@ -117,94 +117,39 @@ namespace {
 }
 
 namespace {
-	auto sc_gpu_alloc(SC_GpuResource *gpu, s32 max_texture_size) noexcept -> void {
-		glCreateVertexArrays(1, &gpu->empty_vao);
-		glCreateQueries(GL_TIME_ELAPSED, static_cast<GLsizei>(array_size(gpu->time_queries)), gpu->time_queries);
-		for (b8 &in_flight : gpu->time_queries_in_flight) {
-			in_flight = false;
-		}
-
-		gpu->ubo_display = gl_buffer_create(sizeof(SC_DisplayParams), GL_DYNAMIC_STORAGE_BIT, nullptr);
-		gpu->ubo_carve = gl_buffer_create(sizeof(SC_CarveParams), GL_DYNAMIC_STORAGE_BIT, nullptr);
-
-		gpu->ssbo_cost = gl_buffer_create(static_cast<u64>(max_texture_size) * max_texture_size * sizeof(f32), 0, nullptr);
-		gpu->ssbo_seam = gl_buffer_create(static_cast<u64>(max_texture_size) * sizeof(s32), 0, nullptr);
-		gpu->ssbo_min_index = gl_buffer_create(static_cast<u64>(max_texture_size) * sizeof(uvec2), 0, nullptr);
-
-		gpu->tex_scratch[0] = gl_texture_create(GL_RGBA8, max_texture_size, max_texture_size);
-		gpu->tex_scratch[1] = gl_texture_create(GL_RGBA8, max_texture_size, max_texture_size);
-		gpu->tex_original = gl_texture_create(GL_SRGB8_ALPHA8, max_texture_size, max_texture_size);
-		gpu->tex_energy = gl_texture_create(GL_R32F, max_texture_size, max_texture_size);
-
-		gpu->prog_display = gl_program_create(vs_display, fs_display);
-		gpu->prog_srgb_to_linear = gl_compute_program_create(cs_srgb_to_linear);
-		gpu->prog_sobel = gl_compute_program_create(cs_sobel);
-
-		String8 const compute_shaders[SC_AXIS_MAX_COUNT][5] = {
-			{ cs_v_cost_row, cs_v_find_min_local, cs_v_find_min_global, cs_v_backtrace, cs_v_remove_seam },
-			{ cs_h_cost_col, cs_h_find_min_local, cs_h_find_min_global, cs_h_backtrace, cs_h_remove_seam },
-		};
-
-		for (u32 i = 0; i < SC_AXIS_MAX_COUNT; ++i) {
-			gpu->seam_passes[i].prog_cost = gl_compute_program_create(compute_shaders[i][0]);
-			gpu->seam_passes[i].prog_find_min_local = gl_compute_program_create(compute_shaders[i][1]);
-			gpu->seam_passes[i].prog_find_min_global = gl_compute_program_create(compute_shaders[i][2]);
-			gpu->seam_passes[i].prog_backtrace = gl_compute_program_create(compute_shaders[i][3]);
-			gpu->seam_passes[i].prog_remove_seam = gl_compute_program_create(compute_shaders[i][4]);
-		}
-	}
-
-	auto sc_gpu_release(SC_GpuResource *gpu) noexcept -> void {
-		for (u32 i = 0; i < SC_AXIS_MAX_COUNT; ++i) {
-			gl_program_destroy(gpu->seam_passes[i].prog_remove_seam);
-			gl_program_destroy(gpu->seam_passes[i].prog_backtrace);
-			gl_program_destroy(gpu->seam_passes[i].prog_find_min_global);
-			gl_program_destroy(gpu->seam_passes[i].prog_find_min_local);
-			gl_program_destroy(gpu->seam_passes[i].prog_cost);
-		}
-
-		gl_program_destroy(gpu->prog_sobel);
-		gl_program_destroy(gpu->prog_srgb_to_linear);
-		gl_program_destroy(gpu->prog_display);
-
-		gl_texture_destroy(gpu->tex_energy);
-		gl_texture_destroy(gpu->tex_original);
-		gl_texture_destroy(gpu->tex_scratch[1]);
-		gl_texture_destroy(gpu->tex_scratch[0]);
-
-		gl_buffer_destroy(gpu->ssbo_min_index);
-		gl_buffer_destroy(gpu->ssbo_seam);
-		gl_buffer_destroy(gpu->ssbo_cost);
-
-		gl_buffer_destroy(gpu->ubo_carve);
-		gl_buffer_destroy(gpu->ubo_display);
-
-		glDeleteQueries(static_cast<GLsizei>(array_size(gpu->time_queries)), gpu->time_queries);
-		glDeleteVertexArrays(1, &gpu->empty_vao);
-	}
-
 	auto sc_create(SC_Config const *cfg) noexcept -> SC_Context * {
+		u64 const start_time_us = os_now_microseconds();
 		constexpr ArenaParams params = {
 			.reserve_size = ARENA_DEFAULT_RESERVE_SIZE,
-			.commit_size = ARENA_DEFAULT_COMMIT_SIZE
+			.commit_size = ARENA_DEFAULT_COMMIT_SIZE,
+			.keep_size = ARENA_DEFAULT_KEEP_SIZE
 		};
 		Arena *global_arena = arena_alloc(&params);
 		Arena *image_arena = arena_alloc(&params);
+		Arena *save_arena = arena_alloc(&params);
+		arena_set_name(global_arena, "global");
+		arena_set_name(image_arena, "image");
+		arena_set_name(save_arena, "save");
 
 		SC_Context *sc = arena_push_type<SC_Context>(global_arena);
 		sc->global_arena = global_arena;
 		sc->image_arena = image_arena;
+		sc->save.arena = save_arena;
 
+		b8 const is_batch = cfg->input_path.size > 0 || cfg->input_list_path.size > 0;
 		OS_Handle const window = os_window_open(
 			str8_literal("Parallelized Seam Carving (GPU Compute)"),
 			0, 0, cfg->win_width, cfg->win_height,
-			OS_WINDOW_FLAG_CENTER
+			is_batch || cfg->autotune ? OS_WINDOW_FLAG_HIDDEN : OS_WINDOW_FLAG_CENTER
 		);
 		if (window == os_handle_invalid()) {
+			arena_release(save_arena);
+			arena_release(image_arena);
 			arena_release(global_arena);
 			return nullptr;
 		}
 		sc->window = window;
+		u64 const window_time_us = os_now_microseconds();
 
 		gladLoaderLoadGL();
 
@@ -215,38 +160,67 @@ namespace {
 		glDebugMessageControl(GL_DONT_CARE, GL_DONT_CARE, GL_DEBUG_SEVERITY_NOTIFICATION, 0, nullptr, GL_FALSE);
 #endif
 
-		sc_gpu_alloc(&sc->gpu, cfg->max_texture_size);
+		u64 const gl_time_us = os_now_microseconds();
+		sc_shader_cache_init(&sc->shader_cache, global_arena, cfg->shader_cache_path);
+		sc_carver_init(&sc->carver, cfg->max_texture_size, &sc->shader_cache);
+		u64 const carver_time_us = os_now_microseconds();
 		imgui_init(window);
 
 		stbi_set_flip_vertically_on_load(true);
-		stbi_flip_vertically_on_write(true);
+		sc->save_params = {
+			.pool = job_pool_alloc(os_get_system_info()->logical_processor_count),
+			.png_level = glm::clamp(cfg->png_level, 0, SC_PNG_MAX_LEVEL)
+		};
 
-		sc->max_texture_size = cfg->max_texture_size;
-		sc->tex_src = sc->gpu.tex_scratch[0];
-		sc->tex_dst = sc->gpu.tex_scratch[1];
 		sc->current_view = SC_DebugView::NONE;
+		sc->carver.seams_per_pass = glm::clamp(cfg->seams_per_pass, 1, SC_MAX_SEAMS_PER_PASS);
+		if (cfg->proxy_scale > 1) {
+			sc->carver.proxy_scale = glm::min(cfg->proxy_scale, SC_PROXY_MAX_SCALE);
+			sc->carver.flags |= SC_CARVE_FLAG_PROXY;
+		}
 		sc->flags = SC_FLAG_SHOW_GUI | SC_FLAG_VSYNC_ENABLED;
-		os_window_swap_interval(1);
+		if (is_batch) {
+			sc->flags = (sc->flags & ~(SC_FLAG_SHOW_GUI | SC_FLAG_VSYNC_ENABLED)) | SC_FLAG_BATCH;
+		}
+		os_window_swap_interval(is_batch ? 0 : 1);
 		sc->plot_capacity = static_cast<u32>(cfg->max_texture_size) * 2;
 		sc->plot_history = arena_push_type_array<f32>(global_arena, sc->plot_capacity);
 
+		if (cfg->verbose) {
+			u64 const end_time_us = os_now_microseconds();
+			std::printf(
+				"Startup %.2f ms: window %.2f ms, GL %.2f ms, carver %.2f ms (programs %.2f ms, %u cached, %u compiled), UI %.2f ms\n",
+				static_cast<f64>(end_time_us - start_time_us) / 1000.0,
+				static_cast<f64>(window_time_us - start_time_us) / 1000.0,
+				static_cast<f64>(gl_time_us - window_time_us) / 1000.0,
+				static_cast<f64>(carver_time_us - gl_time_us) / 1000.0,
+				static_cast<f64>(sc->shader_cache.create_time_us) / 1000.0,
+				sc->shader_cache.load_count,
+				sc->shader_cache.compile_count,
+				static_cast<f64>(end_time_us - carver_time_us) / 1000.0
+			);
+		}
 		return sc;
 	}
 
 	auto sc_destroy(SC_Context *sc) noexcept -> void {
 		imgui_shutdown();
-		sc_gpu_release(&sc->gpu);
+		sc_readback_release(&sc->save.readback);
+		sc_carver_release(&sc->carver);
+		sc_shader_cache_release(&sc->shader_cache);
+		job_pool_release(sc->save_params.pool);
 		os_window_close(sc->window);
+		arena_release(sc->save.arena);
+		arena_release(sc->image_arena);
 		arena_release(sc->global_arena);
 	}
 
-	auto sc_update_carve_params(SC_Context *sc, s32 current_iteration) noexcept -> void {
-		SC_CarveParams const params = {
-			.current_size = { sc->current_width, sc->current_height },
-			.texture_size = { sc->max_texture_size, sc->max_texture_size },
-			.current_iteration = current_iteration
-		};
-		glNamedBufferSubData(sc->gpu.ubo_carve, 0, sizeof(SC_CarveParams), &params);
+	auto sc_report_error(SC_Context *sc, String8 message) noexcept -> void {
+		if ((sc->flags & SC_FLAG_BATCH) != 0) {
+			(void)std::fprintf(stderr, "Error: %.*s\n", static_cast<int>(message.size), message.data);
+		} else {
+			os_show_dialog(sc->window, OS_DialogIcon::ICON_ERROR, str8_literal("Error"), message);
+		}
 	}
 
 	auto sc_reset_image(SC_Context *sc) noexcept -> void {
@@ -254,27 +228,12 @@ namespace {
 			return;
 		}
 
-		sc->current_width = sc->original_width;
-		sc->current_height = sc->original_height;
 		sc->seam_count_vertical = 0;
 		sc->seam_count_horizontal = 0;
 		sc->carve_time_us = 0;
 		sc->plot_count = 0;
 		sc->flags &= ~SC_FLAG_IS_CARVING;
-
-		glUseProgram(sc->gpu.prog_srgb_to_linear);
-		sc_update_carve_params(sc, 0);
-		glBindBufferBase(GL_UNIFORM_BUFFER, 0, sc->gpu.ubo_carve);
-		glBindTextureUnit(0, sc->gpu.tex_original);
-		glBindImageTexture(0, sc->gpu.tex_scratch[0], 0, GL_FALSE, 0, GL_WRITE_ONLY, GL_RGBA8);
-		glDispatchCompute((sc->original_width + 7) / 8, (sc->original_height + 7) / 8, 1);
-		glMemoryBarrier(GL_SHADER_IMAGE_ACCESS_BARRIER_BIT | GL_TEXTURE_FETCH_BARRIER_BIT);
-
-		sc->tex_src = sc->gpu.tex_scratch[0];
-		sc->tex_dst = sc->gpu.tex_scratch[1];
-
-		constexpr s32 clear_value = -1;
-		glClearNamedBufferData(sc->gpu.ssbo_seam, GL_R32I, GL_RED_INTEGER, GL_INT, &clear_value);
+		sc_carver_reset(&sc->carver);
 	}
 
 	auto sc_start_carve(SC_Context *sc) noexcept -> void {
@@ -282,169 +241,113 @@ namespace {
 		sc->seam_count_horizontal = 0;
 		sc->carve_time_us = 0;
 		sc->flags |= SC_FLAG_IS_CARVING;
+		sc_carver_begin(&sc->carver);
 
-		for (b8 &in_flight : sc->gpu.time_queries_in_flight) {
+		for (b8 &in_flight : sc->carver.gpu.time_queries_in_flight) {
 			in_flight = false;
 		}
 	}
 
-	auto sc_carve_seam(SC_Context *sc, SC_Axis axis) noexcept -> void {
-		s32 const width = sc->current_width;
-		s32 const height = sc->current_height;
-		s32 const major_dim = axis == SC_AXIS_VERTICAL ? width : height;
-		s32 const minor_dim = axis == SC_AXIS_VERTICAL ? height : width;
-
-		glBindBufferBase(GL_UNIFORM_BUFFER, 0, sc->gpu.ubo_carve);
-		glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 0, sc->gpu.ssbo_cost);
-		glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 2, sc->gpu.ssbo_min_index);
-
-		SC_SeamPassShaders const *passes = &sc->gpu.seam_passes[static_cast<u32>(axis)];
-
-		// NOTE(Dedrick): Sobel energy calculation.
-		glUseProgram(sc->gpu.prog_sobel);
-		sc_update_carve_params(sc, 0);
-		glBindTextureUnit(0, sc->tex_src);
-		glBindImageTexture(0, sc->gpu.tex_energy, 0, GL_FALSE, 0, GL_WRITE_ONLY, GL_R32F);
-		glDispatchCompute((width + 7) / 8, (height + 7) / 8, 1);
-		glMemoryBarrier(GL_SHADER_IMAGE_ACCESS_BARRIER_BIT | GL_TEXTURE_FETCH_BARRIER_BIT);
-
-		// NOTE(Dedrick): Cost map (DP).
-		glUseProgram(passes->prog_cost);
-		glBindTextureUnit(1, sc->gpu.tex_energy);
-		for (s32 i = 0; i < minor_dim; ++i) {
-			sc_update_carve_params(sc, i);
-			glDispatchCompute((major_dim + REDUCTION_WORKGROUP_SIZE - 1) / REDUCTION_WORKGROUP_SIZE, 1, 1);
-			glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT);
-		}
-
-		// NOTE(Dedrick): Find minimum seam (2-pass reduction).
-		s32 const num_groups = (major_dim + REDUCTION_WORKGROUP_SIZE - 1) / REDUCTION_WORKGROUP_SIZE;
-		glUseProgram(passes->prog_find_min_local);
-		sc_update_carve_params(sc, 0);
-		glDispatchCompute(num_groups, 1, 1);
-		glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT);
-
-		glUseProgram(passes->prog_find_min_global);
-		glDispatchCompute(1, 1, 1);
-		glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT);
-
-		// NOTE(Dedrick): Seam back-tracing.
-		glUseProgram(passes->prog_backtrace);
-		glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 1, sc->gpu.ssbo_seam);
-		glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 2, sc->gpu.ssbo_min_index);
-		for (s32 i = minor_dim - 1; i >= 0; --i) {
-			sc_update_carve_params(sc, i);
-			glDispatchCompute(1, 1, 1);
-			glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT);
-		}
-
-		// NOTE(Dedrick): Remove seam.
-		glUseProgram(passes->prog_remove_seam);
-		sc_update_carve_params(sc, 0);
-		glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 0, sc->gpu.ssbo_seam);
-		glBindImageTexture(0, sc->tex_src, 0, GL_FALSE, 0, GL_READ_ONLY, GL_RGBA8);
-		glBindImageTexture(1, sc->tex_dst, 0, GL_FALSE, 0, GL_WRITE_ONLY, GL_RGBA8);
-
-		s32 const dispatch_w = axis == SC_AXIS_VERTICAL ? width - 1 : width;
-		s32 const dispatch_h = axis == SC_AXIS_VERTICAL ? height : height - 1;
-		glDispatchCompute((dispatch_w + 7) / 8, (dispatch_h + 7) / 8, 1);
-		glMemoryBarrier(GL_SHADER_IMAGE_ACCESS_BARRIER_BIT);
-
-		swap(&sc->tex_src, &sc->tex_dst);
-		if (axis == SC_AXIS_VERTICAL) {
-			sc->current_width -= 1;
-		}
-		else {
-			sc->current_height -= 1;
-		}
-	}
-
-	auto sc_load_image_from_file(SC_Context *sc, String8 file_path) noexcept -> void {
-		s32 width = 0;
-		s32 height = 0;
-		s32 channels = 0;
-		u8 *const data = stbi_load(reinterpret_cast<char const *>(file_path.data), &width, &height, &channels, 4);
-		if (data == nullptr) {
-			ScratchArena const scratch = arena_scratch_begin(tc_get_scratch(nullptr, 0));
-			String8 const msg = str8f(
-				scratch.arena,
-				"Failed to load image: %s",
-				reinterpret_cast<char const *>(file_path.data)
-			);
-			os_show_dialog(sc->window, OS_DialogIcon::ICON_ERROR, str8_literal("Error"), msg);
-			arena_scratch_end(scratch);
-			return;
-		}
-
-		if (width > sc->max_texture_size || height > sc->max_texture_size) {
+	/// Uploads decoded pixels and makes them the current image.
+	auto sc_load_image(SC_Context *sc, SC_Image image, String8 file_path) noexcept -> b8 {
+		if (image.width > sc->carver.max_texture_size || image.height > sc->carver.max_texture_size) {
 			ScratchArena const scratch = arena_scratch_begin(tc_get_scratch(nullptr, 0));
 			String8 const msg = str8f(
 				scratch.arena,
 				"Image too large (%dx%d). Max supported is %dx%d.",
-				width, height, sc->max_texture_size, sc->max_texture_size
+				image.width, image.height, sc->carver.max_texture_size, sc->carver.max_texture_size
 			);
-			os_show_dialog(sc->window, OS_DialogIcon::ICON_ERROR, str8_literal("Error"), msg);
+			sc_report_error(sc, msg);
 			arena_scratch_end(scratch);
-			stbi_image_free(data);
-			return;
+			return false;
 		}
 
-		glTextureSubImage2D(sc->gpu.tex_original, 0, 0, 0, width, height, GL_RGBA, GL_UNSIGNED_BYTE, data);
-		stbi_image_free(data);
+		sc_carver_load_image(&sc->carver, image.pixels, image.width, image.height);
 
 		arena_clear(sc->image_arena);
 		sc->image_path = str8_copy(sc->image_arena, file_path);
-		sc->original_width = width;
-		sc->original_height = height;
-		sc->target_width = width;
-		sc->target_height = height;
+		sc->target_width = image.width;
+		sc->target_height = image.height;
 		sc->flags |= SC_FLAG_HAS_IMAGE;
 		sc_reset_image(sc);
+		return true;
 	}
 
-	auto sc_linear_to_srgb(f32 c) noexcept -> u8 {
-		c = (c <= 0.0031308f) ? (c * 12.92f) : (1.055f * glm::pow(c, 1.0f / 2.4f) - 0.055f);
-		return static_cast<u8>(glm::clamp(c, 0.0f, 1.0f) * 255.0f);
+	auto sc_load_image_from_file(SC_Context *sc, String8 file_path) noexcept -> void {
+		DK_PROFILE_SCOPE("load");
+		// NOTE(Dedrick): Everything stb allocates while decoding is thrown away with the scratch arena.
+		ScratchArena const scratch = arena_scratch_begin(tc_get_scratch(nullptr, 0));
+		SC_Image const image = sc_image_load(scratch.arena, file_path);
+		if (image.pixels != nullptr) {
+			sc_load_image(sc, image, file_path);
+		} else {
+			String8 const msg = str8f(
+				scratch.arena,
+				"Failed to load image: %s",
+				reinterpret_cast<char const *>(file_path.data)
+			);
+			sc_report_error(sc, msg);
+		}
+		arena_scratch_end(scratch);
 	}
 
-	auto sc_save_image_to_file(SC_Context *sc, String8 file_path, u32 filter_index) noexcept -> void {
-		s32 const width = sc->current_width;
-		s32 const height = sc->current_height;
-		u64 const byte_count = static_cast<u64>(width) * height * 4;
-
-		// NOTE(Dedrick): Image size can be huge. It's better to allocate specifically
-		// for these images and free the memory after to keep program memory usage low.
-		// NOTE(Dedrick): Unlikely that the user will save images out. Migrate to GPU
-		// implementation only if it is a frequent action taken by the user.
-
-		u8 *const linear_data = static_cast<u8 *>(std::malloc(byte_count * 2));
-		u8 *const srgb_data = linear_data + byte_count;
-
-		glGetTextureSubImage(
-			sc->tex_src,
-			0,
-			0, 0, 0,
-			width, height, 1,
-			GL_RGBA,
-			GL_UNSIGNED_BYTE,
-			static_cast<GLsizei>(byte_count),
-			linear_data
+	auto sc_report_save_error(SC_Context *sc, String8 file_path) noexcept -> void {
+		ScratchArena const scratch = arena_scratch_begin(tc_get_scratch(nullptr, 0));
+		String8 const msg = str8f(
+			scratch.arena,
+			"Failed to save image: %s",
+			reinterpret_cast<char const *>(file_path.data)
 		);
+		sc_report_error(sc, msg);
+		arena_scratch_end(scratch);
+	}
 
-		for (usize i = 0; i < byte_count; i += 4) {
-			srgb_data[i + 0] = sc_linear_to_srgb(static_cast<f32>(linear_data[i + 0]) / 255.0f);
-			srgb_data[i + 1] = sc_linear_to_srgb(static_cast<f32>(linear_data[i + 1]) / 255.0f);
-			srgb_data[i + 2] = sc_linear_to_srgb(static_cast<f32>(linear_data[i + 2]) / 255.0f);
-			srgb_data[i + 3] = linear_data[i + 3];
-		}
+	auto sc_save_encode_main(void *params) noexcept -> void {
+		SC_Save *save = static_cast<SC_Save *>(params);
+		profile_set_thread_name("Save");
+		SC_Image const image = {
+			.pixels = save->readback.mapped,
+			.width = save->readback.width,
+			.height = save->readback.height
+		};
+		save->saved = sc_image_save(save->path, image, save->format, save->params);
+		save->encoded.store(true, std::memory_order_release);
+	}
 
-		if (filter_index == 1) {
-			stbi_write_jpg(reinterpret_cast<char const *>(file_path.data), width, height, 4, srgb_data, 90);
-		} else {
-			stbi_write_png(reinterpret_cast<char const *>(file_path.data), width, height, 4, srgb_data, width * 4);
+	/// Moves the save in flight along, `wait` finishes it before returning.
+	auto sc_update_save(SC_Context *sc, b8 wait) noexcept -> void {
+		SC_Save *save = &sc->save;
+		if (save->state == SC_SaveState::READBACK && sc_readback_poll(&save->readback, wait)) {
+			save->encoded.store(false, std::memory_order_relaxed);
+			save->thread = os_thread_launch(sc_save_encode_main, save);
+			if (save->thread == os_handle_invalid()) {
+				sc_save_encode_main(save);
+			}
+			save->state = SC_SaveState::ENCODE;
+		}
+		if (save->state == SC_SaveState::ENCODE && (wait || save->encoded.load(std::memory_order_acquire))) {
+			os_thread_join(save->thread);
+			save->thread = os_handle_invalid();
+			save->state = SC_SaveState::IDLE;
+			if (!save->saved) {
+				sc_report_save_error(sc, save->path);
+			}
 		}
+	}
 
-		std::free(linear_data);
+	/// Starts saving the carved image, it is written over the next frames.
+	auto sc_save_image_to_file(SC_Context *sc, String8 file_path, SC_ImageFormat format) noexcept -> void {
+		// NOTE(Dedrick): The readback buffer is reused, a save started while another is in flight
+		// waits for it. Unlikely with a file dialog in between.
+		sc_update_save(sc, true);
+
+		SC_Save *save = &sc->save;
+		arena_clear(save->arena);
+		save->path = str8_copy(save->arena, file_path);
+		save->format = format;
+		save->params = &sc->save_params;
+		sc_carver_read_pixels_async(&sc->carver, &save->readback);
+		save->state = SC_SaveState::READBACK;
 	}
 
 	auto sc_gui(SC_Context *sc, Arena *frame_arena) noexcept -> void {
@@ -473,6 +376,10 @@ namespace {
 				ImGui::Text("Vertical Seams: %u", sc->seam_count_vertical);
 				ImGui::Text("Horizontal Seams: %u", sc->seam_count_horizontal);
 				ImGui::Text("Average Seam Time: %.4f ms", total_carve_time_ms / static_cast<f32>(total_seam_count));
+				if (sc->carver.seam_cost_ratio_count > 0) {
+					f64 const average_ratio = sc->carver.seam_cost_ratio_sum / static_cast<f64>(sc->carver.seam_cost_ratio_count);
+					ImGui::Text("Seam Cost vs Exact: %.4fx avg, %.4fx max", average_ratio, sc->carver.seam_cost_ratio_max);
+				}
 
 				ImGui::Separator();
 				ImGui::Text("Compute Time (ms) vs Seams Removed");
@@ -491,6 +398,46 @@ namespace {
 			} else {
 				ImGui::Text("Run a carving operation to see performance.");
 			}
+
+			if (ImGui::TreeNode("Arenas")) {
+				u64 report_count = 0;
+				ArenaReport const *reports = arena_report_collect(frame_arena, &report_count);
+				if (ImGui::BeginTable("##Arenas", 6, ImGuiTableFlags_Borders | ImGuiTableFlags_RowBg | ImGuiTableFlags_SizingFixedFit)) {
+					ImGui::TableSetupColumn("Name");
+					ImGui::TableSetupColumn("Used (KB)");
+					ImGui::TableSetupColumn("Peak (KB)");
+					ImGui::TableSetupColumn("Committed (KB)");
+					ImGui::TableSetupColumn("Commits");
+					ImGui::TableSetupColumn("Pushes");
+					ImGui::TableHeadersRow();
+					for (u64 i = 0; i < report_count; ++i) {
+						ArenaReport const *report = &reports[i];
+						ImGui::TableNextRow();
+						ImGui::TableNextColumn();
+						ImGui::TextUnformatted(report->name);
+						ImGui::TableNextColumn();
+						ImGui::Text("%.1f", static_cast<f64>(report->offset) / 1024.0);
+						ImGui::TableNextColumn();
+						ImGui::Text("%.1f", static_cast<f64>(report->stats.peak_offset) / 1024.0);
+						ImGui::TableNextColumn();
+						ImGui::Text("%.1f", static_cast<f64>(report->committed) / 1024.0);
+						ImGui::TableNextColumn();
+						ImGui::Text("%llu", static_cast<unsigned long long>(report->stats.commit_count));
+						ImGui::TableNextColumn();
+						if (report->stats.failed_push_count > 0) {
+							ImGui::Text(
+								"%llu (%llu failed)",
+								static_cast<unsigned long long>(report->stats.push_count),
+								static_cast<unsigned long long>(report->stats.failed_push_count)
+							);
+						} else {
+							ImGui::Text("%llu", static_cast<unsigned long long>(report->stats.push_count));
+						}
+					}
+					ImGui::EndTable();
+				}
+				ImGui::TreePop();
+			}
 		}
 		if (ImGui::CollapsingHeader("File", ImGuiTreeNodeFlags_DefaultOpen)) {
 			if (ImGui::Button("Load Image")) {
@@ -540,19 +487,46 @@ namespace {
 		if (ImGui::CollapsingHeader("Carving", ImGuiTreeNodeFlags_DefaultOpen)) {
 			if (!has_image) { ImGui::PushDisabled(); }
 			
-			ImGui::Text("Original: %d x %d", sc->original_width, sc->original_height);
-			ImGui::Text("Current:  %d x %d", sc->current_width, sc->current_height);
+			ImGui::Text("Original: %d x %d", sc->carver.original_width, sc->carver.original_height);
+			ImGui::Text("Current:  %d x %d", sc->carver.current_width, sc->carver.current_height);
 
 			if (is_carving) { ImGui::PushDisabled(); }
-			ImGui::SliderInt("Target Width", &sc->target_width, 1, sc->original_width);
-			ImGui::SliderInt("Target Height", &sc->target_height, 1, sc->original_height);
+			ImGui::SliderInt("Target Width", &sc->target_width, 1, sc->carver.original_width);
+			ImGui::SliderInt("Target Height", &sc->target_height, 1, sc->carver.original_height);
 			if (is_carving) { ImGui::PopDisabled(); }
 
+			if (is_carving) { ImGui::PushDisabled(); }
+			ImGui::CheckboxFlags("Proxy Carving", &sc->carver.flags, SC_CARVE_FLAG_PROXY);
+			if ((sc->carver.flags & SC_CARVE_FLAG_PROXY) != 0) {
+				ImGui::SliderInt("Proxy Scale", &sc->carver.proxy_scale, 2, SC_PROXY_MAX_SCALE);
+			}
+			if (is_carving) { ImGui::PopDisabled(); }
+
+			if ((sc->carver.flags & SC_CARVE_FLAG_PROXY) == 0) {
+				s32 *seam_search = reinterpret_cast<s32 *>(&sc->carver.seam_search);
+				char const *seam_search_names[] = { "EXACT", "PYRAMID" };
+				ImGui::Combo("Seam Search", seam_search, seam_search_names, static_cast<int>(array_size(seam_search_names)));
+				if (sc->carver.seam_search == SC_SeamSearch::PYRAMID) {
+					ImGui::SliderInt("Pyramid Levels", &sc->carver.pyramid_levels, 2, SC_PYRAMID_MAX_LEVELS);
+					// NOTE(Dedrick): The band must fit one reduction workgroup, so the limit follows the kernel profile.
+					s32 const max_band_radius = sc_band_max_radius(&sc->carver.gpu.kernels);
+					sc->carver.band_radius = glm::clamp(sc->carver.band_radius, 1, max_band_radius);
+					ImGui::SliderInt("Band Radius", &sc->carver.band_radius, 1, max_band_radius);
+					ImGui::CheckboxFlags("Measure Quality", &sc->carver.flags, SC_CARVE_FLAG_MEASURE_QUALITY);
+				} else {
+					ImGui::SliderInt("Seams Per Pass", &sc->carver.seams_per_pass, 1, SC_MAX_SEAMS_PER_PASS);
+					ImGui::CheckboxFlags("Lazy Removal", &sc->carver.flags, SC_CARVE_FLAG_LAZY_REMOVAL);
+					if ((sc->carver.flags & SC_CARVE_FLAG_LAZY_REMOVAL) != 0) {
+						ImGui::SliderInt("Compact After", &sc->carver.lazy_threshold, 1, SC_LAZY_MAX_REMOVED);
+					}
+				}
+			}
+
 			b8 const can_carve =
-				(sc->target_width != sc->current_width || sc->target_height != sc->current_height) && !is_carving;
+				(sc->target_width != sc->carver.current_width || sc->target_height != sc->carver.current_height) && !is_carving;
 			if (!can_carve) { ImGui::PushDisabled(); }
 			if (ImGui::Button("Carve")) {
-				if (sc->target_width > sc->current_width || sc->target_height > sc->current_height) {
+				if (sc->target_width > sc->carver.current_width || sc->target_height > sc->carver.current_height) {
 					sc->flags |= SC_FLAG_PENDING_RESET;
 				}
 				sc->flags |= SC_FLAG_PENDING_CARVE;
@@ -580,15 +554,15 @@ namespace {
 			return;
 		}
 
-		for (s32 i = 0; i < static_cast<s32>(array_size(sc->gpu.time_queries)); ++i) {
-			if (sc->gpu.time_queries_in_flight[i]) {
+		for (s32 i = 0; i < static_cast<s32>(array_size(sc->carver.gpu.time_queries)); ++i) {
+			if (sc->carver.gpu.time_queries_in_flight[i]) {
 				GLint query_ready = 0;
-				glGetQueryObjectiv(sc->gpu.time_queries[i], GL_QUERY_RESULT_AVAILABLE, &query_ready);
+				glGetQueryObjectiv(sc->carver.gpu.time_queries[i], GL_QUERY_RESULT_AVAILABLE, &query_ready);
 				if (query_ready) {
 					GLint64 time_ns = 0;
-					glGetQueryObjecti64v(sc->gpu.time_queries[i], GL_QUERY_RESULT, &time_ns);
+					glGetQueryObjecti64v(sc->carver.gpu.time_queries[i], GL_QUERY_RESULT, &time_ns);
 					sc->carve_time_us += time_ns / 1000;
-					sc->gpu.time_queries_in_flight[i] = false;
+					sc->carver.gpu.time_queries_in_flight[i] = false;
 
 					// NOTE(Dedrick): The values will be out of order
 					// but as a plot they will paint the right picture.
@@ -599,16 +573,16 @@ namespace {
 			}
 		}
 
-		b8 const needs_carve = sc->current_width > sc->target_width || sc->current_height > sc->target_height;
+		b8 const needs_carve = sc->carver.current_width > sc->target_width || sc->carver.current_height > sc->target_height;
 		if (!needs_carve) {
 			sc->flags &= ~SC_FLAG_IS_CARVING;
 			// NOTE(Dedrick): A few dropped queries is fine.
-			for (u32 i = 0; i < array_size(sc->gpu.time_queries); ++i) {
-				if (sc->gpu.time_queries_in_flight[i]) {
+			for (u32 i = 0; i < array_size(sc->carver.gpu.time_queries); ++i) {
+				if (sc->carver.gpu.time_queries_in_flight[i]) {
 					GLint64 time_ns = 0;
-					glGetQueryObjecti64v(sc->gpu.time_queries[i], GL_QUERY_RESULT, &time_ns);
+					glGetQueryObjecti64v(sc->carver.gpu.time_queries[i], GL_QUERY_RESULT, &time_ns);
 					sc->carve_time_us += time_ns / 1000;
-					sc->gpu.time_queries_in_flight[i] = false;
+					sc->carver.gpu.time_queries_in_flight[i] = false;
 
 					// NOTE(Dedrick): The values will be out of order
 					// but as a plot they will paint the right picture.
@@ -620,32 +594,40 @@ namespace {
 			return;
 		}
 
+		// NOTE(Dedrick): Seam programs are compiled on the first carve of their axis, frames keep
+		// being presented while they compile instead of blocking on them.
+		b8 const vertical_ready = sc->carver.current_width <= sc->target_width || sc_carver_prepare_axis(&sc->carver, SC_AXIS_VERTICAL);
+		b8 const horizontal_ready = sc->carver.current_height <= sc->target_height || sc_carver_prepare_axis(&sc->carver, SC_AXIS_HORIZONTAL);
+		if (!vertical_ready || !horizontal_ready) {
+			return;
+		}
+
 		s32 available_query_slot = -1;
-		for (s32 i = 0; i < static_cast<s32>(array_size(sc->gpu.time_queries)); ++i) {
-			if (!sc->gpu.time_queries_in_flight[i]) {
+		for (s32 i = 0; i < static_cast<s32>(array_size(sc->carver.gpu.time_queries)); ++i) {
+			if (!sc->carver.gpu.time_queries_in_flight[i]) {
 				available_query_slot = i;
 				break;
 			}
 		}
 
 		if (available_query_slot >= 0) {
-			glBeginQuery(GL_TIME_ELAPSED, sc->gpu.time_queries[available_query_slot]);
+			glBeginQuery(GL_TIME_ELAPSED, sc->carver.gpu.time_queries[available_query_slot]);
 		}
 
-		if (sc->current_width > sc->target_width) {
+		if (sc->carver.current_width > sc->target_width) {
 			sc->flags &= ~SC_FLAG_SEAM_IS_HORIZONTAL;
-			sc_carve_seam(sc, SC_AXIS_VERTICAL);
-			++sc->seam_count_vertical;
+			s32 const seam_count = sc_carve_seams(&sc->carver, SC_AXIS_VERTICAL, sc->carver.current_width - sc->target_width);
+			sc->seam_count_vertical += static_cast<u32>(seam_count);
 		}
-		if (sc->current_height > sc->target_height) {
+		if (sc->carver.current_height > sc->target_height) {
 			sc->flags |= SC_FLAG_SEAM_IS_HORIZONTAL;
-			sc_carve_seam(sc, SC_AXIS_HORIZONTAL);
-			++sc->seam_count_horizontal;
+			s32 const seam_count = sc_carve_seams(&sc->carver, SC_AXIS_HORIZONTAL, sc->carver.current_height - sc->target_height);
+			sc->seam_count_horizontal += static_cast<u32>(seam_count);
 		}
 
 		if (available_query_slot >= 0) {
 			glEndQuery(GL_TIME_ELAPSED);
-			sc->gpu.time_queries_in_flight[available_query_slot] = true;
+			sc->carver.gpu.time_queries_in_flight[available_query_slot] = true;
 		}
 	}
 
@@ -655,6 +637,7 @@ namespace {
 			u64 const current_time_us = os_now_microseconds();
 			sc->frame_time_us = current_time_us - last_time_us;
 			last_time_us = current_time_us;
+			DK_PROFILE_SCOPE("frame");
 
 			ScratchArena const scratch = arena_scratch_begin(tc_get_scratch(nullptr, 0));
 			OS_EventList const events = os_get_events(scratch.arena);
@@ -662,9 +645,12 @@ namespace {
 			f32 const content_scale = os_window_content_scale(sc->window);
 			vec2 const fb_size = content_scale * os_window_client_size(sc->window);
 
-			imgui_new_frame(content_scale);
-			sc_gui(sc, scratch.arena);
-			imgui_prepare_frame();
+			{
+				DK_PROFILE_SCOPE("ui");
+				imgui_new_frame(content_scale);
+				sc_gui(sc, scratch.arena);
+				imgui_prepare_frame();
+			}
 
 			if (sc->pending_load_path.size > 0) {
 				sc_load_image_from_file(sc, sc->pending_load_path);
@@ -672,9 +658,11 @@ namespace {
 			}
 
 			if (sc->pending_save_path.size > 0) {
-				sc_save_image_to_file(sc, sc->pending_save_path, sc->pending_save_filter_index);
+				sc_save_image_to_file(sc, sc->pending_save_path, static_cast<SC_ImageFormat>(sc->pending_save_filter_index));
 				sc->pending_save_path = {};
 			}
+			sc_update_save(sc, false);
+			sc_shader_cache_poll(&sc->shader_cache, false);
 
 			if ((sc->flags & SC_FLAG_PENDING_RESET) != 0) {
 				sc_reset_image(sc);
@@ -691,44 +679,48 @@ namespace {
 			glViewport(0, 0, static_cast<GLsizei>(fb_size.x), static_cast<GLsizei>(fb_size.y));
 			glClear(GL_COLOR_BUFFER_BIT);
 
-			if (sc->current_width > 0 || sc->current_height > 0) {
+			if (sc->carver.current_width > 0 || sc->carver.current_height > 0) {
 				if (sc->current_view == SC_DebugView::ENERGY) {
-					glUseProgram(sc->gpu.prog_sobel);
-					sc_update_carve_params(sc, 0);
-					glBindBufferBase(GL_UNIFORM_BUFFER, 0, sc->gpu.ubo_carve);
-					glBindTextureUnit(0, sc->tex_src);
-					glBindImageTexture(0, sc->gpu.tex_energy, 0, GL_FALSE, 0, GL_WRITE_ONLY, GL_R32F);
-					glDispatchCompute((sc->current_width + 7) / 8, (sc->current_height + 7) / 8, 1);
-					glMemoryBarrier(GL_SHADER_IMAGE_ACCESS_BARRIER_BIT | GL_TEXTURE_FETCH_BARRIER_BIT);
+					sc_compute_current_energy(&sc->carver);
 				}
 
-				glUseProgram(sc->gpu.prog_display);
+				GL_PROFILE_SCOPE(&sc->carver.gpu.profiler, "display");
+				glUseProgram(sc->carver.gpu.prog_display);
 
 				SC_DisplayParams params{};
 				params.window_size = fb_size;
-				params.image_size = { sc->current_width, sc->current_height };
-				params.texture_size = { sc->max_texture_size, sc->max_texture_size };
+				params.image_size = { sc->carver.current_width, sc->carver.current_height };
+				params.texture_size = { sc->carver.max_texture_size, sc->carver.max_texture_size };
 				params.debug_view_mode = static_cast<s32>(sc->current_view);
 				params.show_seam = (sc->flags & SC_FLAG_SHOW_SEAM) != 0;
 				params.is_horizontal = (sc->flags & SC_FLAG_SEAM_IS_HORIZONTAL) != 0;
-				glNamedBufferSubData(sc->gpu.ubo_display, 0, sizeof(SC_DisplayParams), &params);
+				params.seam_count = sc->carver.last_seam_count;
+				glNamedBufferSubData(sc->carver.gpu.ubo_display, 0, sizeof(SC_DisplayParams), &params);
 
-				glBindBufferBase(GL_UNIFORM_BUFFER, 0, sc->gpu.ubo_display);
-				glBindTextureUnit(0, sc->tex_src);
+				glBindBufferBase(GL_UNIFORM_BUFFER, 0, sc->carver.gpu.ubo_display);
+				glBindTextureUnit(0, sc->carver.tex_src);
+
+				sc_upload_index_map_params(&sc->carver);
+				glBindBufferBase(GL_UNIFORM_BUFFER, 2, sc->carver.gpu.ubo_index_map);
+				glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 4, sc->carver.removed_src);
 
 				if (sc->current_view == SC_DebugView::ENERGY) {
-					glBindTextureUnit(1, sc->gpu.tex_energy);
+					glBindTextureUnit(1, sc->carver.gpu.tex_energy);
 				}
 				if ((sc->flags & SC_FLAG_SHOW_SEAM) != 0) {
-					glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 0, sc->gpu.ssbo_seam);
+					glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 0, sc->carver.gpu.ssbo_seam);
 				}
 
-				glBindVertexArray(sc->gpu.empty_vao);
+				glBindVertexArray(sc->carver.gpu.empty_vao);
 				glDrawArrays(GL_TRIANGLES, 0, 3);
 			}
 
-			imgui_render_frame();
-			os_window_present(sc->window);
+			{
+				GL_PROFILE_SCOPE(&sc->carver.gpu.profiler, "present");
+				imgui_render_frame();
+				os_window_present(sc->window);
+			}
+			gl_profiler_collect(&sc->carver.gpu.profiler);
 
 			for (OS_Event const *event = events.first; event != nullptr; event = event->next) {
 				if (event->type == OS_EventType::WINDOW_CLOSE) {
@@ -737,6 +729,312 @@ namespace {
 			}
 			arena_scratch_end(scratch);
 		}
+		sc_update_save(sc, true);
+	}
+}
+
+namespace {
+	/// One image moving through the batch pipeline.
+	struct SC_BatchItem {
+		Arena *arena; ///< Holds everything of the item, cleared when the decoder reuses it.
+		u32 index; ///< Into the batch paths.
+		SC_Image image; ///< Decoded pixels, then the carved pixels read back.
+		SC_Readback readback; ///< Where the carved pixels are read back to, reused by every image of the item.
+	};
+
+	// NOTE(Dedrick): Decode -> carve -> encode, each stage on its own thread. The carve stage
+	// owns the GL context so it stays on the main thread. Only `cfg->in_flight` items exist,
+	// they cycle through the queues, so memory stays bounded however long the batch is.
+	struct SC_Batch {
+		SC_BatchPaths paths;
+		SC_ImageSaveParams const *save_params;
+		JobQueue *free_items;
+		JobQueue *decoded_items;
+		JobQueue *carved_items;
+		std::atomic<u32> failed_count;
+
+		// NOTE(Dedrick): Carve stage only. Items whose readback is still in flight, oldest first.
+		SC_BatchItem **readback_items;
+		u32 readback_capacity;
+		u32 readback_head;
+		u32 readback_count;
+	};
+
+	/// A directory or list input carves every image in it into the output directory, under the same name.
+	auto sc_batch_collect_paths(Arena *arena, SC_Config const *cfg, SC_BatchPaths *out_paths) noexcept -> b8 {
+		if (cfg->input_list_path.size > 0) {
+			return sc_batch_paths_from_list(arena, cfg->input_list_path, cfg->output_path, out_paths);
+		}
+		if (os_path_is_directory(cfg->input_path)) {
+			return sc_batch_paths_from_directory(arena, cfg->input_path, cfg->output_path, out_paths);
+		}
+		out_paths->input_paths = arena_push_type_array<String8>(arena, 1);
+		out_paths->output_paths = arena_push_type_array<String8>(arena, 1);
+		out_paths->input_paths[0] = cfg->input_path;
+		out_paths->output_paths[0] = cfg->output_path;
+		out_paths->count = 1;
+		return true;
+	}
+
+	auto sc_batch_decode_main(void *params) noexcept -> void {
+		SC_Batch *batch = static_cast<SC_Batch *>(params);
+		profile_set_thread_name("Decode");
+		for (u32 i = 0; i < batch->paths.count; ++i) {
+			auto *item = static_cast<SC_BatchItem *>(job_queue_pop(batch->free_items));
+			if (item == nullptr) {
+				break;
+			}
+			arena_clear(item->arena);
+			item->index = i;
+			item->image = sc_image_load(item->arena, batch->paths.input_paths[i]);
+			if (!job_queue_push(batch->decoded_items, item)) {
+				break;
+			}
+		}
+		job_queue_close(batch->decoded_items);
+	}
+
+	auto sc_batch_encode_main(void *params) noexcept -> void {
+		SC_Batch *batch = static_cast<SC_Batch *>(params);
+		profile_set_thread_name("Encode");
+		for (;;) {
+			auto *item = static_cast<SC_BatchItem *>(job_queue_pop(batch->carved_items));
+			if (item == nullptr) {
+				break;
+			}
+			String8 const output_path = batch->paths.output_paths[item->index];
+			if (!sc_image_save(output_path, item->image, sc_image_format_from_path(output_path), batch->save_params)) {
+				(void)std::fprintf(stderr, "Error: Failed to save image: %s\n", reinterpret_cast<char const *>(output_path.data));
+				batch->failed_count.fetch_add(1);
+			}
+			job_queue_push(batch->free_items, item);
+		}
+	}
+
+	/// Carves one decoded item and starts reading the result back into it, false if it can not be carved.
+	auto sc_batch_carve(SC_Context *sc, SC_Config const *cfg, SC_Batch *batch, SC_BatchItem *item) noexcept -> b8 {
+		String8 const input_path = batch->paths.input_paths[item->index];
+		if (item->image.pixels == nullptr) {
+			(void)std::fprintf(stderr, "Error: Failed to load image: %s\n", reinterpret_cast<char const *>(input_path.data));
+			return false;
+		}
+		if (!sc_load_image(sc, item->image, input_path)) {
+			return false;
+		}
+
+		if (cfg->target_width > 0) {
+			sc->target_width = glm::min(cfg->target_width, sc->carver.original_width);
+		}
+		if (cfg->target_height > 0) {
+			sc->target_height = glm::min(cfg->target_height, sc->carver.original_height);
+		}
+
+		u64 const start_time_us = os_now_microseconds();
+		sc_start_carve(sc);
+		while ((sc->flags & SC_FLAG_IS_CARVING) != 0) {
+			// NOTE(Dedrick): Seam programs are only used once polled, so a failed link is reported
+			// before carving with it and binaries are stored during the run instead of at exit.
+			sc_shader_cache_poll(&sc->shader_cache, false);
+			sc_update_carving(sc);
+			gl_profiler_collect(&sc->carver.gpu.profiler);
+		}
+		glFinish();
+		u64 const elapsed_us = os_now_microseconds() - start_time_us;
+
+		// NOTE(Dedrick): The pixels are only there once the readback completes, see sc_batch_finish_readbacks.
+		sc_carver_read_pixels_async(&sc->carver, &item->readback);
+		item->image = {
+			.width = sc->carver.current_width,
+			.height = sc->carver.current_height
+		};
+
+		std::printf(
+			"%s: %dx%d -> %dx%d, %u seams in %.2f ms (GPU %.2f ms)\n",
+			reinterpret_cast<char const *>(batch->paths.output_paths[item->index].data),
+			sc->carver.original_width, sc->carver.original_height,
+			sc->carver.current_width, sc->carver.current_height,
+			sc->seam_count_vertical + sc->seam_count_horizontal,
+			static_cast<f64>(elapsed_us) / 1000.0,
+			static_cast<f64>(sc->carve_time_us) / 1000.0
+		);
+		return true;
+	}
+
+	/// Hands the items whose readback completed to the encoder, in order. `wait` hands over all of them.
+	auto sc_batch_finish_readbacks(SC_Batch *batch, b8 wait) noexcept -> void {
+		while (batch->readback_count > 0) {
+			SC_BatchItem *item = batch->readback_items[batch->readback_head];
+			if (!sc_readback_poll(&item->readback, wait)) {
+				break;
+			}
+			item->image.pixels = item->readback.mapped;
+			job_queue_push(batch->carved_items, item);
+			batch->readback_head = (batch->readback_head + 1) % batch->readback_capacity;
+			batch->readback_count -= 1;
+		}
+	}
+
+	auto sc_run_batch(SC_Context *sc, SC_Config const *cfg) noexcept -> int {
+		Arena *const arena = sc->global_arena;
+		SC_Batch batch = {};
+		batch.save_params = &sc->save_params;
+		if (!sc_batch_collect_paths(arena, cfg, &batch.paths)) {
+			return 1;
+		}
+
+		u32 const item_count = glm::clamp(static_cast<u32>(glm::max(cfg->in_flight, 1)), 1u, batch.paths.count);
+		batch.free_items = job_queue_alloc(arena, item_count);
+		batch.decoded_items = job_queue_alloc(arena, item_count);
+		batch.carved_items = job_queue_alloc(arena, item_count);
+		batch.readback_items = arena_push_type_array<SC_BatchItem *>(arena, item_count);
+		batch.readback_capacity = item_count;
+
+		ArenaParams const item_params = {
+			.reserve_size = ARENA_DEFAULT_RESERVE_SIZE,
+			.commit_size = mega_bytes(1),
+			.name = "batch_item",
+			.keep_size = ARENA_DEFAULT_KEEP_SIZE
+		};
+		SC_BatchItem *items = arena_push_type_array<SC_BatchItem>(arena, item_count);
+		for (u32 i = 0; i < item_count; ++i) {
+			items[i].arena = arena_alloc(&item_params);
+			job_queue_push(batch.free_items, &items[i]);
+		}
+
+		// NOTE(Dedrick): Starts compiling the seam programs while the first images decode.
+		if (cfg->target_width > 0) {
+			sc_carver_prepare_axis(&sc->carver, SC_AXIS_VERTICAL);
+		}
+		if (cfg->target_height > 0) {
+			sc_carver_prepare_axis(&sc->carver, SC_AXIS_HORIZONTAL);
+		}
+
+		u64 const start_time_us = os_now_microseconds();
+		OS_Handle const decode_thread = os_thread_launch(sc_batch_decode_main, &batch);
+		OS_Handle const encode_thread = os_thread_launch(sc_batch_encode_main, &batch);
+		b8 const launched = decode_thread != os_handle_invalid() && encode_thread != os_handle_invalid();
+		if (!launched) {
+			(void)std::fprintf(stderr, "Error: Failed to start the batch threads.\n");
+			job_queue_close(batch.free_items);
+			job_queue_close(batch.decoded_items);
+		}
+
+		for (;;) {
+			// NOTE(Dedrick): Readbacks complete while the next image carves. They are only waited on when
+			// there is nothing to carve yet, the decoder may be waiting for the encoder to free their items.
+			auto *item = static_cast<SC_BatchItem *>(job_queue_try_pop(batch.decoded_items));
+			if (item == nullptr) {
+				sc_batch_finish_readbacks(&batch, true);
+				item = static_cast<SC_BatchItem *>(job_queue_pop(batch.decoded_items));
+			}
+			if (item == nullptr) {
+				break;
+			}
+			if (sc_batch_carve(sc, cfg, &batch, item)) {
+				u32 const tail = (batch.readback_head + batch.readback_count) % batch.readback_capacity;
+				batch.readback_items[tail] = item;
+				batch.readback_count += 1;
+			} else {
+				batch.failed_count.fetch_add(1);
+				job_queue_push(batch.free_items, item);
+			}
+			sc_batch_finish_readbacks(&batch, false);
+		}
+		sc_batch_finish_readbacks(&batch, true);
+		job_queue_close(batch.carved_items);
+		os_thread_join(encode_thread);
+		os_thread_join(decode_thread);
+		u64 const elapsed_us = os_now_microseconds() - start_time_us;
+
+		u32 const failed_count = batch.failed_count.load();
+		if (batch.paths.count > 1) {
+			f64 const elapsed_s = static_cast<f64>(elapsed_us) / 1000000.0;
+			std::printf(
+				"%u images (%u failed) in %.2f s, %.2f images/s\n",
+				batch.paths.count, failed_count, elapsed_s,
+				elapsed_s > 0.0 ? static_cast<f64>(batch.paths.count) / elapsed_s : 0.0
+			);
+		}
+
+		for (u32 i = 0; i < item_count; ++i) {
+			sc_readback_release(&items[i].readback);
+			arena_release(items[i].arena);
+		}
+		job_queue_release(batch.carved_items);
+		job_queue_release(batch.decoded_items);
+		job_queue_release(batch.free_items);
+		return launched && failed_count == 0 ? 0 : 1;
+	}
+
+	auto sc_run_autotune(SC_Context *sc) noexcept -> int {
+		// NOTE(Dedrick): The cache is left disabled when its directory cannot be created or the driver has no
+		// program binaries. Checked before timing, a profile that cannot be stored is not worth tuning.
+		if (sc->shader_cache.directory.size == 0) {
+			(void)std::fprintf(
+				stderr,
+				"Error: --autotune stores its profile in the shader cache, but the shader cache is unavailable "
+				"(the directory could not be created or the driver does not support program binaries).\n"
+			);
+			return 1;
+		}
+
+		s32 const width = glm::min(SC_AUTOTUNE_DEFAULT_WIDTH, sc->carver.max_texture_size);
+		s32 const height = glm::min(SC_AUTOTUNE_DEFAULT_HEIGHT, sc->carver.max_texture_size);
+		std::printf("Tuning kernels on a %dx%d image...\n", width, height);
+		SC_AutotuneReport report = {};
+		sc_autotune(&sc->carver, width, height, &report);
+
+		for (u32 i = 0; i < report.trial_count; ++i) {
+			SC_AutotuneTrial const *trial = &report.trials[i];
+			switch (trial->knob) {
+				case SC_AutotuneKnob::TILES: {
+					std::printf("  tiles %dx%d: %.3f ms\n", trial->kernels.tile_width, trial->kernels.tile_height, trial->time_ms);
+				} break;
+				case SC_AutotuneKnob::COST: {
+					std::printf("  cost %d: %.3f ms\n", trial->kernels.cost_size, trial->time_ms);
+				} break;
+				case SC_AutotuneKnob::REDUCTION: {
+					std::printf("  reduction %d: %.3f ms\n", trial->kernels.reduction_size, trial->time_ms);
+				} break;
+				default: break;
+			}
+		}
+		std::printf(
+			"Best: tiles %dx%d, cost %d, reduction %d\n",
+			report.best.tile_width, report.best.tile_height, report.best.cost_size, report.best.reduction_size
+		);
+
+		String8 const directory = sc->shader_cache.directory;
+		if (!sc_kernel_profile_store(&sc->shader_cache, &report.best)) {
+			(void)std::fprintf(stderr, "Error: Failed to write the kernel profile in %.*s\n", static_cast<int>(directory.size), directory.data);
+			return 1;
+		}
+		std::printf("Kernel profile written to %.*s\n", static_cast<int>(directory.size), directory.data);
+		return 0;
+	}
+}
+
+namespace {
+	auto sc_run_throughput(SC_Config const *cfg) noexcept -> int {
+		constexpr ArenaParams params = {
+			.reserve_size = ARENA_DEFAULT_RESERVE_SIZE,
+			.commit_size = ARENA_DEFAULT_COMMIT_SIZE,
+			.name = "throughput"
+		};
+		Arena *arena = arena_alloc(&params);
+
+		SC_ThroughputParams throughput = {
+			.target_width = cfg->target_width,
+			.target_height = cfg->target_height,
+			.worker_count = cfg->worker_count > 0 ? static_cast<u32>(cfg->worker_count) : os_get_system_info()->logical_processor_count,
+			.png_level = glm::clamp(cfg->png_level, 0, SC_PNG_MAX_LEVEL)
+		};
+		b8 succeeded = sc_batch_collect_paths(arena, cfg, &throughput.paths);
+		if (succeeded) {
+			succeeded = sc_batch_run_throughput(arena, &throughput);
+		}
+		arena_release(arena);
+		return succeeded ? 0 : 1;
 	}
 }
 
@@ -746,6 +1044,18 @@ extern auto entry_point(int argc, char **argv) noexcept -> int {
 		"-W", "--width",
 		"-H", "--height",
 		"-m", "--max-image-size",
+		"-i", "--input",
+		"-o", "--output",
+		"--target-width",
+		"--target-height",
+		"--proxy-scale",
+		"--seams-per-pass",
+		"--trace",
+		"--in-flight",
+		"--input-list",
+		"--workers",
+		"--png-level",
+		"--shader-cache",
 	});
 	opts.parse(argc, argv);
 
@@ -756,8 +1066,31 @@ extern auto entry_point(int argc, char **argv) noexcept -> int {
 			"  -h, --help                  Show this help message.\n"
 			"  -W, --width <int>           Window width (default: 800).\n"
 			"  -H, --height <int>          Window height (default: 600).\n"
-			"  -m, --max-image-size <int>  Maximum image size (default: 4096).\n",
-			argv[0]
+			"  -m, --max-image-size <int>  Maximum image size (default: 4096).\n"
+			"  --trace <path>              Profile and write a Chrome trace (chrome://tracing, Perfetto) at exit.\n"
+			"  --arena-report              Print the memory arenas to stderr at exit.\n"
+			"  --png-level <int>           PNG compression, 0 is fastest and %d smallest (default: %d).\n"
+			"  --shader-cache <path>       Directory for compiled shader programs (default: shader_cache).\n"
+			"  --no-shader-cache           Compile every shader program from source, without the kernel profile.\n"
+			"  --verbose                   Print startup timings.\n"
+			"  --autotune                  Time workgroup sizes on this GPU and store the fastest in the shader cache.\n"
+			"\n"
+			"Batch mode (runs without a window when --input is given):\n"
+			"  -i, --input <path>          Image to carve, or a directory to carve every image in.\n"
+			"  -o, --output <path>         Where to save the carved image (.png, .jpg), or the output directory.\n"
+			"  --target-width <int>        Target width (default: original width).\n"
+			"  --target-height <int>       Target height (default: original height).\n"
+			"  --proxy-scale <int>         Find seams on a 1/N downscaled proxy (default: off, max: %d).\n"
+			"  --seams-per-pass <int>      Seams removed per cost map, exact search only (default: 1, max: %d).\n"
+			"  --in-flight <int>           Images decoded, carved and encoded at once (default: 4).\n"
+			"  --input-list <path>         Text file with one image path per line, instead of --input.\n"
+			"  --throughput                Carve on the CPU, one image per worker, without a window or GPU.\n"
+			"  --workers <int>             Throughput workers (default: logical processor count).\n",
+			argv[0],
+			SC_PNG_MAX_LEVEL,
+			SC_PNG_DEFAULT_LEVEL,
+			SC_PROXY_MAX_SCALE,
+			SC_MAX_SEAMS_PER_PASS
 		);
 		return 0;
 	}
@@ -766,6 +1099,53 @@ extern auto entry_point(int argc, char **argv) noexcept -> int {
 	opts({ "-W", "--width" }, 800) >> cfg.win_width;
 	opts({ "-H", "--height" }, 600) >> cfg.win_height;
 	opts({ "-m", "--max-image-size" }, 4096) >> cfg.max_texture_size;
+	opts({ "--target-width" }, 0) >> cfg.target_width;
+	opts({ "--target-height" }, 0) >> cfg.target_height;
+	opts({ "--proxy-scale" }, 0) >> cfg.proxy_scale;
+	opts({ "--seams-per-pass" }, 1) >> cfg.seams_per_pass;
+	opts({ "--in-flight" }, 4) >> cfg.in_flight;
+	opts({ "--workers" }, 0) >> cfg.worker_count;
+	opts({ "--png-level" }, SC_PNG_DEFAULT_LEVEL) >> cfg.png_level;
+	cfg.throughput = opts["--throughput"];
+	cfg.verbose = opts["--verbose"];
+	cfg.autotune = opts["--autotune"];
+
+	std::string const input_path = opts({ "-i", "--input" }).str();
+	std::string const output_path = opts({ "-o", "--output" }).str();
+	cfg.input_path = { .data = reinterpret_cast<u8 const *>(input_path.c_str()), .size = input_path.size() };
+	cfg.output_path = { .data = reinterpret_cast<u8 const *>(output_path.c_str()), .size = output_path.size() };
+	std::string const input_list_path = opts({ "--input-list" }).str();
+	cfg.input_list_path = { .data = reinterpret_cast<u8 const *>(input_list_path.c_str()), .size = input_list_path.size() };
+
+	std::string const shader_cache_path = opts["--no-shader-cache"] ? std::string{} : opts({ "--shader-cache" }, "shader_cache").str();
+	cfg.shader_cache_path = { .data = reinterpret_cast<u8 const *>(shader_cache_path.c_str()), .size = shader_cache_path.size() };
+
+	std::string const trace_path = opts({ "--trace" }).str();
+	cfg.trace_path = { .data = reinterpret_cast<u8 const *>(trace_path.c_str()), .size = trace_path.size() };
+	profile_set_enabled(cfg.trace_path.size > 0);
+	if (cfg.autotune && cfg.shader_cache_path.size == 0) {
+		(void)std::fprintf(stderr, "Error: --autotune stores its profile in the shader cache, it cannot run with --no-shader-cache.\n");
+		return 1;
+	}
+	if ((cfg.input_path.size > 0 || cfg.input_list_path.size > 0) && cfg.output_path.size == 0) {
+		(void)std::fprintf(stderr, "Error: --output is required with --input.\n");
+		return 1;
+	}
+
+	if (cfg.throughput) {
+		if (cfg.input_path.size == 0 && cfg.input_list_path.size == 0) {
+			(void)std::fprintf(stderr, "Error: --throughput needs --input or --input-list.\n");
+			return 1;
+		}
+		int const result = sc_run_throughput(&cfg);
+		if (cfg.trace_path.size > 0 && !profile_write_chrome_trace(cfg.trace_path)) {
+			(void)std::fprintf(stderr, "Failed to write trace: %s\n", reinterpret_cast<char const *>(cfg.trace_path.data));
+		}
+		if (opts["--arena-report"]) {
+			arena_report_print();
+		}
+		return result;
+	}
 
 	os_gfx_init();
 	SC_Context *sc = sc_create(&cfg);
@@ -774,8 +1154,26 @@ extern auto entry_point(int argc, char **argv) noexcept -> int {
 		return 1;
 	}
 
-	sc_run(sc);
+	int result = 0;
+	if (cfg.autotune) {
+		result = sc_run_autotune(sc);
+	} else if ((sc->flags & SC_FLAG_BATCH) != 0) {
+		result = sc_run_batch(sc, &cfg);
+	} else {
+		sc_run(sc);
+	}
+
+	if (cfg.trace_path.size > 0) {
+		glFinish();
+		gl_profiler_collect(&sc->carver.gpu.profiler);
+		if (!profile_write_chrome_trace(cfg.trace_path)) {
+			(void)std::fprintf(stderr, "Failed to write trace: %s\n", reinterpret_cast<char const *>(cfg.trace_path.data));
+		}
+	}
+	if (opts["--arena-report"]) {
+		arena_report_print();
+	}
 	sc_destroy(sc);
 	os_gfx_shutdown();
-	return 0;
+	return result;
 }
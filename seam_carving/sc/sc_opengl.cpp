@@ -7,6 +7,7 @@
 
 #include "base/base_assert.h"
 #include "base/base_utils.hpp"
+#include "os/os_core.hpp"
 
 #include <cstdio>
 
@@ -36,6 +37,74 @@ auto dk::gl_texture_destroy(GLuint texture) noexcept -> void {
 	glDeleteTextures(1, &texture);
 }
 
+auto dk::gl_profiler_init(GL_Profiler *profiler) noexcept -> void {
+	glCreateQueries(GL_TIMESTAMP, static_cast<GLsizei>(array_size(profiler->queries)), profiler->queries);
+	profiler->write_count = 0;
+	profiler->read_count = 0;
+
+	GLint64 gpu_time_ns = 0;
+	glGetInteger64v(GL_TIMESTAMP, &gpu_time_ns);
+	profiler->gpu_to_cpu_offset_us = static_cast<s64>(os_now_microseconds()) - gpu_time_ns / 1000;
+}
+
+auto dk::gl_profiler_release(GL_Profiler *profiler) noexcept -> void {
+	glDeleteQueries(static_cast<GLsizei>(array_size(profiler->queries)), profiler->queries);
+}
+
+auto dk::gl_profiler_begin_zone(GL_Profiler *profiler, char const *name) noexcept -> u32 {
+	if (!profile_is_enabled() || profiler->write_count - profiler->read_count == GL_PROFILER_MAX_ZONES) {
+		return GL_PROFILER_INVALID_ZONE;
+	}
+	u32 const zone = static_cast<u32>(profiler->write_count % GL_PROFILER_MAX_ZONES);
+	glQueryCounter(profiler->queries[zone * 2], GL_TIMESTAMP);
+	profiler->names[zone] = name;
+	profiler->ended[zone] = false;
+	profiler->write_count += 1;
+	return zone;
+}
+
+auto dk::gl_profiler_end_zone(GL_Profiler *profiler, u32 zone) noexcept -> void {
+	if (zone == GL_PROFILER_INVALID_ZONE) {
+		return;
+	}
+	glQueryCounter(profiler->queries[zone * 2 + 1], GL_TIMESTAMP);
+	profiler->ended[zone] = true;
+}
+
+auto dk::gl_profiler_collect(GL_Profiler *profiler) noexcept -> void {
+	// NOTE(Dedrick): Zones complete in submission order, the first one still pending ends the walk.
+	while (profiler->read_count < profiler->write_count) {
+		u32 const zone = static_cast<u32>(profiler->read_count % GL_PROFILER_MAX_ZONES);
+		if (!profiler->ended[zone]) {
+			break;
+		}
+		GLint available = GL_FALSE;
+		glGetQueryObjectiv(profiler->queries[zone * 2 + 1], GL_QUERY_RESULT_AVAILABLE, &available);
+		if (available != GL_TRUE) {
+			break;
+		}
+
+		GLuint64 begin_ns = 0;
+		GLuint64 end_ns = 0;
+		glGetQueryObjectui64v(profiler->queries[zone * 2], GL_QUERY_RESULT, &begin_ns);
+		glGetQueryObjectui64v(profiler->queries[zone * 2 + 1], GL_QUERY_RESULT, &end_ns);
+		profile_push_event(
+			PROFILE_TRACK_GPU,
+			profiler->names[zone],
+			static_cast<u64>(static_cast<s64>(begin_ns / 1000) + profiler->gpu_to_cpu_offset_us),
+			static_cast<u64>(static_cast<s64>(end_ns / 1000) + profiler->gpu_to_cpu_offset_us)
+		);
+		profiler->read_count += 1;
+	}
+
+	// NOTE(Dedrick): Recalibrate once drained, so clock drift never builds up across a long session.
+	if (profiler->read_count == profiler->write_count && profile_is_enabled()) {
+		GLint64 gpu_time_ns = 0;
+		glGetInteger64v(GL_TIMESTAMP, &gpu_time_ns);
+		profiler->gpu_to_cpu_offset_us = static_cast<s64>(os_now_microseconds()) - gpu_time_ns / 1000;
+	}
+}
+
 auto dk::gl_compile_shader_stage(String8 source, GLenum type) noexcept -> GLuint {
 	DK_ASSERT(source.data != nullptr && source.size > 0);
 
@@ -69,6 +138,8 @@ auto dk::gl_link_shader_programs(GLuint const *shaders, u32 shader_count) noexce
 	DK_ASSERT(shaders != nullptr && shader_count > 0);
 
 	GLuint const program = glCreateProgram();
+	// NOTE(Dedrick): Lets the driver keep what glGetProgramBinary needs, see sc_shader_cache.
+	glProgramParameteri(program, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
 	for (u32 i = 0; i < shader_count; ++i) {
 		glAttachShader(program, shaders[i]);
 	}
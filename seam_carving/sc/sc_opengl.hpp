@@ -5,11 +5,25 @@
 
 #pragma once
 
+#include "base/base_profile.hpp"
 #include "base/base_strings.hpp"
 
 #include <glad/gl.h>
 
 namespace dk {
+	constexpr u32 GL_PROFILER_MAX_ZONES = 2048; ///< Zones in flight, new zones are dropped while it is full.
+	constexpr u32 GL_PROFILER_INVALID_ZONE = ~0u;
+
+	/// GPU zones from GL_TIMESTAMP query pairs, resolved without stalling in `gl_profiler_collect`.
+	struct GL_Profiler {
+		GLuint queries[GL_PROFILER_MAX_ZONES * 2]; ///< (begin, end) per zone.
+		char const *names[GL_PROFILER_MAX_ZONES];
+		b8 ended[GL_PROFILER_MAX_ZONES];
+		u64 write_count;
+		u64 read_count;
+		s64 gpu_to_cpu_offset_us; ///< Added to GPU timestamps to land on `os_now_microseconds`.
+	};
+
 	auto gl_buffer_create(u64 size, GLbitfield flags, void const *data) noexcept -> GLuint ;
 
 	auto gl_buffer_destroy(GLuint buffer) noexcept -> void ;
@@ -28,6 +42,33 @@ namespace dk {
 
 	auto gl_program_destroy(GLuint program) noexcept -> void ;
 
+	auto gl_profiler_init(GL_Profiler *profiler) noexcept -> void;
+
+	auto gl_profiler_release(GL_Profiler *profiler) noexcept -> void;
+
+	/// Returns GL_PROFILER_INVALID_ZONE when profiling is off or the profiler is full.
+	auto gl_profiler_begin_zone(GL_Profiler *profiler, char const *name) noexcept -> u32;
+
+	auto gl_profiler_end_zone(GL_Profiler *profiler, u32 zone) noexcept -> void;
+
+	/// Moves finished zones to the calling thread's profile ring, in submission order.
+	auto gl_profiler_collect(GL_Profiler *profiler) noexcept -> void;
+
+	struct GL_ProfileScope {
+		GL_Profiler *profiler;
+		u32 zone;
+
+		GL_ProfileScope(GL_Profiler *zone_profiler, char const *name) noexcept
+			: profiler(zone_profiler), zone(gl_profiler_begin_zone(zone_profiler, name)) {}
+
+		~GL_ProfileScope() noexcept {
+			gl_profiler_end_zone(profiler, zone);
+		}
+
+		GL_ProfileScope(GL_ProfileScope const &) = delete;
+		auto operator=(GL_ProfileScope const &) -> GL_ProfileScope & = delete;
+	};
+
 	auto gl_debug_callback(
 		GLenum source,
 		GLenum type,
@@ -38,3 +79,12 @@ namespace dk {
 		void const *user
 	) noexcept -> void;
 }
+
+#if DK_PROFILE
+/// CPU and GPU zone over the rest of the enclosing scope. `name` must be a string literal.
+#	define GL_PROFILE_SCOPE(profiler, name) \
+		DK_PROFILE_SCOPE(name); \
+		::dk::GL_ProfileScope const DK_PROFILE_CONCAT(gl_profile_scope_, __LINE__){ (profiler), "" name }
+#else
+#	define GL_PROFILE_SCOPE(profiler, name) ((void)0)
+#endif
@@ -0,0 +1,604 @@
+/*
+ * Copyright (C) 2025 Koh Swee Teck Dedrick.
+ * Licensed under the Apache License, Version 2.0 (http://www.apache.org/licenses/LICENSE-2.0)
+ */
+
+#include "sc_png.hpp"
+
+#include "base/base_assert.h"
+#include "base/base_math.hpp"
+#include "base/base_profile.hpp"
+#include "base/base_utils.hpp"
+
+#include <atomic>
+#include <cstring>
+
+namespace {
+	using namespace dk;
+
+	constexpr u64 SC_PNG_STRIP_SIZE = kilo_bytes(128); ///< Filtered bytes per strip, a strip is at least one row.
+	constexpr u32 SC_DEFLATE_WINDOW_SIZE = 32768;
+	constexpr u32 SC_DEFLATE_MIN_MATCH = 3;
+	constexpr u32 SC_DEFLATE_MAX_MATCH = 258;
+	constexpr u32 SC_DEFLATE_MAX_STORED = 65535;
+	constexpr u32 SC_DEFLATE_HASH_BITS = 15;
+	constexpr u32 SC_DEFLATE_END_OF_BLOCK = 256;
+	constexpr u32 SC_ADLER_MOD = 65521;
+	constexpr u32 SC_ADLER_MAX_RUN = 5552; ///< Bytes summed before the sums could overflow 32 bits.
+
+	enum SC_PngFilter : u8 {
+		SC_PNG_FILTER_NONE = 0,
+		SC_PNG_FILTER_SUB,
+		SC_PNG_FILTER_UP,
+		SC_PNG_FILTER_AVERAGE,
+		SC_PNG_FILTER_PAETH,
+		SC_PNG_FILTER_COUNT
+	};
+
+	struct SC_DeflateLevel {
+		u32 max_chain; ///< Candidates tried per position.
+		u32 nice_length; ///< Stops searching once a match is this long.
+		b8 lazy; ///< Emits a literal when the next position has a longer match.
+	};
+
+	constexpr SC_DeflateLevel SC_DEFLATE_LEVELS[SC_PNG_MAX_LEVEL + 1] = {
+		{ .max_chain = 0, .nice_length = 0, .lazy = false },
+		{ .max_chain = 4, .nice_length = 16, .lazy = false },
+		{ .max_chain = 8, .nice_length = 32, .lazy = false },
+		{ .max_chain = 16, .nice_length = 64, .lazy = false },
+		{ .max_chain = 16, .nice_length = 64, .lazy = true },
+		{ .max_chain = 32, .nice_length = 128, .lazy = true },
+		{ .max_chain = 64, .nice_length = 258, .lazy = true },
+		{ .max_chain = 128, .nice_length = 258, .lazy = true },
+		{ .max_chain = 512, .nice_length = 258, .lazy = true },
+		{ .max_chain = 2048, .nice_length = 258, .lazy = true },
+	};
+
+	constexpr u16 SC_DEFLATE_LENGTH_BASE[29] = {
+		3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 15, 17, 19, 23, 27, 31,
+		35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258
+	};
+	constexpr u8 SC_DEFLATE_LENGTH_EXTRA[29] = {
+		0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2,
+		3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0
+	};
+	constexpr u16 SC_DEFLATE_DISTANCE_BASE[30] = {
+		1, 2, 3, 4, 5, 7, 9, 13, 17, 25, 33, 49, 65, 97, 129, 193,
+		257, 385, 513, 769, 1025, 1537, 2049, 3073, 4097, 6145, 8193, 12289, 16385, 24577
+	};
+	constexpr u8 SC_DEFLATE_DISTANCE_EXTRA[30] = {
+		0, 0, 0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6, 6,
+		7, 7, 8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13
+	};
+
+	/// Fixed Huffman codes, bit reversed so they can be written LSB first, and symbol lookups.
+	struct SC_DeflateTables {
+		u16 literal_codes[288];
+		u8 literal_lengths[288];
+		u16 distance_codes[30];
+		u8 length_symbols[SC_DEFLATE_MAX_MATCH + 1]; ///< Match length to length symbol - 257.
+		u8 distance_symbols[512]; ///< Distances up to 256 at [d - 1], the rest at [256 + ((d - 1) >> 7)].
+		u32 crc[256];
+	};
+
+	constexpr auto sc_reverse_bits(u32 code, u32 length) noexcept -> u16 {
+		u32 result = 0;
+		for (u32 i = 0; i < length; ++i) {
+			result = (result << 1) | ((code >> i) & 1);
+		}
+		return static_cast<u16>(result);
+	}
+
+	constexpr auto sc_deflate_tables_build() noexcept -> SC_DeflateTables {
+		SC_DeflateTables tables = {};
+		for (u32 symbol = 0; symbol < 288; ++symbol) {
+			u32 code = 0;
+			u32 length = 0;
+			if (symbol < 144) {
+				code = 0x30 + symbol;
+				length = 8;
+			} else if (symbol < 256) {
+				code = 0x190 + (symbol - 144);
+				length = 9;
+			} else if (symbol < 280) {
+				code = symbol - 256;
+				length = 7;
+			} else {
+				code = 0xC0 + (symbol - 280);
+				length = 8;
+			}
+			tables.literal_codes[symbol] = sc_reverse_bits(code, length);
+			tables.literal_lengths[symbol] = static_cast<u8>(length);
+		}
+		for (u32 symbol = 0; symbol < 30; ++symbol) {
+			tables.distance_codes[symbol] = sc_reverse_bits(symbol, 5);
+		}
+		for (u32 symbol = 0; symbol < 29; ++symbol) {
+			u32 const end = symbol + 1 < 29 ? SC_DEFLATE_LENGTH_BASE[symbol + 1] : SC_DEFLATE_MAX_MATCH + 1;
+			for (u32 length = SC_DEFLATE_LENGTH_BASE[symbol]; length < end; ++length) {
+				tables.length_symbols[length] = static_cast<u8>(symbol);
+			}
+		}
+		// NOTE(Dedrick): Symbols past 256 have at least 7 extra bits, one entry per 128 distances covers them.
+		for (u32 symbol = 0; symbol < 30; ++symbol) {
+			u32 const begin = SC_DEFLATE_DISTANCE_BASE[symbol];
+			u32 const end = begin + (1u << SC_DEFLATE_DISTANCE_EXTRA[symbol]);
+			for (u32 distance = begin; distance < end; distance += distance > 256 ? 128 : 1) {
+				u32 const index = distance <= 256 ? distance - 1 : 256 + ((distance - 1) >> 7);
+				tables.distance_symbols[index] = static_cast<u8>(symbol);
+			}
+		}
+		for (u32 n = 0; n < 256; ++n) {
+			u32 c = n;
+			for (u32 k = 0; k < 8; ++k) {
+				c = (c & 1) != 0 ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+			}
+			tables.crc[n] = c;
+		}
+		return tables;
+	}
+
+	constexpr SC_DeflateTables SC_DEFLATE_TABLES = sc_deflate_tables_build();
+
+	/// Deflate writes codes LSB first.
+	struct SC_BitWriter {
+		u8 *out;
+		u64 size;
+		u64 bits;
+		u32 bit_count;
+	};
+
+	auto sc_bits_put(SC_BitWriter *writer, u32 value, u32 count) noexcept -> void {
+		writer->bits |= static_cast<u64>(value) << writer->bit_count;
+		writer->bit_count += count;
+		while (writer->bit_count >= 8) {
+			writer->out[writer->size++] = static_cast<u8>(writer->bits);
+			writer->bits >>= 8;
+			writer->bit_count -= 8;
+		}
+	}
+
+	auto sc_bits_align(SC_BitWriter *writer) noexcept -> void {
+		if (writer->bit_count > 0) {
+			sc_bits_put(writer, 0, 8 - writer->bit_count);
+		}
+	}
+
+	/// Match finder state, one per worker.
+	struct SC_DeflateWindow {
+		s32 *head; ///< Last position of every hash, -1 when there is none.
+		s32 *prev; ///< Previous position with the same hash, one per input byte.
+		u32 inserted; ///< Positions before this one are in the hash chains.
+	};
+
+	struct SC_DeflateMatch {
+		u32 length; ///< 0 when there is no match.
+		u32 distance;
+	};
+
+	auto sc_deflate_hash(u8 const *p) noexcept -> u32 {
+		u32 const value = static_cast<u32>(p[0]) | (static_cast<u32>(p[1]) << 8) | (static_cast<u32>(p[2]) << 16);
+		return (value * 2654435761u) >> (32 - SC_DEFLATE_HASH_BITS);
+	}
+
+	auto sc_deflate_insert_to(SC_DeflateWindow *window, u8 const *data, u32 size, u32 end) noexcept -> void {
+		end = glm::min(end, size >= SC_DEFLATE_MIN_MATCH ? size - SC_DEFLATE_MIN_MATCH + 1 : 0);
+		for (; window->inserted < end; ++window->inserted) {
+			u32 const hash = sc_deflate_hash(data + window->inserted);
+			window->prev[window->inserted] = window->head[hash];
+			window->head[hash] = static_cast<s32>(window->inserted);
+		}
+	}
+
+	/// Longest earlier match of the bytes at `pos`, which must already be inserted.
+	auto sc_deflate_find_match(SC_DeflateWindow const *window, u8 const *data, u32 size, u32 pos, SC_DeflateLevel const *level) noexcept -> SC_DeflateMatch {
+		SC_DeflateMatch best = {};
+		u32 const max_length = glm::min(SC_DEFLATE_MAX_MATCH, size - pos);
+		if (max_length < SC_DEFLATE_MIN_MATCH) {
+			return best;
+		}
+
+		u8 const *current = data + pos;
+		u32 chain = level->max_chain;
+		for (s32 candidate = window->prev[pos]; candidate >= 0 && chain > 0; candidate = window->prev[candidate], --chain) {
+			u32 const distance = pos - static_cast<u32>(candidate);
+			if (distance > SC_DEFLATE_WINDOW_SIZE) {
+				break;
+			}
+			// NOTE(Dedrick): A candidate that differs at the byte past the current best can not beat it.
+			u8 const *match = data + candidate;
+			if (match[best.length] != current[best.length]) {
+				continue;
+			}
+			u32 length = 0;
+			while (length < max_length && match[length] == current[length]) {
+				length += 1;
+			}
+			if (length > best.length) {
+				best = { .length = length, .distance = distance };
+				if (length >= level->nice_length || length == max_length) {
+					break;
+				}
+			}
+		}
+		return best.length >= SC_DEFLATE_MIN_MATCH ? best : SC_DeflateMatch{};
+	}
+
+	auto sc_deflate_put_literal(SC_BitWriter *writer, u8 literal) noexcept -> void {
+		sc_bits_put(writer, SC_DEFLATE_TABLES.literal_codes[literal], SC_DEFLATE_TABLES.literal_lengths[literal]);
+	}
+
+	auto sc_deflate_put_match(SC_BitWriter *writer, SC_DeflateMatch match) noexcept -> void {
+		u32 const length_symbol = SC_DEFLATE_TABLES.length_symbols[match.length];
+		sc_bits_put(writer, SC_DEFLATE_TABLES.literal_codes[257 + length_symbol], SC_DEFLATE_TABLES.literal_lengths[257 + length_symbol]);
+		sc_bits_put(writer, match.length - SC_DEFLATE_LENGTH_BASE[length_symbol], SC_DEFLATE_LENGTH_EXTRA[length_symbol]);
+
+		u32 const distance_index = match.distance <= 256 ? match.distance - 1 : 256 + ((match.distance - 1) >> 7);
+		u32 const distance_symbol = SC_DEFLATE_TABLES.distance_symbols[distance_index];
+		sc_bits_put(writer, SC_DEFLATE_TABLES.distance_codes[distance_symbol], 5);
+		sc_bits_put(writer, match.distance - SC_DEFLATE_DISTANCE_BASE[distance_symbol], SC_DEFLATE_DISTANCE_EXTRA[distance_symbol]);
+	}
+
+	/// One non-final fixed Huffman block, followed by a sync flush so the output ends on a byte.
+	auto sc_deflate_fixed(SC_BitWriter *writer, SC_DeflateWindow *window, u8 const *data, u32 size, SC_DeflateLevel const *level) noexcept -> void {
+		std::memset(window->head, 0xFF, sizeof(s32) << SC_DEFLATE_HASH_BITS);
+		window->inserted = 0;
+
+		sc_bits_put(writer, 0b010, 3);
+		u32 pos = 0;
+		SC_DeflateMatch match = {};
+		b8 has_match = false; ///< `match` was already searched for `pos`.
+		while (pos < size) {
+			if (!has_match) {
+				sc_deflate_insert_to(window, data, size, pos + 1);
+				match = sc_deflate_find_match(window, data, size, pos, level);
+			}
+			has_match = false;
+
+			if (match.length == 0) {
+				sc_deflate_put_literal(writer, data[pos]);
+				pos += 1;
+				continue;
+			}
+			if (level->lazy && match.length < level->nice_length && pos + 1 < size) {
+				sc_deflate_insert_to(window, data, size, pos + 2);
+				SC_DeflateMatch const next = sc_deflate_find_match(window, data, size, pos + 1, level);
+				if (next.length > match.length) {
+					sc_deflate_put_literal(writer, data[pos]);
+					pos += 1;
+					match = next;
+					has_match = true;
+					continue;
+				}
+			}
+			sc_deflate_put_match(writer, match);
+			pos += match.length;
+			sc_deflate_insert_to(window, data, size, pos);
+		}
+		sc_bits_put(writer, SC_DEFLATE_TABLES.literal_codes[SC_DEFLATE_END_OF_BLOCK], SC_DEFLATE_TABLES.literal_lengths[SC_DEFLATE_END_OF_BLOCK]);
+
+		// NOTE(Dedrick): An empty stored block, the same marker zlib's Z_SYNC_FLUSH writes.
+		sc_bits_put(writer, 0, 3);
+		sc_bits_align(writer);
+		sc_bits_put(writer, 0x0000, 16);
+		sc_bits_put(writer, 0xFFFF, 16);
+	}
+
+	auto sc_deflate_stored_size(u64 size) noexcept -> u64 {
+		return size + 5 * glm::max((size + SC_DEFLATE_MAX_STORED - 1) / SC_DEFLATE_MAX_STORED, static_cast<u64>(1));
+	}
+
+	/// Non-final stored blocks, they end on a byte by themselves.
+	auto sc_deflate_stored(SC_BitWriter *writer, u8 const *data, u32 size) noexcept -> void {
+		u32 offset = 0;
+		do {
+			u32 const block_size = glm::min(size - offset, SC_DEFLATE_MAX_STORED);
+			sc_bits_put(writer, 0b000, 3);
+			sc_bits_align(writer);
+			sc_bits_put(writer, block_size, 16);
+			sc_bits_put(writer, ~block_size & 0xFFFF, 16);
+			std::memcpy(writer->out + writer->size, data + offset, block_size);
+			writer->size += block_size;
+			offset += block_size;
+		} while (offset < size);
+	}
+
+	auto sc_adler32(u32 adler, u8 const *data, u64 size) noexcept -> u32 {
+		u32 a = adler & 0xFFFF;
+		u32 b = adler >> 16;
+		while (size > 0) {
+			u64 const run = glm::min(size, static_cast<u64>(SC_ADLER_MAX_RUN));
+			for (u64 i = 0; i < run; ++i) {
+				a += data[i];
+				b += a;
+			}
+			a %= SC_ADLER_MOD;
+			b %= SC_ADLER_MOD;
+			data += run;
+			size -= run;
+		}
+		return (b << 16) | a;
+	}
+
+	/// Adler-32 of two buffers back to back, from the checksum of each and the size of the second.
+	auto sc_adler32_combine(u32 first, u32 second, u64 second_size) noexcept -> u32 {
+		u32 const remainder = static_cast<u32>(second_size % SC_ADLER_MOD);
+		u32 a = first & 0xFFFF;
+		u32 b = static_cast<u32>((static_cast<u64>(remainder) * a) % SC_ADLER_MOD);
+		a += (second & 0xFFFF) + SC_ADLER_MOD - 1;
+		b += (first >> 16) + (second >> 16) + SC_ADLER_MOD - remainder;
+		if (a >= SC_ADLER_MOD) {
+			a -= SC_ADLER_MOD;
+		}
+		if (a >= SC_ADLER_MOD) {
+			a -= SC_ADLER_MOD;
+		}
+		if (b >= SC_ADLER_MOD * 2) {
+			b -= SC_ADLER_MOD * 2;
+		}
+		if (b >= SC_ADLER_MOD) {
+			b -= SC_ADLER_MOD;
+		}
+		return (b << 16) | a;
+	}
+
+	auto sc_crc32(u8 const *data, u64 size) noexcept -> u32 {
+		u32 crc = 0xFFFFFFFFu;
+		for (u64 i = 0; i < size; ++i) {
+			crc = SC_DEFLATE_TABLES.crc[(crc ^ data[i]) & 0xFF] ^ (crc >> 8);
+		}
+		return crc ^ 0xFFFFFFFFu;
+	}
+
+	auto sc_png_put_u32(u8 *out, u32 value) noexcept -> void {
+		out[0] = static_cast<u8>(value >> 24);
+		out[1] = static_cast<u8>(value >> 16);
+		out[2] = static_cast<u8>(value >> 8);
+		out[3] = static_cast<u8>(value);
+	}
+
+	/// Fills in length, type and CRC around the `data_size` bytes already at `chunk + 8`, returns the chunk size.
+	auto sc_png_finish_chunk(u8 *chunk, char const *type, u64 data_size) noexcept -> u64 {
+		sc_png_put_u32(chunk, static_cast<u32>(data_size));
+		std::memcpy(chunk + 4, type, 4);
+		sc_png_put_u32(chunk + 8 + data_size, sc_crc32(chunk + 4, data_size + 4));
+		return data_size + 12;
+	}
+
+	auto sc_png_paeth(s32 a, s32 b, s32 c) noexcept -> u8 {
+		s32 const p = a + b - c;
+		s32 const pa = glm::abs(p - a);
+		s32 const pb = glm::abs(p - b);
+		s32 const pc = glm::abs(p - c);
+		if (pa <= pb && pa <= pc) {
+			return static_cast<u8>(a);
+		}
+		return static_cast<u8>(pb <= pc ? b : c);
+	}
+
+	/// `up` is a row of zeros for the first row of the image.
+	auto sc_png_filter_row(u8 *out, SC_PngFilter filter, u8 const *row, u8 const *up, u64 row_size) noexcept -> void {
+		switch (filter) {
+		case SC_PNG_FILTER_NONE:
+			std::memcpy(out, row, row_size);
+			break;
+		case SC_PNG_FILTER_SUB:
+			std::memcpy(out, row, 4);
+			for (u64 i = 4; i < row_size; ++i) {
+				out[i] = static_cast<u8>(row[i] - row[i - 4]);
+			}
+			break;
+		case SC_PNG_FILTER_UP:
+			for (u64 i = 0; i < row_size; ++i) {
+				out[i] = static_cast<u8>(row[i] - up[i]);
+			}
+			break;
+		case SC_PNG_FILTER_AVERAGE:
+			for (u64 i = 0; i < 4; ++i) {
+				out[i] = static_cast<u8>(row[i] - (up[i] >> 1));
+			}
+			for (u64 i = 4; i < row_size; ++i) {
+				out[i] = static_cast<u8>(row[i] - ((row[i - 4] + up[i]) >> 1));
+			}
+			break;
+		case SC_PNG_FILTER_PAETH:
+			for (u64 i = 0; i < 4; ++i) {
+				out[i] = static_cast<u8>(row[i] - up[i]);
+			}
+			for (u64 i = 4; i < row_size; ++i) {
+				out[i] = static_cast<u8>(row[i] - sc_png_paeth(row[i - 4], up[i], up[i - 4]));
+			}
+			break;
+		default:
+			DK_ASSERT(false);
+		}
+	}
+
+	/// Sum of the filtered bytes as signed values, the usual guess at which filter deflates best.
+	auto sc_png_filter_cost(u8 const *filtered, u64 size) noexcept -> u64 {
+		u64 cost = 0;
+		for (u64 i = 0; i < size; ++i) {
+			cost += static_cast<u64>(glm::abs(static_cast<s32>(static_cast<s8>(filtered[i]))));
+		}
+		return cost;
+	}
+
+	struct SC_PngStrip {
+		u32 row_begin;
+		u32 row_end;
+		u8 *chunk; ///< IDAT chunk holding this strip's part of the zlib stream.
+		u64 chunk_size;
+		u32 adler; ///< Of the filtered rows.
+		u64 filtered_size;
+	};
+
+	struct SC_PngWorker {
+		u8 *filtered; ///< Filter byte and filtered row of every row in a strip.
+		u8 *candidates[2]; ///< Row being tried and best row so far.
+		SC_DeflateWindow window;
+	};
+
+	struct SC_PngEncoder {
+		u8 const *pixels;
+		u8 const *zero_row;
+		u64 row_size;
+		SC_DeflateLevel const *level;
+		b8 store; ///< Level 0, rows are neither filtered nor compressed.
+		SC_PngStrip *strips;
+		u32 strip_count;
+		SC_PngWorker *workers;
+		u32 active_worker_count; ///< Workers past this have no buffers, there are not enough strips.
+		std::atomic<u32> next_strip;
+	};
+
+	auto sc_png_encode_strip(SC_PngEncoder const *encoder, SC_PngWorker *worker, SC_PngStrip *strip, b8 is_first) noexcept -> void {
+		DK_PROFILE_SCOPE("png_strip");
+
+		u64 const row_size = encoder->row_size;
+		u8 *filtered = worker->filtered;
+		for (u32 y = strip->row_begin; y < strip->row_end; ++y) {
+			u8 const *row = encoder->pixels + y * row_size;
+			u8 const *up = y > 0 ? row - row_size : encoder->zero_row;
+			u8 *out = filtered + static_cast<u64>(y - strip->row_begin) * (row_size + 1);
+			if (encoder->store) {
+				out[0] = SC_PNG_FILTER_NONE;
+				std::memcpy(out + 1, row, row_size);
+				continue;
+			}
+
+			SC_PngFilter best_filter = SC_PNG_FILTER_NONE;
+			u64 best_cost = ~0ull;
+			u32 best = 0;
+			for (u32 filter = SC_PNG_FILTER_NONE; filter < SC_PNG_FILTER_COUNT; ++filter) {
+				u8 *candidate = worker->candidates[best ^ 1];
+				sc_png_filter_row(candidate, static_cast<SC_PngFilter>(filter), row, up, row_size);
+				u64 const cost = sc_png_filter_cost(candidate, row_size);
+				if (cost < best_cost) {
+					best_cost = cost;
+					best_filter = static_cast<SC_PngFilter>(filter);
+					best ^= 1;
+				}
+			}
+			out[0] = best_filter;
+			std::memcpy(out + 1, worker->candidates[best], row_size);
+		}
+		strip->filtered_size = static_cast<u64>(strip->row_end - strip->row_begin) * (row_size + 1);
+		strip->adler = sc_adler32(1, filtered, strip->filtered_size);
+
+		SC_BitWriter writer = { .out = strip->chunk + 8 };
+		if (is_first) {
+			// NOTE(Dedrick): Deflate with a 32 KB window, the level hint is informational only.
+			sc_bits_put(&writer, 0x78, 8);
+			sc_bits_put(&writer, encoder->store ? 0x01 : 0x9C, 8);
+		}
+		u64 const data_begin = writer.size;
+		u32 const filtered_size = static_cast<u32>(strip->filtered_size);
+		b8 store = encoder->store;
+		if (!store) {
+			sc_deflate_fixed(&writer, &worker->window, filtered, filtered_size, encoder->level);
+			if (writer.size - data_begin > sc_deflate_stored_size(filtered_size)) {
+				writer.size = data_begin;
+				store = true;
+			}
+		}
+		if (store) {
+			sc_deflate_stored(&writer, filtered, filtered_size);
+		}
+		strip->chunk_size = sc_png_finish_chunk(strip->chunk, "IDAT", writer.size);
+	}
+
+	auto sc_png_worker(void *params, u32 worker_index, u32 worker_count) noexcept -> void {
+		(void)worker_count;
+		SC_PngEncoder *encoder = static_cast<SC_PngEncoder *>(params);
+		if (worker_index >= encoder->active_worker_count) {
+			return;
+		}
+		for (;;) {
+			u32 const index = encoder->next_strip.fetch_add(1, std::memory_order_relaxed);
+			if (index >= encoder->strip_count) {
+				break;
+			}
+			sc_png_encode_strip(encoder, &encoder->workers[worker_index], &encoder->strips[index], index == 0);
+		}
+	}
+}
+
+auto dk::sc_png_encode(Arena *arena, u8 const *pixels, s32 width, s32 height, SC_PngParams const *params) noexcept -> String8List {
+	DK_ASSERT(arena != nullptr && pixels != nullptr && params != nullptr);
+	DK_ASSERT(width > 0 && height > 0);
+	DK_PROFILE_SCOPE("png_encode");
+
+	u64 const row_size = static_cast<u64>(width) * 4;
+	u32 const rows_per_strip = static_cast<u32>(glm::clamp(SC_PNG_STRIP_SIZE / (row_size + 1), static_cast<u64>(1), static_cast<u64>(height)));
+	u64 const strip_capacity = static_cast<u64>(rows_per_strip) * (row_size + 1);
+	// NOTE(Dedrick): Fixed Huffman codes are at most 9 bits per input byte, a stored fallback is smaller still.
+	u64 const chunk_capacity = 12 + 2 + strip_capacity + strip_capacity / 8 + 64;
+
+	SC_PngEncoder encoder = {};
+	encoder.pixels = pixels;
+	encoder.zero_row = arena_push_type_array<u8>(arena, row_size);
+	encoder.row_size = row_size;
+	encoder.level = &SC_DEFLATE_LEVELS[glm::clamp(params->level, 0, SC_PNG_MAX_LEVEL)];
+	encoder.store = params->level <= 0;
+	encoder.strip_count = (static_cast<u32>(height) + rows_per_strip - 1) / rows_per_strip;
+	encoder.strips = arena_push_type_array<SC_PngStrip>(arena, encoder.strip_count);
+	for (u32 i = 0; i < encoder.strip_count; ++i) {
+		SC_PngStrip *strip = &encoder.strips[i];
+		strip->row_begin = i * rows_per_strip;
+		strip->row_end = glm::min(strip->row_begin + rows_per_strip, static_cast<u32>(height));
+		strip->chunk = static_cast<u8 *>(arena_push_no_zero(arena, chunk_capacity, 64));
+	}
+
+	u32 const worker_count = params->pool != nullptr ? params->pool->worker_count : 1;
+	encoder.active_worker_count = glm::min(worker_count, encoder.strip_count);
+	encoder.workers = arena_push_type_array<SC_PngWorker>(arena, encoder.active_worker_count);
+	for (u32 i = 0; i < encoder.active_worker_count; ++i) {
+		SC_PngWorker *worker = &encoder.workers[i];
+		worker->filtered = static_cast<u8 *>(arena_push_no_zero(arena, strip_capacity, 64));
+		worker->candidates[0] = static_cast<u8 *>(arena_push_no_zero(arena, row_size, 64));
+		worker->candidates[1] = static_cast<u8 *>(arena_push_no_zero(arena, row_size, 64));
+		if (!encoder.store) {
+			worker->window.head = arena_push_type_array<s32>(arena, 1ull << SC_DEFLATE_HASH_BITS);
+			worker->window.prev = static_cast<s32 *>(arena_push_no_zero(arena, strip_capacity * sizeof(s32), 64));
+		}
+	}
+
+	if (params->pool != nullptr && encoder.active_worker_count > 1) {
+		job_pool_run(params->pool, sc_png_worker, &encoder);
+	} else {
+		sc_png_worker(&encoder, 0, 1);
+	}
+
+	String8List result = {};
+
+	constexpr u8 signature[8] = { 0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n' };
+	u8 *header = arena_push_type_array<u8>(arena, sizeof(signature) + 25);
+	std::memcpy(header, signature, sizeof(signature));
+	u8 *ihdr = header + sizeof(signature);
+	sc_png_put_u32(ihdr + 8, static_cast<u32>(width));
+	sc_png_put_u32(ihdr + 12, static_cast<u32>(height));
+	ihdr[16] = 8; // Bit depth.
+	ihdr[17] = 6; // RGBA.
+	ihdr[18] = 0; // Deflate.
+	ihdr[19] = 0; // Adaptive filtering.
+	ihdr[20] = 0; // Not interlaced.
+	u64 const header_size = sizeof(signature) + sc_png_finish_chunk(ihdr, "IHDR", 13);
+	str8_list_push(arena, &result, { .data = header, .size = header_size });
+
+	u32 adler = 1;
+	for (u32 i = 0; i < encoder.strip_count; ++i) {
+		SC_PngStrip const *strip = &encoder.strips[i];
+		adler = sc_adler32_combine(adler, strip->adler, strip->filtered_size);
+		str8_list_push(arena, &result, { .data = strip->chunk, .size = strip->chunk_size });
+	}
+
+	// NOTE(Dedrick): The strips never set BFINAL, an empty final fixed Huffman block ends the stream.
+	u8 *trailer = arena_push_type_array<u8>(arena, 18 + 12);
+	trailer[8] = 0x03;
+	trailer[9] = 0x00;
+	sc_png_put_u32(trailer + 10, adler);
+	u64 const idat_size = sc_png_finish_chunk(trailer, "IDAT", 6);
+	u64 const iend_size = sc_png_finish_chunk(trailer + idat_size, "IEND", 0);
+	str8_list_push(arena, &result, { .data = trailer, .size = idat_size + iend_size });
+	return result;
+}
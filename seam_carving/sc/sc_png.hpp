@@ -0,0 +1,29 @@
+/*
+ * Copyright (C) 2025 Koh Swee Teck Dedrick.
+ * Licensed under the Apache License, Version 2.0 (http://www.apache.org/licenses/LICENSE-2.0)
+ */
+
+#pragma once
+
+#include "base/base_arena.hpp"
+#include "base/base_jobs.hpp"
+#include "base/base_strings.hpp"
+#include "base/base_types.hpp"
+
+namespace dk {
+	constexpr s32 SC_PNG_MAX_LEVEL = 9;
+	constexpr s32 SC_PNG_DEFAULT_LEVEL = 6;
+
+	struct SC_PngParams {
+		JobPool *pool; ///< Deflates strips on every worker, nullptr deflates them on the calling thread.
+		s32 level; ///< 0 stores the rows uncompressed, SC_PNG_MAX_LEVEL searches hardest for matches.
+	};
+
+	// NOTE(Dedrick): Rows are cut into strips of about the same size that are filtered and deflated
+	// independently, each ending on a sync flush so the strips concatenate into one zlib stream.
+	// Every strip is its own IDAT chunk and the Adler-32 of the strips is combined at the end.
+	// The strips do not depend on the worker count, so neither does the output.
+	/// Encodes tightly packed, top to bottom RGBA8 pixels. The file is the concatenation of the
+	/// returned pieces, which are pushed on `arena` with everything else the encoder needs.
+	auto sc_png_encode(Arena *arena, u8 const *pixels, s32 width, s32 height, SC_PngParams const *params) noexcept -> String8List;
+}
@@ -0,0 +1,360 @@
+/*
+ * Copyright (C) 2025 Koh Swee Teck Dedrick.
+ * Licensed under the Apache License, Version 2.0 (http://www.apache.org/licenses/LICENSE-2.0)
+ */
+
+#include "sc_shader_cache.hpp"
+
+#include "base/base_assert.h"
+#include "base/base_containers.hpp"
+#include "base/base_math.hpp"
+#include "base/base_profile.hpp"
+#include "base/base_thread_context.hpp"
+#include "base/base_utils.hpp"
+#include "os/os_core.hpp"
+#include "os/os_gfx.hpp"
+#include "sc/sc_opengl.hpp"
+
+#include <cstdio>
+#include <cstring>
+
+namespace {
+	using namespace dk;
+
+	constexpr u32 SC_SHADER_CACHE_MAGIC = 0x42504353; // "SCPB"
+	constexpr u32 SC_SHADER_CACHE_VERSION = 1;
+	constexpr u64 SC_SHADER_CACHE_HASH_SEED = 0xCBF29CE484222325ull;
+
+	// NOTE(Dedrick): GL_KHR_parallel_shader_compile is not in the generated loader, its two names are added here.
+	constexpr GLenum SC_GL_COMPLETION_STATUS_KHR = 0x91B1;
+	using SC_MaxShaderCompilerThreadsProc = void (GLAD_API_PTR *)(GLuint count);
+
+	/// Precedes the binary in every cache file.
+	struct SC_ShaderCacheHeader {
+		u32 magic;
+		u32 version;
+		u64 key;
+		u32 binary_format;
+		u32 binary_size;
+	};
+
+	/// FNV-1a, 64 bit.
+	auto sc_shader_cache_hash(u64 hash, void const *data, u64 size) noexcept -> u64 {
+		u8 const *bytes = static_cast<u8 const *>(data);
+		for (u64 i = 0; i < size; ++i) {
+			hash = (hash ^ bytes[i]) * 0x100000001B3ull;
+		}
+		return hash;
+	}
+
+	auto sc_shader_cache_hash_string(u64 hash, char const *string) noexcept -> u64 {
+		return string != nullptr ? sc_shader_cache_hash(hash, string, std::strlen(string) + 1) : hash;
+	}
+
+	auto sc_shader_cache_path(Arena *arena, SC_ShaderCache const *cache, u64 key) noexcept -> String8 {
+		return str8f(
+			arena, "%.*s/%016llx.bin",
+			static_cast<int>(cache->directory.size), cache->directory.data,
+			static_cast<unsigned long long>(key)
+		);
+	}
+
+	auto sc_shader_cache_accepts_format(SC_ShaderCache const *cache, u32 binary_format) noexcept -> b8 {
+		for (u32 i = 0; i < cache->binary_format_count; ++i) {
+			if (static_cast<u32>(cache->binary_formats[i]) == binary_format) {
+				return true;
+			}
+		}
+		return false;
+	}
+
+	/// Returns 0 when there is no usable binary for `key`.
+	auto sc_shader_cache_load(SC_ShaderCache const *cache, u64 key) noexcept -> GLuint {
+		ScratchArena const scratch = arena_scratch_begin(tc_get_scratch(nullptr, 0));
+		OS_Handle const file = os_file_open(sc_shader_cache_path(scratch.arena, cache, key), OS_ACCESS_FLAG_READ);
+		OS_FileMap const map = os_file_map(file);
+		os_file_close(file);
+		arena_scratch_end(scratch);
+
+		SC_ShaderCacheHeader header = {};
+		if (map.data == nullptr || map.size < sizeof(header)) {
+			os_file_unmap(map);
+			return 0;
+		}
+		std::memcpy(&header, map.data, sizeof(header));
+		// NOTE(Dedrick): An unknown format would be a GL error rather than a failed link, so it is checked up front.
+		if (header.magic != SC_SHADER_CACHE_MAGIC || header.version != SC_SHADER_CACHE_VERSION || header.key != key
+			|| header.binary_size != map.size - sizeof(header) || !sc_shader_cache_accepts_format(cache, header.binary_format)) {
+			os_file_unmap(map);
+			return 0;
+		}
+
+		GLuint const program = glCreateProgram();
+		glProgramBinary(program, header.binary_format, map.data + sizeof(header), static_cast<GLsizei>(header.binary_size));
+		os_file_unmap(map);
+
+		GLint success = GL_FALSE;
+		glGetProgramiv(program, GL_LINK_STATUS, &success);
+		if (success != GL_TRUE) {
+			glDeleteProgram(program);
+			return 0;
+		}
+		return program;
+	}
+
+	auto sc_shader_cache_store(SC_ShaderCache const *cache, u64 key, GLuint program) noexcept -> void {
+		GLint binary_size = 0;
+		glGetProgramiv(program, GL_PROGRAM_BINARY_LENGTH, &binary_size);
+		if (binary_size <= 0) {
+			return;
+		}
+
+		ScratchArena const scratch = arena_scratch_begin(tc_get_scratch(nullptr, 0));
+		u64 const file_size = sizeof(SC_ShaderCacheHeader) + static_cast<u64>(binary_size);
+		u8 *data = static_cast<u8 *>(arena_push_no_zero(scratch.arena, file_size, alignof(SC_ShaderCacheHeader)));
+		GLsizei written = 0;
+		GLenum binary_format = GL_NONE;
+		glGetProgramBinary(program, binary_size, &written, &binary_format, data + sizeof(SC_ShaderCacheHeader));
+
+		SC_ShaderCacheHeader const header = {
+			.magic = SC_SHADER_CACHE_MAGIC,
+			.version = SC_SHADER_CACHE_VERSION,
+			.key = key,
+			.binary_format = binary_format,
+			.binary_size = static_cast<u32>(written)
+		};
+		std::memcpy(data, &header, sizeof(header));
+
+		// NOTE(Dedrick): A short write leaves a size that does not match the header, which is a miss next time.
+		OS_Handle const file = os_file_open(sc_shader_cache_path(scratch.arena, cache, key), OS_ACCESS_FLAG_WRITE);
+		if (file != os_handle_invalid()) {
+			os_file_write(file, 0, sizeof(header) + static_cast<u64>(written), data);
+			os_file_close(file);
+		}
+		arena_scratch_end(scratch);
+	}
+
+	/// Checks the link of `pending`, stores its binary and drops its shaders. Blocks until it is linked.
+	auto sc_shader_cache_finish(SC_ShaderCache const *cache, SC_PendingProgram const *pending) noexcept -> void {
+		GLint success = GL_FALSE;
+		glGetProgramiv(pending->program, GL_LINK_STATUS, &success);
+		if (success != GL_TRUE) {
+			char info_log[1024];
+			for (u32 i = 0; i < pending->shader_count; ++i) {
+				GLint compiled = GL_FALSE;
+				glGetShaderiv(pending->shaders[i], GL_COMPILE_STATUS, &compiled);
+				if (compiled != GL_TRUE) {
+					glGetShaderInfoLog(pending->shaders[i], static_cast<GLsizei>(array_size(info_log)), nullptr, info_log);
+					(void)std::fprintf(stderr, "Shader compilation failed\n%s", info_log);
+				}
+			}
+			glGetProgramInfoLog(pending->program, static_cast<GLsizei>(array_size(info_log)), nullptr, info_log);
+			(void)std::fprintf(stderr, "Program Linking failed\n%s", info_log);
+			DK_ASSERT(false);
+		} else if (cache->directory.size > 0) {
+			sc_shader_cache_store(cache, pending->key, pending->program);
+		}
+
+		for (u32 i = 0; i < pending->shader_count; ++i) {
+			glDetachShader(pending->program, pending->shaders[i]);
+			glDeleteShader(pending->shaders[i]);
+		}
+	}
+
+	auto sc_shader_cache_is_compiling(SC_ShaderCache const *cache, SC_PendingProgram const *pending) noexcept -> b8 {
+		if (!cache->parallel_compile) {
+			return false;
+		}
+		GLint completed = GL_TRUE;
+		glGetProgramiv(pending->program, SC_GL_COMPLETION_STATUS_KHR, &completed);
+		return completed != GL_TRUE;
+	}
+
+	/// Loads the program of `sources` from the cache, or starts compiling and linking it.
+	auto sc_shader_cache_submit(
+		SC_ShaderCache *cache,
+		String8 const *sources,
+		GLenum const *types,
+		u32 stage_count
+	) noexcept -> GLuint {
+		if (cache->pending_count == SC_SHADER_CACHE_MAX_PENDING) {
+			sc_shader_cache_poll(cache, true);
+		}
+		DK_PROFILE_SCOPE("program_submit");
+		u64 const start_time_us = os_now_microseconds();
+
+		u64 key = cache->device_hash;
+		for (u32 i = 0; i < stage_count; ++i) {
+			key = sc_shader_cache_hash(key, &types[i], sizeof(types[i]));
+			key = sc_shader_cache_hash(key, sources[i].data, sources[i].size);
+		}
+
+		GLuint program = cache->directory.size > 0 ? sc_shader_cache_load(cache, key) : 0;
+		if (program != 0) {
+			cache->load_count += 1;
+		} else {
+			SC_PendingProgram *pending = &cache->pending[cache->pending_count];
+			*pending = {
+				.program = glCreateProgram(),
+				.shader_count = stage_count,
+				.key = key
+			};
+			DK_ASSERT(stage_count <= array_size(pending->shaders));
+
+			// NOTE(Dedrick): Nothing is queried here, so neither the compile nor the link waits on the driver.
+			glProgramParameteri(pending->program, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+			for (u32 i = 0; i < stage_count; ++i) {
+				char const *source = reinterpret_cast<char const *>(sources[i].data);
+				GLint const length = static_cast<GLint>(sources[i].size);
+				pending->shaders[i] = glCreateShader(types[i]);
+				glShaderSource(pending->shaders[i], 1, &source, &length);
+				glCompileShader(pending->shaders[i]);
+				glAttachShader(pending->program, pending->shaders[i]);
+			}
+			glLinkProgram(pending->program);
+
+			program = pending->program;
+			cache->pending_count += 1;
+			cache->compile_count += 1;
+		}
+
+		cache->create_time_us += os_now_microseconds() - start_time_us;
+		return program;
+	}
+}
+
+auto dk::sc_shader_cache_init(SC_ShaderCache *cache, Arena *arena, String8 directory) noexcept -> void {
+	*cache = {};
+	cache->arena = arena;
+
+	u64 gpu_hash = SC_SHADER_CACHE_HASH_SEED;
+	gpu_hash = sc_shader_cache_hash_string(gpu_hash, reinterpret_cast<char const *>(glGetString(GL_VENDOR)));
+	gpu_hash = sc_shader_cache_hash_string(gpu_hash, reinterpret_cast<char const *>(glGetString(GL_RENDERER)));
+	cache->gpu_hash = gpu_hash;
+	cache->device_hash = sc_shader_cache_hash_string(gpu_hash, reinterpret_cast<char const *>(glGetString(GL_VERSION)));
+
+	GLint extension_count = 0;
+	glGetIntegerv(GL_NUM_EXTENSIONS, &extension_count);
+	for (GLint i = 0; i < extension_count && !cache->parallel_compile; ++i) {
+		char const *extension = reinterpret_cast<char const *>(glGetStringi(GL_EXTENSIONS, static_cast<GLuint>(i)));
+		char const *proc_name = nullptr;
+		if (std::strcmp(extension, "GL_KHR_parallel_shader_compile") == 0) { proc_name = "glMaxShaderCompilerThreadsKHR"; }
+		if (std::strcmp(extension, "GL_ARB_parallel_shader_compile") == 0) { proc_name = "glMaxShaderCompilerThreadsARB"; }
+		auto const max_compiler_threads = proc_name != nullptr
+			? reinterpret_cast<SC_MaxShaderCompilerThreadsProc>(os_gl_proc_address(proc_name))
+			: nullptr;
+		if (max_compiler_threads != nullptr) {
+			// NOTE(Dedrick): 0xFFFFFFFF leaves the thread count to the driver.
+			max_compiler_threads(0xFFFFFFFFu);
+			cache->parallel_compile = true;
+		}
+	}
+
+	GLint format_count = 0;
+	glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &format_count);
+	if (format_count <= 0 || directory.size == 0 || !os_directory_create(directory)) {
+		return;
+	}
+	// NOTE(Dedrick): GL_PROGRAM_BINARY_FORMATS writes every format, so the query needs room for all of them.
+	ScratchArena const scratch = arena_scratch_begin(tc_get_scratch(&arena, 1));
+	GLint *formats = arena_push_type_array<GLint>(scratch.arena, static_cast<u64>(format_count));
+	glGetIntegerv(GL_PROGRAM_BINARY_FORMATS, formats);
+	cache->binary_format_count = glm::min(static_cast<u32>(format_count), SC_SHADER_CACHE_MAX_BINARY_FORMATS);
+	std::memcpy(cache->binary_formats, formats, cache->binary_format_count * sizeof(GLint));
+	arena_scratch_end(scratch);
+
+	cache->directory = str8_copy(arena, directory);
+}
+
+auto dk::sc_shader_cache_compute_program(SC_ShaderCache *cache, String8 compute_source) noexcept -> GLuint {
+	if (cache == nullptr) {
+		return gl_compute_program_create(compute_source);
+	}
+	GLenum const type = GL_COMPUTE_SHADER;
+	return sc_shader_cache_submit(cache, &compute_source, &type, 1);
+}
+
+auto dk::sc_shader_cache_program(SC_ShaderCache *cache, String8 vertex_source, String8 fragment_source) noexcept -> GLuint {
+	if (cache == nullptr) {
+		return gl_program_create(vertex_source, fragment_source);
+	}
+	String8 const sources[2] = { vertex_source, fragment_source };
+	GLenum const types[2] = { GL_VERTEX_SHADER, GL_FRAGMENT_SHADER };
+	return sc_shader_cache_submit(cache, sources, types, 2);
+}
+
+auto dk::sc_shader_cache_variant(SC_ShaderCache *cache, SC_ShaderVariant const *variant) noexcept -> GLuint {
+	DK_ASSERT(cache != nullptr && variant != nullptr);
+	SC_ShaderVariant const canonical = sc_shader_variant_canonical(variant);
+	for (SC_ShaderVariantBlock const *block = cache->first_variant_block; block != nullptr; block = block->next) {
+		for (u32 i = 0; i < block->count; ++i) {
+			SC_ShaderVariant const *known = &block->variants[i];
+			if (known->stage == canonical.stage && known->axis == canonical.axis && known->workgroup_size == canonical.workgroup_size
+				&& known->tile_width == canonical.tile_width && known->tile_height == canonical.tile_height) {
+				return block->programs[i];
+			}
+		}
+	}
+
+	SC_ShaderVariantBlock *block = cache->last_variant_block;
+	if (block == nullptr || block->count == SC_SHADER_CACHE_VARIANTS_PER_BLOCK) {
+		block = arena_push_type<SC_ShaderVariantBlock>(cache->arena);
+		list_queue_push(&cache->first_variant_block, &cache->last_variant_block, block);
+	}
+
+	ScratchArena const scratch = arena_scratch_begin(tc_get_scratch(nullptr, 0));
+	String8 const source = sc_shader_variant_source(scratch.arena, &canonical);
+	GLenum const type = GL_COMPUTE_SHADER;
+	GLuint const program = sc_shader_cache_submit(cache, &source, &type, 1);
+	arena_scratch_end(scratch);
+
+	block->variants[block->count] = canonical;
+	block->programs[block->count] = program;
+	block->count += 1;
+	return program;
+}
+
+auto dk::sc_shader_cache_poll(SC_ShaderCache *cache, b8 wait) noexcept -> b8 {
+	if (cache == nullptr || cache->pending_count == 0) {
+		return true;
+	}
+	DK_PROFILE_SCOPE("program_poll");
+	u64 const start_time_us = os_now_microseconds();
+
+	// NOTE(Dedrick): Finished programs are dropped in place, the rest keep their submission order.
+	u32 kept_count = 0;
+	for (u32 i = 0; i < cache->pending_count; ++i) {
+		if (!wait && sc_shader_cache_is_compiling(cache, &cache->pending[i])) {
+			cache->pending[kept_count++] = cache->pending[i];
+		} else {
+			sc_shader_cache_finish(cache, &cache->pending[i]);
+		}
+	}
+	cache->pending_count = kept_count;
+
+	cache->create_time_us += os_now_microseconds() - start_time_us;
+	return kept_count == 0;
+}
+
+auto dk::sc_shader_cache_is_pending(SC_ShaderCache const *cache, GLuint program) noexcept -> b8 {
+	if (cache == nullptr) {
+		return false;
+	}
+	for (u32 i = 0; i < cache->pending_count; ++i) {
+		if (cache->pending[i].program == program) {
+			return true;
+		}
+	}
+	return false;
+}
+
+auto dk::sc_shader_cache_release(SC_ShaderCache *cache) noexcept -> void {
+	sc_shader_cache_poll(cache, true);
+	for (SC_ShaderVariantBlock *block = cache->first_variant_block; block != nullptr; block = block->next) {
+		for (u32 i = 0; i < block->count; ++i) {
+			gl_program_destroy(block->programs[i]);
+		}
+	}
+	cache->first_variant_block = nullptr;
+	cache->last_variant_block = nullptr;
+}
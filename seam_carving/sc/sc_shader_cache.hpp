@@ -0,0 +1,89 @@
+/*
+ * Copyright (C) 2025 Koh Swee Teck Dedrick.
+ * Licensed under the Apache License, Version 2.0 (http://www.apache.org/licenses/LICENSE-2.0)
+ */
+
+#pragma once
+
+#include "base/base_arena.hpp"
+#include "base/base_strings.hpp"
+#include "base/base_types.hpp"
+#include "sc/sc_assets.hpp"
+
+#include <glad/gl.h>
+
+namespace dk {
+	constexpr u32 SC_SHADER_CACHE_MAX_BINARY_FORMATS = 8;
+	constexpr u32 SC_SHADER_CACHE_MAX_PENDING = 64;
+	constexpr u32 SC_SHADER_CACHE_VARIANTS_PER_BLOCK = 64;
+
+	/// Program that was submitted but whose link result has not been checked yet.
+	struct SC_PendingProgram {
+		GLuint program;
+		GLuint shaders[2];
+		u32 shader_count;
+		u64 key;
+	};
+
+	struct SC_ShaderVariantBlock {
+		SC_ShaderVariantBlock *next;
+		SC_ShaderVariant variants[SC_SHADER_CACHE_VARIANTS_PER_BLOCK];
+		GLuint programs[SC_SHADER_CACHE_VARIANTS_PER_BLOCK];
+		u32 count;
+	};
+
+	// NOTE(Dedrick): Programs are keyed on a hash of their sources and the GL vendor, renderer and
+	// version, so a driver update or another GPU never sees a binary it did not produce. A binary the
+	// driver still rejects is compiled from source again and overwritten.
+	/// Program binaries kept on disk, one file per program.
+	struct SC_ShaderCache {
+		String8 directory; ///< Empty compiles every program from source.
+		u64 device_hash;
+		u64 gpu_hash; ///< Vendor and renderer only, for data that stays valid across driver updates.
+		GLint binary_formats[SC_SHADER_CACHE_MAX_BINARY_FORMATS]; ///< Formats the driver accepts in glProgramBinary.
+		u32 binary_format_count;
+
+		// NOTE(Dedrick): With GL_KHR_parallel_shader_compile compiles and links return right away and run
+		// on the driver's threads. Without it they may still be deferred, but checking them blocks.
+		b8 parallel_compile;
+		SC_PendingProgram pending[SC_SHADER_CACHE_MAX_PENDING];
+		u32 pending_count;
+
+		// NOTE(Dedrick): Variant programs are owned by the cache and shared by everyone asking for the same variant.
+		// Autotuning compiles every candidate config, so the table grows by blocks pushed on `arena`.
+		Arena *arena;
+		SC_ShaderVariantBlock *first_variant_block;
+		SC_ShaderVariantBlock *last_variant_block;
+
+		u32 load_count; ///< Programs created from a cached binary.
+		u32 compile_count; ///< Programs compiled from source.
+		u64 create_time_us; ///< Spent on the calling thread creating programs, loaded or compiled.
+	};
+
+	/// Needs a current GL context. Copies `directory` to `arena` and creates it, an empty `directory`,
+	/// one that cannot be created or a driver without binary formats leaves the cache disabled.
+	/// The variant table grows on `arena` as well.
+	auto sc_shader_cache_init(SC_ShaderCache *cache, Arena *arena, String8 directory) noexcept -> void;
+
+	// NOTE(Dedrick): A program from the functions below may still be compiling. It can be used right
+	// away, the driver blocks on first use until it is linked. `cache` may be nullptr, the program is
+	// then compiled and linked before returning, like `gl_compute_program_create` and `gl_program_create`.
+
+	auto sc_shader_cache_compute_program(SC_ShaderCache *cache, String8 compute_source) noexcept -> GLuint;
+
+	auto sc_shader_cache_program(SC_ShaderCache *cache, String8 vertex_source, String8 fragment_source) noexcept -> GLuint;
+
+	/// Program of `variant`, created the first time it is asked for, so only variants in use are compiled.
+	/// Unlike the two above `cache` cannot be nullptr, the program belongs to it.
+	auto sc_shader_cache_variant(SC_ShaderCache *cache, SC_ShaderVariant const *variant) noexcept -> GLuint;
+
+	/// Checks the link of every program that finished compiling and stores its binary.
+	/// `wait` blocks until all of them are done. True once nothing is pending.
+	auto sc_shader_cache_poll(SC_ShaderCache *cache, b8 wait) noexcept -> b8;
+
+	/// True until `sc_shader_cache_poll` has checked the link of `program`, while it compiles and after.
+	auto sc_shader_cache_is_pending(SC_ShaderCache const *cache, GLuint program) noexcept -> b8;
+
+	/// Waits for pending programs so their binaries are stored, then destroys every variant program.
+	auto sc_shader_cache_release(SC_ShaderCache *cache) noexcept -> void;
+}
@@ -1,3 +1,4 @@
+#include "base/base_alloc_hooks.h"
 #include "base/base_assert.h"
 #include <stdbool.h>
 
@@ -5,9 +6,15 @@
 #include "stb_sprintf.h"
 
 #define STBI_ASSERT(x) DK_ASSERT(x)
+#define STBI_MALLOC(size) dk_alloc_hook_malloc(size)
+#define STBI_REALLOC(ptr, new_size) dk_alloc_hook_realloc(ptr, new_size)
+#define STBI_FREE(ptr) dk_alloc_hook_free(ptr)
 #define STB_IMAGE_IMPLEMENTATION
 #include "stb_image.h"
 
 #define STBIW_ASSERT(x) DK_ASSERT(x)
+#define STBIW_MALLOC(size) dk_alloc_hook_malloc(size)
+#define STBIW_REALLOC(ptr, new_size) dk_alloc_hook_realloc(ptr, new_size)
+#define STBIW_FREE(ptr) dk_alloc_hook_free(ptr)
 #define STB_IMAGE_WRITE_IMPLEMENTATION
 #include "stb_image_write.h"